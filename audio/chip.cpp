@@ -21,6 +21,7 @@
 
 #include "audio/chip.h"
 #include "audio/mixer.h"
+#include "audio/render_ahead.h"
 
 #include "common/timer.h"
 
@@ -97,7 +98,8 @@ EmulatedChip::EmulatedChip() :
 	_nextTick(0),
 	_samplesPerTick(0),
 	_baseFreq(0),
-	_handle(new Audio::SoundHandle()) { }
+	_handle(new Audio::SoundHandle()),
+	_renderAhead(nullptr) { }
 
 EmulatedChip::~EmulatedChip() {
 	// Stop callbacks, just in case. If it's still playing at this
@@ -142,11 +144,24 @@ int EmulatedChip::getRate() const {
 
 void EmulatedChip::startCallbacks(int timerFrequency) {
 	setCallbackFrequency(timerFrequency);
-	g_system->getMixer()->playStream(Audio::Mixer::kPlainSoundType, _handle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
+
+	// With render-ahead, the timer callbacks are invoked from the thread
+	// rendering the samples, which is not necessarily the mixer thread.
+	// The stream is deleted in stopCallbacks() rather than by the mixer.
+	_renderAhead = makeRenderAheadStream(this);
+	if (_renderAhead)
+		g_system->getMixer()->playStream(Audio::Mixer::kPlainSoundType, _handle, _renderAhead, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
+	else
+		g_system->getMixer()->playStream(Audio::Mixer::kPlainSoundType, _handle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 }
 
 void EmulatedChip::stopCallbacks() {
 	g_system->getMixer()->stopHandle(*_handle);
+
+	// Deleting the stream waits for the timer proc rendering it, which must
+	// not happen with the mixer locked
+	delete _renderAhead;
+	_renderAhead = nullptr;
 }
 
 void EmulatedChip::setCallbackFrequency(int timerFrequency) {
@@ -28,6 +28,7 @@
 #include "audio/audiostream.h"
 
 namespace Audio {
+class RenderAheadStream;
 class SoundHandle;
 
 class Chip {
@@ -149,6 +150,7 @@ private:
 	int _samplesPerTick;
 
 	Audio::SoundHandle *_handle;
+	Audio::RenderAheadStream *_renderAhead;
 };
 
 } // End of namespace Audio
@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/chip_capture.h"
+
+#include "common/bufferedstream.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+
+namespace Audio {
+
+enum {
+	kCaptureVersion = 2,
+	kCaptureHeaderSize = 7,
+	kCaptureBufferSize = 4096,
+	kMaxTickRun = 128
+};
+
+ChipCaptureWriter::ChipCaptureWriter(Common::WriteStream *stream, CaptureChip chip, byte type) :
+		_stream(Common::wrapBufferedWriteStream(stream, kCaptureBufferSize)), _pendingTicks(0) {
+	_stream->writeUint32BE(MKTAG('C', 'H', 'P', 'C'));
+	_stream->writeByte(kCaptureVersion);
+	_stream->writeByte(chip);
+	_stream->writeByte(type);
+}
+
+ChipCaptureWriter::~ChipCaptureWriter() {
+	flushTicks();
+
+	_stream->finalize();
+	if (_stream->err())
+		warning("ChipCaptureWriter: Failed to write the chip capture");
+	delete _stream;
+}
+
+void ChipCaptureWriter::addEvent(CaptureEventType type, uint16 param, uint8 value) {
+	Common::StackLock lock(_mutex);
+
+	flushTicks();
+	_stream->writeByte(type);
+	_stream->writeUint16LE(param);
+	_stream->writeByte(value);
+}
+
+void ChipCaptureWriter::addEvent(CaptureEventType type, uint16 param) {
+	Common::StackLock lock(_mutex);
+
+	flushTicks();
+	_stream->writeByte(type);
+	if (type == kCaptureFrequency)
+		_stream->writeUint16LE(param);
+}
+
+void ChipCaptureWriter::addTick() {
+	Common::StackLock lock(_mutex);
+
+	// Runs of timer callbacks are written as a single byte
+	if (++_pendingTicks == kMaxTickRun)
+		flushTicks();
+}
+
+void ChipCaptureWriter::flushTicks() {
+	if (!_pendingTicks)
+		return;
+
+	_stream->writeByte(kCaptureTicks | (_pendingTicks - 1));
+	_pendingTicks = 0;
+}
+
+ChipCapturePlayer::ChipCapturePlayer(Common::ReadStream &stream) : _stream(stream), _chip(kCaptureChipOPL), _type(0), _valid(false) {
+	byte header[kCaptureHeaderSize];
+	if (_stream.read(header, kCaptureHeaderSize) != kCaptureHeaderSize)
+		return;
+
+	if (memcmp(header, "CHPC", 4) || header[4] != kCaptureVersion || header[5] > kCaptureChipCMS)
+		return;
+
+	_chip = (CaptureChip)header[5];
+	_type = header[6];
+	_valid = true;
+}
+
+bool ChipCapturePlayer::readEvent(CaptureEvent &event) {
+	if (!_valid)
+		return false;
+
+	byte type = _stream.readByte();
+	if (_stream.eos())
+		return false;
+
+	event.param = 0;
+	event.value = 0;
+
+	if (type & kCaptureTicks) {
+		event.type = kCaptureTicks;
+		event.param = (type & ~kCaptureTicks) + 1;
+		return true;
+	}
+
+	event.type = (CaptureEventType)type;
+	switch (type) {
+	case kCaptureWrite:
+	case kCaptureWriteReg:
+		event.param = _stream.readUint16LE();
+		event.value = _stream.readByte();
+		break;
+	case kCaptureFrequency:
+		event.param = _stream.readUint16LE();
+		break;
+	case kCaptureReset:
+		break;
+	default:
+		warning("ChipCapturePlayer: Unknown event type 0x%02x", type);
+		_valid = false;
+		return false;
+	}
+
+	return !_stream.eos();
+}
+
+} // End of namespace Audio
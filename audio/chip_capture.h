@@ -0,0 +1,231 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_CHIP_CAPTURE_H
+#define AUDIO_CHIP_CAPTURE_H
+
+#include "common/func.h"
+#include "common/mutex.h"
+
+namespace Common {
+class ReadStream;
+class WriteStream;
+}
+
+namespace Audio {
+
+/**
+ * Chip capture files record everything an engine sends to a sound chip,
+ * timed by the chip timer callbacks, so the music can be replayed later
+ * on any emulator without the game.
+ *
+ * The file starts with the tag 'CHPC', a version byte, the chip byte and
+ * a chip specific type byte, such as the OPL type. Then follow the events,
+ * each starting with one byte:
+ *  - 0x01 port(LE16) value(8): write()
+ *  - 0x02 reg(LE16) value(8): writeReg()
+ *  - 0x03 frequency(LE16): timer callback frequency change
+ *  - 0x04: reset()
+ *  - 0x80 | (n - 1): n timer callbacks, n <= 128
+ */
+enum CaptureChip {
+	kCaptureChipOPL = 0,
+	kCaptureChipCMS = 1
+};
+
+enum CaptureEventType {
+	kCaptureWrite = 0x01,
+	kCaptureWriteReg = 0x02,
+	kCaptureFrequency = 0x03,
+	kCaptureReset = 0x04,
+	kCaptureTicks = 0x80
+};
+
+struct CaptureEvent {
+	CaptureEventType type;
+	uint16 param; ///< Port, register, frequency or number of ticks
+	uint8 value;
+};
+
+/**
+ * Writes the events of a chip capture to a stream as they happen, so that
+ * a capture only needs a small buffer in memory however long it runs.
+ * Events may be added from the timer thread and the engine thread.
+ */
+class ChipCaptureWriter {
+public:
+	/**
+	 * Start a capture. The writer takes ownership of the stream, which is
+	 * finalized when the writer is destroyed.
+	 */
+	ChipCaptureWriter(Common::WriteStream *stream, CaptureChip chip, byte type);
+	~ChipCaptureWriter();
+
+	void addEvent(CaptureEventType type, uint16 param, uint8 value);
+	void addEvent(CaptureEventType type, uint16 param);
+	void addTick();
+
+private:
+	/** Write the timer callbacks which were not written yet. */
+	void flushTicks();
+
+	Common::WriteStream *_stream;
+	Common::Mutex _mutex;
+	uint _pendingTicks;
+};
+
+/**
+ * A chip which records all traffic to a wrapped chip with the OPL style
+ * interface, such as an OPL or a CMS.
+ *
+ * Timer callbacks of the wrapped chip are passed through to the engine;
+ * each one is written to the capture, so replaying it reproduces the
+ * timing of the engine's writes exactly.
+ */
+template<class T>
+class ChipCapture : public T {
+public:
+	/**
+	 * Wrap a chip. The capture takes ownership of both the chip and the
+	 * stream.
+	 */
+	ChipCapture(T *target, Common::WriteStream *stream, CaptureChip chip, byte type) :
+			T(target), _target(target), _writer(stream, chip, type) {
+	}
+
+	~ChipCapture() {
+		this->stop();
+		delete _target;
+	}
+
+	bool init() override {
+		return _target->init();
+	}
+
+	void reset() override {
+		_writer.addEvent(kCaptureReset, 0);
+		_target->reset();
+	}
+
+	void write(int a, int v) override {
+		_writer.addEvent(kCaptureWrite, a, v);
+		_target->write(a, v);
+	}
+
+	void writeReg(int r, int v) override {
+		_writer.addEvent(kCaptureWriteReg, r, v);
+		_target->writeReg(r, v);
+	}
+
+	void setCallbackFrequency(int timerFrequency) override {
+		_writer.addEvent(kCaptureFrequency, timerFrequency);
+		_target->setCallbackFrequency(timerFrequency);
+	}
+
+protected:
+	void startCallbacks(int timerFrequency) override {
+		_writer.addEvent(kCaptureFrequency, timerFrequency);
+		_target->start(new Common::Functor0Mem<void, ChipCapture>(this, &ChipCapture::onTimer), timerFrequency);
+	}
+
+	void stopCallbacks() override {
+		_target->stop();
+	}
+
+private:
+	void onTimer() {
+		_writer.addTick();
+
+		if (this->_callback && this->_callback->isValid())
+			(*this->_callback)();
+	}
+
+	T *_target;
+	ChipCaptureWriter _writer;
+};
+
+/**
+ * Reads the events of a chip capture, for replaying it.
+ */
+class ChipCapturePlayer {
+public:
+	/**
+	 * @param stream the capture, which must stay valid while playing it
+	 */
+	ChipCapturePlayer(Common::ReadStream &stream);
+
+	/** Return whether the stream is a valid capture. */
+	bool isValid() const { return _valid; }
+
+	/** Return the chip the capture was made with. */
+	CaptureChip getChip() const { return _chip; }
+
+	/** Return the chip specific type byte, such as the OPL type. */
+	byte getType() const { return _type; }
+
+	/** Read the next event. Returns false at the end of the capture. */
+	bool readEvent(CaptureEvent &event);
+
+	/**
+	 * Apply all events up to the next run of timer callbacks to a chip with
+	 * the OPL style interface, such as an OPL or a CMS. Returns the number
+	 * of timer callbacks in that run, which is 0 at the end of the capture.
+	 *
+	 * Changes of the callback frequency are not applied to the chip, but
+	 * reported through frequency, so the caller can render the right
+	 * number of samples per callback.
+	 */
+	template<class T>
+	uint playTicks(T &chip, int &frequency) {
+		CaptureEvent event;
+
+		while (readEvent(event)) {
+			switch (event.type) {
+			case kCaptureWrite:
+				chip.write(event.param, event.value);
+				break;
+			case kCaptureWriteReg:
+				chip.writeReg(event.param, event.value);
+				break;
+			case kCaptureFrequency:
+				frequency = event.param;
+				break;
+			case kCaptureReset:
+				chip.reset();
+				break;
+			case kCaptureTicks:
+				return event.param;
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	Common::ReadStream &_stream;
+	CaptureChip _chip;
+	byte _type;
+	bool _valid;
+};
+
+} // End of namespace Audio
+
+#endif
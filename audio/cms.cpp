@@ -22,13 +22,27 @@
 #include "audio/cms.h"
 #include "audio/softsynth/cms.h"
 
+#include "common/config-manager.h"
+#include "common/file.h"
 #include "common/textconsole.h"
 
 namespace CMS {
 
 CMS *Config::create() {
 	// For now this is fixed to the DOSBox emulator.
-	return new DOSBoxCMS();
+	CMS *cms = new DOSBoxCMS();
+
+	if (ConfMan.getBool("dump_chips")) {
+		Common::DumpFile *file = new Common::DumpFile();
+		if (file->open("dump.cmsc")) {
+			cms = new CaptureCMS(cms, file, Audio::kCaptureChipCMS, 0);
+		} else {
+			warning("Could not open 'dump.cmsc' for the CMS capture");
+			delete file;
+		}
+	}
+
+	return cms;
 }
 
 bool CMS::_hasInstance = false;
@@ -37,10 +51,17 @@ CMS::CMS() {
 	if (_hasInstance)
 		error("There are multiple CMS output instances running.");
 	_hasInstance = true;
+	_isInstance = true;
+}
+
+CMS::CMS(CMS *target) {
+	assert(target && target->_isInstance);
+	_isInstance = false;
 }
 
 CMS::~CMS() {
-	_hasInstance = false;
+	if (_isInstance)
+		_hasInstance = false;
 }
 
 } // End of namespace CMS
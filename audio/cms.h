@@ -23,6 +23,7 @@
 #define AUDIO_CMS_H
 
 #include "audio/chip.h"
+#include "audio/chip_capture.h"
 
 namespace CMS {
 
@@ -39,6 +40,7 @@ public:
 class CMS : virtual public Audio::Chip {
 private:
 	static bool _hasInstance;
+	bool _isInstance;
 
 public:
 	// The default number of timer callbacks per second.
@@ -80,8 +82,20 @@ public:
 
 	using Audio::Chip::start;
 	void start(TimerCallback *callback) { start(callback, DEFAULT_CALLBACK_FREQUENCY); }
+
+protected:
+	/**
+	 * Constructor for CMSs which pass everything on to @p target, which
+	 * is the actual CMS instance.
+	 */
+	explicit CMS(CMS *target);
 };
 
+/**
+ * A CMS which records all traffic to a wrapped CMS.
+ */
+typedef Audio::ChipCapture<CMS> CaptureCMS;
+
 } // End of namespace CMS
 
 #endif
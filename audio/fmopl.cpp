@@ -34,6 +34,7 @@
 #include "audio/softsynth/opl/nuked.h"
 
 #include "common/config-manager.h"
+#include "common/file.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 
@@ -101,6 +102,16 @@ OPL::OPL() {
 	if (_hasInstance)
 		error("There are multiple OPL output instances running");
 	_hasInstance = true;
+	_isInstance = true;
+	_rhythmMode = false;
+	_connectionFeedbackValues[0] = 0;
+	_connectionFeedbackValues[1] = 0;
+	_connectionFeedbackValues[2] = 0;
+}
+
+OPL::OPL(OPL *target) {
+	assert(target && target->_isInstance);
+	_isInstance = false;
 	_rhythmMode = false;
 	_connectionFeedbackValues[0] = 0;
 	_connectionFeedbackValues[1] = 0;
@@ -243,6 +254,22 @@ OPL *Config::create(DriverId driver, OplType type) {
 		}
 	}
 
+	OPL *opl = createDriver(driver, type);
+
+	if (opl && ConfMan.getBool("dump_chips")) {
+		Common::DumpFile *file = new Common::DumpFile();
+		if (file->open("dump.oplc")) {
+			opl = new CaptureOPL(opl, file, Audio::kCaptureChipOPL, type);
+		} else {
+			warning("Could not open 'dump.oplc' for the OPL capture");
+			delete file;
+		}
+	}
+
+	return opl;
+}
+
+OPL *Config::createDriver(DriverId driver, OplType type) {
 	switch (driver) {
 #ifndef DISABLE_MAME_OPL
 	case kMame:
@@ -23,6 +23,7 @@
 #define AUDIO_FMOPL_H
 
 #include "audio/chip.h"
+#include "audio/chip_capture.h"
 
 namespace Audio {
 class SoundHandle;
@@ -107,6 +108,8 @@ public:
 	static OPL *create(OplType type = kOpl2);
 
 private:
+	static OPL *createDriver(DriverId driver, OplType type);
+
 	static const EmulatorDescription _drivers[];
 };
 
@@ -116,9 +119,10 @@ private:
 class OPL : virtual public Audio::Chip {
 private:
 	static bool _hasInstance;
+	bool _isInstance;
 public:
 	OPL();
-	virtual ~OPL() { _hasInstance = false; }
+	virtual ~OPL() { if (_isInstance) _hasInstance = false; }
 
 	/**
 	 * Initializes the OPL emulator.
@@ -162,6 +166,12 @@ public:
 	};
 
 protected:
+	/**
+	 * Constructor for OPLs which pass everything on to @p target, which
+	 * is the actual OPL instance.
+	 */
+	explicit OPL(OPL *target);
+
 	/**
 	 * Initializes an OPL3 chip for emulating dual OPL2.
 	 * 
@@ -200,6 +210,11 @@ public:
 	void writeReg(int r, int v) override {}
 };
 
+/**
+ * An OPL which records all traffic to a wrapped OPL.
+ */
+typedef Audio::ChipCapture<OPL> CaptureOPL;
+
 /** @} */
 } // End of namespace OPL
 
@@ -234,7 +234,7 @@ private:
 
 MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize, uint outBytesPerSample, bool clamp)
 	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _outBytesPerSample(outBytesPerSample), _clamp(clamp)
-	, _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	, _mixerReady(false), _handleSeed(0), _soundTypeSettings(), _profileClock(nullptr) {
 
 	assert(sampleRate > 0);
 
@@ -348,6 +348,8 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 
 	Common::StackLock lock(_mutex);
 
+	const uint64 start = _profileClock ? _profileClock() : 0;
+
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
@@ -369,7 +371,13 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 					memset(samples, 0, len);
 					zeroed = true;
 				}
-				tmp = _channels[i]->mix(samples, numFrames);
+				if (_profileClock) {
+					const uint64 channelStart = _profileClock();
+					tmp = _channels[i]->mix(samples, numFrames);
+					_profile.typeTime[_channels[i]->getType()] += _profileClock() - channelStart;
+				} else {
+					tmp = _channels[i]->mix(samples, numFrames);
+				}
 
 				if (tmp > res)
 					res = tmp;
@@ -384,9 +392,33 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 			res = 0;
 		}
 	}
+
+	if (_profileClock) {
+		const uint64 time = _profileClock() - start;
+		_profile.callbacks++;
+		_profile.frames += numFrames;
+		_profile.mixTime += time;
+		_profile.maxCallbackTime = MAX(_profile.maxCallbackTime, time);
+		if (time * _sampleRate > (uint64)numFrames * 1000000)
+			_profile.overBudget++;
+	}
+
 	return res;
 }
 
+void MixerImpl::setProfileClock(ProfileClock clock) {
+	Common::StackLock lock(_mutex);
+
+	if (clock && !_profileClock)
+		_profile = Profile();
+	_profileClock = clock;
+}
+
+MixerImpl::Profile MixerImpl::getProfile() const {
+	Common::StackLock lock(_mutex);
+	return _profile;
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
@@ -56,6 +56,26 @@ namespace Audio {
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
+public:
+	/** Return the current real time in microseconds, used for profiling. */
+	typedef uint64 (*ProfileClock)();
+
+	/**
+	 * Time spent in mixCallback() while profiling, in microseconds.
+	 */
+	struct Profile {
+		Profile() : callbacks(0), overBudget(0), frames(0), mixTime(0), maxCallbackTime(0), typeTime() {}
+
+		uint32 callbacks;
+		/** Number of callbacks which took longer than the audio they mixed lasts. */
+		uint32 overBudget;
+		uint64 frames;
+		uint64 mixTime;
+		uint64 maxCallbackTime;
+		/** Time spent mixing the channels of each sound type. */
+		uint64 typeTime[4];
+	};
+
 private:
 	enum {
 		NUM_CHANNELS = 32
@@ -81,6 +101,9 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	ProfileClock _profileClock;
+	Profile _profile;
+
 
 public:
 
@@ -170,6 +193,18 @@ public:
 	 * their audio system has been completed.
 	 */
 	void setReady(bool ready);
+
+	/**
+	 * Start profiling the mixer callback with the given clock, or stop
+	 * profiling by passing nullptr. Starting resets the profile.
+	 *
+	 * The clock is passed in by the backend, as getMillis() is too coarse
+	 * and returns recorded time when the event recorder plays back.
+	 */
+	void setProfileClock(ProfileClock clock);
+
+	/** Return the profile collected so far. */
+	Profile getProfile() const;
 };
 
 /** @} */
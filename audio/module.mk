@@ -8,6 +8,7 @@ MODULE_OBJS := \
 	audiostream.o \
 	casio.o \
 	chip.o \
+	chip_capture.o \
 	cms.o \
 	fmopl.o \
 	mac_plugin.o \
@@ -24,10 +25,13 @@ MODULE_OBJS := \
 	mixer.o \
 	mpu401.o \
 	mt32gm.o \
+	music_queue.o \
 	musicplugin.o \
 	null.o \
 	rate.o \
+	render_ahead.o \
 	sid.o \
+	sound_cache.o \
 	ym2149.o \
 	timestamp.o \
 	decoders/3do.o \
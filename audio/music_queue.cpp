@@ -0,0 +1,319 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/music_queue.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/stream.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Audio {
+
+enum {
+	// Frames decoded per step
+	kDecodeChunkFrames = 256,
+	// Frames decoded when priming a track, enough for the decoder to have
+	// read its headers and filled its first blocks
+	kPrimeFrames = 4096
+};
+
+MusicQueueStream::MusicQueueStream(int rate, bool stereo, uint32 aheadMs) :
+		PrefetchingAudioStream(rate, stereo, aheadMs),
+		_current(nullptr), _pending(nullptr), _pendingPos(0), _pendingSize(0), _pendingCapacity(0),
+		_finished(false) {
+	// Nothing is queued yet
+	_idle = true;
+
+	RenderAheadManager::instance().add(this);
+}
+
+MusicQueueStream::~MusicQueueStream() {
+	// Waits for the timer proc if it is topping up this queue
+	if (RenderAheadManager::hasInstance())
+		RenderAheadManager::instance().remove(this);
+
+	if (_current)
+		deleteTrack(_current);
+	for (Common::List<Track *>::iterator it = _queue.begin(); it != _queue.end(); ++it)
+		deleteTrack(*it);
+
+	delete[] _pending;
+}
+
+void MusicQueueStream::queueTrack(AudioStream *track, uint32 crossfadeMs, DisposeAfterUse::Flag disposeAfterUse) {
+	Track *entry = new Track();
+	entry->stream = track;
+	entry->disposeAfterUse = disposeAfterUse;
+	entry->file = nullptr;
+	entry->makeStream = nullptr;
+	entry->fadeSamples = (int)(_rate * crossfadeMs / 1000) * _channels;
+	addTrack(entry);
+}
+
+void MusicQueueStream::queueTrack(Common::SeekableReadStream *file, MakeStreamProc makeStream, uint32 crossfadeMs) {
+	Track *entry = new Track();
+	entry->stream = nullptr;
+	entry->disposeAfterUse = DisposeAfterUse::YES;
+	entry->file = file;
+	entry->makeStream = makeStream;
+	entry->fadeSamples = (int)(_rate * crossfadeMs / 1000) * _channels;
+	addTrack(entry);
+}
+
+void MusicQueueStream::addTrack(Track *track) {
+	track->converter = nullptr;
+	track->primed = false;
+	track->head = nullptr;
+	track->headSize = 0;
+	track->headPos = 0;
+
+	Common::StackLock lock(_mutex);
+	_queue.push_back(track);
+	_idle = false;
+}
+
+void MusicQueueStream::finish() {
+	Common::StackLock lock(_mutex);
+	_finished = true;
+}
+
+uint32 MusicQueueStream::numQueuedTracks() const {
+	Common::StackLock lock(_mutex);
+	return _queue.size();
+}
+
+bool MusicQueueStream::openTrack(Track *track) {
+	if (track->file) {
+		track->stream = track->makeStream(track->file, DisposeAfterUse::YES);
+		track->file = nullptr;
+		if (!track->stream) {
+			warning("MusicQueueStream: Could not create the decoder of a track");
+			return false;
+		}
+	}
+
+	if (track->stream->getRate() != _rate || track->stream->isStereo() != isStereo())
+		track->converter = makeRateConverter(track->stream->getRate(), _rate, track->stream->isStereo(), isStereo(), false);
+
+	return true;
+}
+
+void MusicQueueStream::primeTrack(Track *track) {
+	track->primed = true;
+	if (!openTrack(track))
+		return;
+
+	// Decode the start of the track, including all of its crossfade, so
+	// the transition only mixes decoded samples
+	const int size = MAX<int>(track->fadeSamples, kPrimeFrames * _channels);
+	track->head = new int16[size];
+	track->headSize = readTrack(track, track->head, size);
+}
+
+int MusicQueueStream::readTrack(Track *track, int16 *buffer, int numSamples) {
+	int samples = 0;
+
+	if (track->headPos < track->headSize) {
+		samples = MIN(numSamples, track->headSize - track->headPos);
+		memcpy(buffer, track->head + track->headPos, samples * sizeof(int16));
+		track->headPos += samples;
+	}
+
+	if (track->converter) {
+		// The converter adds to the buffer, and counts in frames
+		memset(buffer + samples, 0, (numSamples - samples) * sizeof(int16));
+		while (samples < numSamples && (!track->stream->endOfData() || track->converter->needsDraining())) {
+			const int read = track->converter->convert(*track->stream, (byte *)(buffer + samples), sizeof(int16),
+			                                           (numSamples - samples) / _channels,
+			                                           Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume, MIX_ADD);
+			if (read <= 0)
+				break;
+			samples += read * _channels;
+		}
+		return samples;
+	}
+
+	while (samples < numSamples && !track->stream->endOfData()) {
+		const int read = track->stream->readBuffer(buffer + samples, numSamples - samples);
+		if (read <= 0)
+			break;
+		samples += read;
+	}
+
+	return samples;
+}
+
+bool MusicQueueStream::isTrackOver(const Track *track) const {
+	if (track->headPos < track->headSize || !track->stream->endOfData())
+		return false;
+	return !track->converter || !track->converter->needsDraining();
+}
+
+void MusicQueueStream::deleteTrack(Track *track) {
+	if (track->disposeAfterUse == DisposeAfterUse::YES)
+		delete track->stream;
+	delete track->file;
+	delete track->converter;
+	delete[] track->head;
+	delete track;
+}
+
+int MusicQueueStream::getNextFadeSamples() {
+	// Only a playing track can be crossfaded into the next one
+	if (!_current)
+		return 0;
+
+	Common::StackLock lock(_mutex);
+	return _queue.empty() ? 0 : _queue.front()->fadeSamples;
+}
+
+void MusicQueueStream::crossfade(Track *track) {
+	const int frames = MIN(track->fadeSamples, _pendingSize) / _channels;
+	if (!frames)
+		return;
+
+	int16 *tail = _pending + _pendingPos + _pendingSize - frames * _channels;
+	int16 chunk[kDecodeChunkFrames * 2];
+
+	for (int frame = 0; frame < frames; frame += kDecodeChunkFrames) {
+		const int samples = MIN<int>(frames - frame, kDecodeChunkFrames) * _channels;
+
+		// A track shorter than its crossfade is followed by silence
+		const int read = readTrack(track, chunk, samples);
+		memset(chunk + read, 0, (samples - read) * sizeof(int16));
+
+		for (int i = 0; i < samples; i++) {
+			const int64 fadeIn = frame + i / _channels;
+			int16 &sample = tail[frame * _channels + i];
+			sample = (int16)(((frames - fadeIn) * sample + fadeIn * chunk[i]) / frames);
+		}
+	}
+}
+
+bool MusicQueueStream::startNextTrack() {
+	for (;;) {
+		Track *track;
+		{
+			Common::StackLock lock(_mutex);
+			if (_queue.empty())
+				return false;
+			track = _queue.front();
+			_queue.pop_front();
+		}
+
+		if (!track->primed)
+			primeTrack(track);
+
+		if (!track->stream) {
+			deleteTrack(track);
+			continue;
+		}
+
+		crossfade(track);
+		_current = track;
+		return true;
+	}
+}
+
+bool MusicQueueStream::decodeChunk() {
+	if (!_current)
+		return startNextTrack();
+
+	const int chunkSize = kDecodeChunkFrames * _channels;
+	if (_pendingPos + _pendingSize + chunkSize > _pendingCapacity) {
+		if (_pendingSize + chunkSize > _pendingCapacity)
+			_pendingCapacity = MAX(_pendingCapacity * 2, _pendingSize + chunkSize);
+
+		int16 *pending = new int16[_pendingCapacity];
+		memcpy(pending, _pending + _pendingPos, _pendingSize * sizeof(int16));
+		delete[] _pending;
+		_pending = pending;
+		_pendingPos = 0;
+	}
+
+	const int read = readTrack(_current, _pending + _pendingPos + _pendingSize, chunkSize);
+	_pendingSize += read;
+
+	if (isTrackOver(_current)) {
+		// Move on to the next track right away, so there is no gap
+		deleteTrack(_current);
+		_current = nullptr;
+		startNextTrack();
+		return true;
+	}
+
+	return read > 0;
+}
+
+int MusicQueueStream::render(int16 *buffer, int numSamples) {
+	// Hold back as many samples as the next track fades over, until the
+	// current track ends and they are mixed with it
+	while (_pendingSize - getNextFadeSamples() < numSamples && decodeChunk()) {
+	}
+
+	const int samples = CLIP(_pendingSize - getNextFadeSamples(), 0, numSamples);
+	memcpy(buffer, _pending + _pendingPos, samples * sizeof(int16));
+	_pendingPos += samples;
+	_pendingSize -= samples;
+	if (!_pendingSize)
+		_pendingPos = 0;
+
+	return samples;
+}
+
+bool MusicQueueStream::isIdle() const {
+	// Called with _mutex held
+	return !_current && !_pendingSize && _queue.empty();
+}
+
+void MusicQueueStream::prefetch() {
+	PrefetchingAudioStream::prefetch();
+
+	// With the buffer full, there is the most time to open the next track
+	if (!beginRender())
+		return;
+
+	Track *next = nullptr;
+	{
+		Common::StackLock lock(_mutex);
+		if (!_queue.empty())
+			next = _queue.front();
+	}
+
+	if (next && !next->primed)
+		primeTrack(next);
+
+	endRender();
+}
+
+bool MusicQueueStream::endOfStream() const {
+	{
+		Common::StackLock lock(_mutex);
+		if (!_finished)
+			return false;
+	}
+
+	return endOfData();
+}
+
+} // End of namespace Audio
@@ -0,0 +1,191 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MUSIC_QUEUE_H
+#define AUDIO_MUSIC_QUEUE_H
+
+#include "audio/render_ahead.h"
+#include "common/list.h"
+#include "common/types.h"
+
+namespace Common {
+class SeekableReadStream;
+}
+
+namespace Audio {
+
+class RateConverter;
+
+/**
+ * @defgroup audio_music_queue Music queue
+ * @ingroup audio
+ *
+ * @brief Gapless, pre-buffered playback of a sequence of music tracks.
+ * @{
+ */
+
+/**
+ * Plays a sequence of music tracks without gaps, optionally crossfading
+ * from one track into the next.
+ *
+ * Unlike QueuingAudioStream, the tracks are rendered ahead of the mixer
+ * from the timer proc of RenderAheadManager, including the transitions
+ * between them. The next queued track is opened and its decoder primed
+ * well before the current track ends, so the mixer callback only has to
+ * copy finished samples.
+ *
+ * If the buffer runs dry, the missing samples are rendered directly in
+ * readBuffer(), like PrefetchingAudioStream does. Crossfades are sample
+ * accurate as long as a track is queued at least its crossfade length
+ * before the previous one ends, otherwise they are shortened.
+ *
+ * Tracks whose rate or channel count differ from those of the queue are
+ * converted, when they are rendered.
+ *
+ * The queue must not be disposed of by the mixer: its owner stops the
+ * handle, then deletes the queue.
+ */
+class MusicQueueStream : public PrefetchingAudioStream {
+public:
+	/**
+	 * Function creating a decoder for a music file, like makeVorbisStream().
+	 */
+	typedef SeekableAudioStream *(*MakeStreamProc)(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse);
+
+	/**
+	 * @param rate    the rate of the queue
+	 * @param stereo  whether the queue is stereo
+	 * @param aheadMs how many milliseconds to render ahead
+	 */
+	MusicQueueStream(int rate, bool stereo, uint32 aheadMs = 250);
+	~MusicQueueStream();
+
+	/**
+	 * Queue a track which is already open.
+	 *
+	 * It is still primed and played from the timer proc, so its
+	 * readBuffer() must not rely on being called on the mixer thread.
+	 *
+	 * @param track           the track to play
+	 * @param crossfadeMs     length of the crossfade from the previous
+	 *                        track, 0 to play the track right after it
+	 * @param disposeAfterUse whether to delete the track after playing it
+	 */
+	void queueTrack(AudioStream *track, uint32 crossfadeMs = 0, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::YES);
+
+	/**
+	 * Queue a track to be decoded from a file.
+	 *
+	 * The decoder is created on the timer proc, ahead of the time the
+	 * track starts, since setting up a decoder can take much longer than
+	 * a mixer callback. The file is opened by the caller, as the search
+	 * manager must not be used from other threads.
+	 *
+	 * @param file        the file to decode, which the queue takes
+	 *                    ownership of
+	 * @param makeStream  the function creating its decoder
+	 * @param crossfadeMs length of the crossfade from the previous track,
+	 *                    0 to play the track right after it
+	 */
+	void queueTrack(Common::SeekableReadStream *file, MakeStreamProc makeStream, uint32 crossfadeMs = 0);
+
+	/**
+	 * Mark the queue as finished, so it ends once the queued tracks have
+	 * been played.
+	 */
+	void finish();
+
+	/**
+	 * Return the number of tracks which have not started playing yet.
+	 * Tracks start when they are rendered, which is ahead of the time
+	 * they are heard.
+	 */
+	uint32 numQueuedTracks() const;
+
+	/**
+	 * Render ahead until the buffer is full, then open and prime the next
+	 * track.
+	 */
+	void prefetch() override;
+
+	bool endOfStream() const override;
+
+protected:
+	int render(int16 *buffer, int numSamples) override;
+	bool isIdle() const override;
+
+private:
+	struct Track {
+		AudioStream *stream;
+		DisposeAfterUse::Flag disposeAfterUse;
+
+		// The file to create the stream from, until the track is opened
+		Common::SeekableReadStream *file;
+		MakeStreamProc makeStream;
+
+		// Converts the track to the format of the queue, if it differs
+		RateConverter *converter;
+
+		// Number of samples to crossfade with the previous track
+		int fadeSamples;
+
+		bool primed;
+
+		// Samples decoded when priming the track, played before reading
+		// more from the stream
+		int16 *head;
+		int headSize;
+		int headPos;
+	};
+
+	void addTrack(Track *track);
+	bool openTrack(Track *track);
+	void primeTrack(Track *track);
+	int readTrack(Track *track, int16 *buffer, int numSamples);
+	bool isTrackOver(const Track *track) const;
+	void deleteTrack(Track *track);
+
+	bool decodeChunk();
+	bool startNextTrack();
+	void crossfade(Track *track);
+	int getNextFadeSamples();
+
+	// Only touched by the thread rendering the queue
+
+	Track *_current;
+	// Rendered samples held back from the output, as the start of the
+	// next crossfade may still be mixed into them
+	int16 *_pending;
+	int _pendingPos;
+	int _pendingSize;
+	int _pendingCapacity;
+
+	// Guarded by _mutex. Only the queue itself changes under it: the
+	// tracks in the queue are only touched by the renderer.
+	Common::List<Track *> _queue;
+	bool _finished;
+};
+
+/** @} */
+
+} // End of namespace Audio
+
+#endif
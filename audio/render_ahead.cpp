@@ -0,0 +1,262 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/render_ahead.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+namespace Common {
+DECLARE_SINGLETON(Audio::RenderAheadManager);
+}
+
+namespace Audio {
+
+enum {
+	// How often the timer proc tops up the buffer, in microseconds
+	kRenderInterval = 10000,
+	// Frames rendered per step, so the buffer is topped up in small pieces
+	kRenderChunkFrames = 256
+};
+
+PrefetchingAudioStream::PrefetchingAudioStream(int rate, bool stereo, uint32 aheadMs) :
+		_rate(rate), _channels(stereo ? 2 : 1), _idle(false),
+		_readPos(0), _fill(0), _rendering(false), _underruns(0), _maxCallbackTime(0) {
+	// Render at least two timer intervals ahead, otherwise the timer proc
+	// cannot keep up with the mixer
+	aheadMs = MAX<uint32>(aheadMs, 2 * kRenderInterval / 1000);
+
+	_targetFill = (int)(_rate * aheadMs / 1000) * _channels;
+	_bufferSize = _targetFill + kRenderChunkFrames * _channels;
+	_buffer = new int16[_bufferSize];
+	_minFill = _bufferSize;
+}
+
+PrefetchingAudioStream::~PrefetchingAudioStream() {
+	debug(2, "PrefetchingAudioStream: %u underruns, longest mixer callback %u ms, lowest buffer fill %u ms", _underruns, _maxCallbackTime, getMinBufferedTime());
+
+	delete[] _buffer;
+}
+
+bool PrefetchingAudioStream::beginRender() {
+	Common::StackLock lock(_mutex);
+	if (_rendering)
+		return false;
+	_rendering = true;
+	return true;
+}
+
+void PrefetchingAudioStream::endRender() {
+	Common::StackLock lock(_mutex);
+	_idle = isIdle();
+	_rendering = false;
+}
+
+void PrefetchingAudioStream::prefetch() {
+	const int chunkSize = kRenderChunkFrames * _channels;
+	int16 chunk[kRenderChunkFrames * 2];
+
+	for (;;) {
+		{
+			Common::StackLock lock(_mutex);
+			if (_rendering || _idle || _fill >= _targetFill)
+				return;
+			_rendering = true;
+		}
+
+		// Chip timer callbacks run in here, and may lock the mixer
+		const int samples = render(chunk, chunkSize);
+
+		Common::StackLock lock(_mutex);
+		appendToBuffer(chunk, samples);
+		_idle = isIdle();
+		_rendering = false;
+
+		if (samples < chunkSize)
+			return;
+	}
+}
+
+void PrefetchingAudioStream::appendToBuffer(const int16 *buffer, int numSamples) {
+	// Called with _mutex held
+	int writePos = (_readPos + _fill) % _bufferSize;
+	for (int i = 0; i < numSamples; i++) {
+		_buffer[writePos] = buffer[i];
+		if (++writePos == _bufferSize)
+			writePos = 0;
+	}
+	_fill += numSamples;
+}
+
+int PrefetchingAudioStream::copyFromBuffer(int16 *buffer, int numSamples) {
+	// Called with _mutex held
+	const int samples = MIN(numSamples, _fill);
+	const int first = MIN(samples, _bufferSize - _readPos);
+
+	memcpy(buffer, _buffer + _readPos, first * sizeof(int16));
+	memcpy(buffer + first, _buffer, (samples - first) * sizeof(int16));
+
+	_readPos = (_readPos + samples) % _bufferSize;
+	_fill -= samples;
+
+	return samples;
+}
+
+int PrefetchingAudioStream::readBuffer(int16 *buffer, const int numSamples) {
+	const uint32 start = g_system->getMillis();
+
+	int samples;
+	bool starved;
+	bool renderHere;
+	{
+		Common::StackLock lock(_mutex);
+		samples = copyFromBuffer(buffer, numSamples);
+
+		// Take over rendering if the timer proc fell behind, unless it is
+		// rendering right now. Waiting for it could deadlock, as it may be
+		// waiting for the mixer itself.
+		starved = samples < numSamples && !_idle;
+		renderHere = starved && !_rendering;
+		if (renderHere)
+			_rendering = true;
+	}
+
+	if (renderHere) {
+		const int rendered = render(buffer + samples, numSamples - samples);
+		starved = rendered > 0;
+		samples += rendered;
+	} else if (starved) {
+		memset(buffer + samples, 0, (numSamples - samples) * sizeof(int16));
+		samples = numSamples;
+	}
+
+	Common::StackLock lock(_mutex);
+	if (renderHere) {
+		_idle = isIdle();
+		_rendering = false;
+	}
+	if (starved)
+		_underruns++;
+
+	// Only count the fill while there is more to come, not while the
+	// last samples drain from the buffer
+	if (!_idle)
+		_minFill = MIN(_minFill, _fill);
+
+	_maxCallbackTime = MAX(_maxCallbackTime, g_system->getMillis() - start);
+
+	return samples;
+}
+
+bool PrefetchingAudioStream::endOfData() const {
+	Common::StackLock lock(_mutex);
+	return _idle && !_fill;
+}
+
+uint32 PrefetchingAudioStream::getBufferedTime() const {
+	Common::StackLock lock(_mutex);
+	return _fill / _channels * 1000 / _rate;
+}
+
+uint32 PrefetchingAudioStream::getMinBufferedTime() const {
+	Common::StackLock lock(_mutex);
+	return MIN(_minFill, _targetFill) / _channels * 1000 / _rate;
+}
+
+void PrefetchingAudioStream::resetStats() {
+	Common::StackLock lock(_mutex);
+	_underruns = 0;
+	_maxCallbackTime = 0;
+	_minFill = _bufferSize;
+}
+
+RenderAheadStream::RenderAheadStream(AudioStream *parent, uint32 aheadMs) :
+		PrefetchingAudioStream(parent->getRate(), parent->isStereo(), aheadMs), _parent(parent) {
+	RenderAheadManager::instance().add(this);
+}
+
+RenderAheadStream::~RenderAheadStream() {
+	// Waits for the timer proc if it is topping up this stream. Without a
+	// manager, the stream was already no longer topped up.
+	if (RenderAheadManager::hasInstance())
+		RenderAheadManager::instance().remove(this);
+}
+
+int RenderAheadStream::render(int16 *buffer, int numSamples) {
+	_parent->readBuffer(buffer, numSamples);
+	return numSamples;
+}
+
+RenderAheadStream *makeRenderAheadStream(AudioStream *parent) {
+	if (!ConfMan.hasKey("audio_render_ahead"))
+		return nullptr;
+
+	const int aheadMs = ConfMan.getInt("audio_render_ahead");
+	if (aheadMs <= 0)
+		return nullptr;
+
+	return new RenderAheadStream(parent, aheadMs);
+}
+
+RenderAheadManager::RenderAheadManager() {
+	// The null backend used by the tests has no timer manager, the streams
+	// are then only filled by prefetch() and the mixer
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+	if (timerManager)
+		timerManager->installTimerProc(timerProc, kRenderInterval, this, "RenderAheadManager");
+}
+
+RenderAheadManager::~RenderAheadManager() {
+	// Streams still playing keep working, but render in the mixer callback
+	// again, like they would without render-ahead
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+	if (timerManager)
+		timerManager->removeTimerProc(timerProc);
+}
+
+void RenderAheadManager::add(PrefetchingAudioStream *stream) {
+	Common::StackLock lock(_mutex);
+	_streams.push_back(stream);
+}
+
+void RenderAheadManager::remove(PrefetchingAudioStream *stream) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _streams.size(); i++) {
+		if (_streams[i] == stream) {
+			_streams.remove_at(i);
+			break;
+		}
+	}
+}
+
+void RenderAheadManager::timerProc(void *refCon) {
+	RenderAheadManager *manager = static_cast<RenderAheadManager *>(refCon);
+	Common::StackLock lock(manager->_mutex);
+
+	for (uint i = 0; i < manager->_streams.size(); i++)
+		manager->_streams[i]->prefetch();
+}
+
+} // End of namespace Audio
@@ -0,0 +1,210 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_RENDER_AHEAD_H
+#define AUDIO_RENDER_AHEAD_H
+
+#include "audio/audiostream.h"
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/types.h"
+
+namespace Audio {
+
+/**
+ * Base class of streams which are rendered ahead of the mixer from a timer
+ * proc of RenderAheadManager, into a ring buffer. The mixer callback then
+ * only has to copy finished samples.
+ *
+ * If the buffer runs dry, the missing samples are rendered directly in
+ * readBuffer(). Rendering is never done with a lock held which the mixer
+ * callback waits for, as what is rendered may lock the mixer itself. If
+ * the buffer runs dry while the timer proc is rendering, the mixer callback
+ * does not wait for it, but plays silence instead.
+ *
+ * Subclasses register with RenderAheadManager in their constructor and
+ * unregister at the start of their destructor, before anything render()
+ * uses is destroyed. Unregistering waits for the timer proc, so the stream
+ * must not be disposed of by the mixer: its owner stops the handle, then
+ * deletes the stream.
+ */
+class PrefetchingAudioStream : public AudioStream {
+public:
+	/**
+	 * @param rate    the rate of the stream
+	 * @param stereo  whether the stream is stereo
+	 * @param aheadMs how many milliseconds to render ahead
+	 */
+	PrefetchingAudioStream(int rate, bool stereo, uint32 aheadMs);
+	~PrefetchingAudioStream();
+
+	int readBuffer(int16 *buffer, const int numSamples) override;
+	bool isStereo() const override { return _channels == 2; }
+	int getRate() const override { return _rate; }
+	bool endOfData() const override;
+
+	/**
+	 * Render ahead until the buffer is full. This is called from a timer
+	 * proc; call it directly to fill the buffer before playing the stream.
+	 */
+	virtual void prefetch();
+
+	/**
+	 * Return how many mixer callbacks ran out of samples, and either had to
+	 * render them themselves or played silence.
+	 */
+	uint32 getUnderruns() const { return _underruns; }
+
+	/** Return the longest time a mixer callback took, in milliseconds. */
+	uint32 getMaxCallbackTime() const { return _maxCallbackTime; }
+
+	/** Return how many milliseconds are rendered ahead. */
+	uint32 getBufferedTime() const;
+
+	/**
+	 * Return the lowest number of milliseconds which were rendered ahead
+	 * when a mixer callback returned, while there was more to render.
+	 */
+	uint32 getMinBufferedTime() const;
+
+	/** Reset the underrun count, the callback time and the lowest buffer fill. */
+	void resetStats();
+
+protected:
+	/**
+	 * Render the next samples. This is only called by one thread at a time,
+	 * and with no lock held.
+	 *
+	 * @return the number of samples rendered, which is only less than
+	 *         @p numSamples if there is nothing more to render for now
+	 */
+	virtual int render(int16 *buffer, int numSamples) = 0;
+
+	/**
+	 * Return whether there is nothing to render right now. This is called
+	 * with _mutex held, by the thread which called render() last.
+	 */
+	virtual bool isIdle() const { return false; }
+
+	/**
+	 * Claim the right to render, for work render() cannot be interrupted
+	 * by, such as preparing what it renders next.
+	 *
+	 * @return whether it was claimed; if so, call endRender() afterwards
+	 */
+	bool beginRender();
+	void endRender();
+
+	const int _rate;
+	const int _channels;
+
+	// Guards the buffer and the statistics. It is only held to update
+	// them and copy samples, never while rendering. Subclasses may use it
+	// for their own short updates.
+	mutable Common::Mutex _mutex;
+
+	// Set when there is nothing to render, updated with isIdle() after
+	// each render and cleared by subclasses when there is more to render
+	bool _idle;
+
+private:
+	int copyFromBuffer(int16 *buffer, int numSamples);
+	void appendToBuffer(const int16 *buffer, int numSamples);
+
+	int16 *_buffer;
+	int _bufferSize;
+	int _targetFill;
+	int _readPos;
+	int _fill;
+	// Set while a thread renders, which others must not do then
+	bool _rendering;
+
+	uint32 _underruns;
+	uint32 _maxCallbackTime;
+	int _minFill;
+};
+
+/**
+ * Plays an endless stream, such as an emulated sound chip, which is
+ * rendered ahead of the mixer. This keeps the mixer callback short on slow
+ * systems where the emulation itself takes a large part of the audio buffer
+ * time.
+ *
+ * Everything the parent stream does while rendering, including chip timer
+ * callbacks, happens on the thread that renders it, and changes made to
+ * the parent from outside are heard after the render-ahead delay. The
+ * stream must not be deleted in a callback of the parent.
+ */
+class RenderAheadStream : public PrefetchingAudioStream {
+public:
+	/**
+	 * @param parent  the stream to play, which must not end
+	 * @param aheadMs how many milliseconds to render ahead
+	 */
+	RenderAheadStream(AudioStream *parent, uint32 aheadMs);
+	~RenderAheadStream();
+
+protected:
+	int render(int16 *buffer, int numSamples) override;
+
+private:
+	AudioStream *_parent;
+};
+
+/**
+ * Wrap an endless stream into a RenderAheadStream if render-ahead is
+ * enabled with the "audio_render_ahead" config key, which holds the number
+ * of milliseconds to render ahead.
+ *
+ * @return the new stream, or nullptr if render-ahead is disabled
+ */
+RenderAheadStream *makeRenderAheadStream(AudioStream *parent);
+
+/**
+ * Tops up all prefetching streams from one timer proc, as the timer
+ * manager does not allow installing the same proc twice.
+ *
+ * Streams only unregister here when they are destroyed, and never touch
+ * the timer manager themselves. The timer proc is removed when the engine
+ * is destroyed.
+ */
+class RenderAheadManager : public Common::Singleton<RenderAheadManager> {
+public:
+	void add(PrefetchingAudioStream *stream);
+
+	/** Remove a stream, waiting for the timer proc if it is topping it up. */
+	void remove(PrefetchingAudioStream *stream);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	RenderAheadManager();
+	~RenderAheadManager();
+
+	static void timerProc(void *refCon);
+
+	Common::Mutex _mutex;
+	Common::Array<PrefetchingAudioStream *> _streams;
+};
+
+} // End of namespace Audio
+
+#endif
@@ -29,6 +29,7 @@
 #include "audio/softsynth/mt32/lcd_bg_data.h"
 #include "audio/musicplugin.h"
 #include "audio/mpu401.h"
+#include "audio/render_ahead.h"
 
 #include "common/config-manager.h"
 #include "common/debug.h"
@@ -238,6 +239,7 @@ private:
 	Common::Mutex _mutex;
 
 	int _outputRate;
+	Audio::RenderAheadStream *_renderAhead;
 
 protected:
 	void generateSamples(int16 *buf, int len) override;
@@ -274,6 +276,7 @@ MidiDriver_MT32::MidiDriver_MT32(Audio::Mixer *mixer) : MidiDriver_Emulated(mixe
 		_midiChannels[i].init(this, i);
 	}
 	_outputRate = 0;
+	_renderAhead = nullptr;
 	_controlData = nullptr;
 	_pcmData = nullptr;
 }
@@ -341,7 +344,12 @@ int MidiDriver_MT32::open() {
 
 	MidiDriver_Emulated::open();
 
-	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
+	// The stream is deleted in close() rather than by the mixer
+	_renderAhead = Audio::makeRenderAheadStream(this);
+	if (_renderAhead)
+		_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, _renderAhead, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
+	else
+		_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
 }
@@ -394,6 +402,11 @@ void MidiDriver_MT32::close() {
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
 
+	// Deleting the stream waits for the timer proc rendering it, which must
+	// not happen with the mixer or _mutex locked
+	delete _renderAhead;
+	_renderAhead = nullptr;
+
 	Common::StackLock lock(_mutex);
 	_service.closeSynth();
 	_service.freeContext();
@@ -366,7 +366,14 @@ public:
 	}
 
 	Sample getOutputAt(const Bit32u outIndex) const {
+#ifdef MT32EMU_SCUMMVM_REVERB_TAPS
+		// ScummVM: Avoid a division per tap, this is called up to 7 times per sample.
+		// outIndex never exceeds the buffer size, which holds for all the output and feedback positions.
+		const Bit32u pos = this->index >= outIndex ? this->index - outIndex : this->size + this->index - outIndex;
+		return this->buffer[pos];
+#else
 		return this->buffer[(this->size + this->index - outIndex) % this->size];
+#endif
 	}
 
 	void setFeedbackFactor(const Bit8u useFeedbackFactor) {
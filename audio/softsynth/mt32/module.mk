@@ -30,6 +30,11 @@ MODULE_OBJS := \
 	srchelper/srctools/src/SincResampler.o \
 	SampleRateConverter.o
 
+# ScummVM-local changes to the munt sources, kept behind defines so the
+# sources can still be updated from upstream as they are. The golden
+# outputs in test/audio/mt32.h check that they are bit-identical.
+$(MODULE)/BReverbModel.o: CXXFLAGS += -DMT32EMU_SCUMMVM_REVERB_TAPS
+
 # Include common rules
 include $(srcdir)/rules.mk
 
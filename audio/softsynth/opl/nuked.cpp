@@ -1686,15 +1686,36 @@ void OPL3_Generate4ChStream(opl3_chip *chip, int16_t *sndptr1, int16_t *sndptr2,
     }
 }
 
+/* Batched OPL3_GenerateResampled: the resampler position stays in a local
+ * for the whole block and only the two output channels are interpolated.
+ * The chip state afterwards is the same as after numsamples calls to
+ * OPL3_GenerateResampled. */
 void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
 {
+    const int32_t rateratio = chip->rateratio;
+    int32_t samplecnt = chip->samplecnt;
     uint_fast32_t i;
 
     for(i = 0; i < numsamples; i++)
     {
-        OPL3_GenerateResampled(chip, sndptr);
+        while (samplecnt >= rateratio)
+        {
+            chip->oldsamples[0] = chip->samples[0];
+            chip->oldsamples[1] = chip->samples[1];
+            chip->oldsamples[2] = chip->samples[2];
+            chip->oldsamples[3] = chip->samples[3];
+            OPL3_Generate4Ch(chip, chip->samples);
+            samplecnt -= rateratio;
+        }
+        sndptr[0] = (int16_t)((chip->oldsamples[0] * (rateratio - samplecnt)
+                              + chip->samples[0] * samplecnt) / rateratio);
+        sndptr[1] = (int16_t)((chip->oldsamples[1] * (rateratio - samplecnt)
+                              + chip->samples[1] * samplecnt) / rateratio);
+        samplecnt += 1 << RSM_FRAC;
         sndptr += 2;
     }
+
+    chip->samplecnt = samplecnt;
 }
 
 
@@ -1793,7 +1814,7 @@ void OPL::dualWrite(uint8 index, uint8 reg, uint8 val) {
 }
 
 void OPL::generateSamples(int16*buffer, int length) {
-	OPL3_GenerateStream(&chip, (int16_t*)buffer, (uint16_t)length / 2);
+	OPL3_GenerateStream(&chip, (int16_t*)buffer, (uint32_t)length / 2);
 }
 
 }
@@ -0,0 +1,220 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/sound_cache.h"
+#include "audio/audiostream.h"
+
+#include "common/debug.h"
+#include "common/util.h"
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SoundCache);
+}
+
+namespace Audio {
+
+/**
+ * Plays a sound from the cache.
+ */
+class CachedSoundStream : public SeekableAudioStream {
+public:
+	CachedSoundStream(const SoundCache::SoundRef &sound) :
+			_sound(sound), _samples(sound->samples), _numSamples(sound->numSamples), _pos(0) {
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const int samples = MIN<uint32>(numSamples, _numSamples - _pos);
+		memcpy(buffer, _samples + _pos, samples * sizeof(int16));
+		_pos += samples;
+		return samples;
+	}
+
+	bool isStereo() const override { return _sound->stereo; }
+	int getRate() const override { return _sound->rate; }
+	bool endOfData() const override { return _pos >= _numSamples; }
+
+	bool seek(const Timestamp &where) override {
+		const uint32 pos = convertTimeToStreamPos(where, getRate(), isStereo()).totalNumberOfFrames();
+		if (pos > _numSamples)
+			return false;
+
+		_pos = pos;
+		return true;
+	}
+
+	Timestamp getLength() const override {
+		return Timestamp(0, _numSamples / (isStereo() ? 2 : 1), getRate());
+	}
+
+private:
+	const SoundCache::SoundRef _sound;
+	const int16 *_samples;
+	const uint32 _numSamples;
+	uint32 _pos;
+};
+
+void SoundCache::Sound::acquire() {
+	Common::StackLock lock(mutex);
+	refCount++;
+}
+
+void SoundCache::Sound::release() {
+	bool unused;
+	{
+		Common::StackLock lock(mutex);
+		unused = --refCount == 0;
+	}
+
+	if (unused)
+		delete this;
+}
+
+SoundCache::SoundCache() :
+		_cache(16 * 1024 * 1024),
+		_soundLimit(1024 * 1024),
+		_hits(0),
+		_misses(0) {
+}
+
+Common::String SoundCache::makeKey(const Common::Path &path, uint32 offset) {
+	// The offset goes first, as it cannot contain the path separator
+	return Common::String::format("%u|", offset) + path.toString('/');
+}
+
+SeekableAudioStream *SoundCache::get(const Common::Path &path, uint32 offset) {
+	Common::StackLock lock(_mutex);
+
+	const SoundRef *sound = _cache.get(makeKey(path, offset));
+	if (!sound) {
+		_misses++;
+		return nullptr;
+	}
+
+	_hits++;
+	return new CachedSoundStream(*sound);
+}
+
+SeekableAudioStream *SoundCache::put(const Common::Path &path, uint32 offset, SeekableAudioStream *stream) {
+	if (!stream || !getMemoryLimit())
+		return stream;
+
+	const Common::String key = makeKey(path, offset);
+	{
+		Common::StackLock lock(_mutex);
+		if (_tooLong.contains(key))
+			return stream;
+	}
+
+	Sound *sound = decode(stream);
+	if (!sound) {
+		Common::StackLock lock(_mutex);
+		_tooLong[key] = true;
+		return stream;
+	}
+	delete stream;
+
+	const uint32 size = sound->numSamples * sizeof(int16);
+
+	Common::StackLock lock(_mutex);
+
+	// Streams still playing an evicted sound keep it alive
+	const SoundRef &cached = _cache.put(key, SoundRef(sound), size);
+
+	debug(5, "SoundCache: Added %s (%d bytes), %d of %d bytes in use", key.c_str(), size, _cache.getMemoryUsage(), _cache.getMemoryLimit());
+	return new CachedSoundStream(cached);
+}
+
+SoundCache::Sound *SoundCache::decode(SeekableAudioStream *stream) const {
+	const uint32 limit = MIN(_soundLimit, _cache.getMemoryLimit()) / sizeof(int16);
+	const int channels = stream->isStereo() ? 2 : 1;
+
+	// Skip the decoding if the length is known to be too long
+	const uint32 frames = stream->getLength().convertToFramerate(stream->getRate()).totalNumberOfFrames();
+	if (frames * channels > limit)
+		return nullptr;
+
+	// Decoders which cannot tell their length report 0, so read up to the
+	// limit in that case
+	uint32 capacity = frames ? frames * channels : MIN<uint32>(limit, 65536);
+	int16 *samples = new int16[capacity];
+	uint32 numSamples = 0;
+
+	while (!stream->endOfData()) {
+		if (numSamples == capacity) {
+			if (capacity == limit) {
+				delete[] samples;
+				stream->rewind();
+				return nullptr;
+			}
+
+			const uint32 newCapacity = MIN(capacity * 2, limit);
+			int16 *newSamples = new int16[newCapacity];
+			memcpy(newSamples, samples, numSamples * sizeof(int16));
+			delete[] samples;
+			samples = newSamples;
+			capacity = newCapacity;
+		}
+
+		const int read = stream->readBuffer(samples + numSamples, capacity - numSamples);
+		if (read <= 0)
+			break;
+		numSamples += read;
+	}
+
+	if (numSamples < capacity) {
+		int16 *newSamples = new int16[numSamples];
+		memcpy(newSamples, samples, numSamples * sizeof(int16));
+		delete[] samples;
+		samples = newSamples;
+	}
+
+	return new Sound(samples, numSamples, stream->getRate(), stream->isStereo());
+}
+
+void SoundCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	_cache.clear();
+	_tooLong.clear();
+}
+
+void SoundCache::setMemoryLimit(uint32 bytes) {
+	Common::StackLock lock(_mutex);
+
+	_cache.setMemoryLimit(bytes);
+	_tooLong.clear();
+}
+
+void SoundCache::setSoundLimit(uint32 bytes) {
+	Common::StackLock lock(_mutex);
+
+	_soundLimit = bytes;
+	_tooLong.clear();
+}
+
+void SoundCache::resetStats() {
+	Common::StackLock lock(_mutex);
+
+	_hits = 0;
+	_misses = 0;
+}
+
+} // End of namespace Audio
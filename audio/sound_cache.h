@@ -0,0 +1,185 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_SOUND_CACHE_H
+#define AUDIO_SOUND_CACHE_H
+
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/lru-cache.h"
+#include "common/mutex.h"
+#include "common/path.h"
+#include "common/singleton.h"
+
+namespace Audio {
+
+class SeekableAudioStream;
+
+/**
+ * @defgroup audio_sound_cache Decoded sound cache
+ * @ingroup audio
+ *
+ * @brief Process-wide cache of decoded sounds.
+ * @{
+ */
+
+/**
+ * A memory-bounded, least-recently-used cache of fully decoded short
+ * sounds.
+ *
+ * Engines which play the same compressed sound effects over and over,
+ * like footsteps or button clicks, can use it to decode each of them
+ * only once. Cached sounds are played by a stream which only copies the
+ * decoded samples.
+ *
+ * Sounds are identified by the path of the file they are stored in,
+ * together with their offset in that file, so several sounds in one
+ * archive can be told apart.
+ *
+ * Streams handed out by the cache stay valid when their sound is evicted
+ * or the cache is destroyed, and may be played and destroyed on the mixer
+ * thread.
+ *
+ * The cache is emptied whenever an engine is destroyed, since the paths
+ * are only unique within a game.
+ *
+ * Used in engines:
+ * - Wintermute
+ */
+class SoundCache : public Common::Singleton<SoundCache> {
+public:
+	/**
+	 * Look up a decoded sound.
+	 *
+	 * @param path    Path of the file containing the sound.
+	 * @param offset  Offset of the sound in that file.
+	 * @return A new stream playing the cached sound, or nullptr if the
+	 *         sound is not cached.
+	 */
+	SeekableAudioStream *get(const Common::Path &path, uint32 offset = 0);
+
+	/**
+	 * Decode a sound completely and add it to the cache.
+	 *
+	 * Sounds longer than the sound size limit are not cached. Least
+	 * recently used sounds are evicted to stay within the memory limit.
+	 *
+	 * The stream must be at its start. The cache takes ownership of it.
+	 *
+	 * @param path    Path of the file containing the sound.
+	 * @param offset  Offset of the sound in that file.
+	 * @param stream  Stream decoding the sound, may be nullptr.
+	 * @return A stream playing the cached sound, or the passed stream if
+	 *         the sound was not cached.
+	 */
+	SeekableAudioStream *put(const Common::Path &path, uint32 offset, SeekableAudioStream *stream);
+
+	/** Remove all sounds from the cache. */
+	void clear();
+
+	/** Set the maximum amount of sample data kept in the cache, in bytes. 0 disables the cache. */
+	void setMemoryLimit(uint32 bytes);
+
+	/** Set the maximum size of the sample data of a single sound, in bytes. */
+	void setSoundLimit(uint32 bytes);
+
+	/** Reset the hit and miss counters. */
+	void resetStats();
+
+	uint32 getMemoryLimit() const { return _cache.getMemoryLimit(); }
+	uint32 getSoundLimit() const { return _soundLimit; }
+	uint32 getMemoryUsage() const { return _cache.getMemoryUsage(); }
+	uint32 getEntryCount() const { return _cache.size(); }
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	friend class CachedSoundStream;
+	SoundCache();
+
+	/**
+	 * Decoded samples, shared by the cache and the streams playing them.
+	 * The streams may be destroyed on the mixer thread, even after the
+	 * cache, so the sound guards its reference count itself.
+	 */
+	struct Sound {
+		Sound(int16 *s, uint32 n, int r, bool st) : samples(s), numSamples(n), rate(r), stereo(st), refCount(1) {}
+		~Sound() { delete[] samples; }
+
+		void acquire();
+		void release();
+
+		int16 *const samples;
+		const uint32 numSamples;
+		const int rate;
+		const bool stereo;
+
+	private:
+		Common::Mutex mutex;
+		uint32 refCount;
+	};
+
+	/** Reference to a sound, which frees it when the last one is gone. */
+	class SoundRef {
+	public:
+		SoundRef() : _sound(nullptr) {}
+		/** Take over the initial reference of a new sound. */
+		explicit SoundRef(Sound *sound) : _sound(sound) {}
+		SoundRef(const SoundRef &ref) : _sound(ref._sound) { if (_sound) _sound->acquire(); }
+		~SoundRef() { if (_sound) _sound->release(); }
+
+		SoundRef &operator=(const SoundRef &ref) {
+			if (ref._sound)
+				ref._sound->acquire();
+			if (_sound)
+				_sound->release();
+			_sound = ref._sound;
+			return *this;
+		}
+
+		Sound *operator->() const { return _sound; }
+
+	private:
+		Sound *_sound;
+	};
+
+	typedef Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> KeySet;
+
+	static Common::String makeKey(const Common::Path &path, uint32 offset);
+	Sound *decode(SeekableAudioStream *stream) const;
+
+	// Guards everything below
+	Common::Mutex _mutex;
+
+	Common::LRUCache<Common::String, SoundRef, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> _cache;
+	// Sounds found to be too long, so they are not decoded again
+	KeySet _tooLong;
+	uint32 _soundLimit;
+	uint32 _hits;
+	uint32 _misses;
+};
+
+/** @} */
+
+} // End of namespace Audio
+
+#endif
@@ -19,10 +19,28 @@
  *
  */
 
+#ifdef POSIX
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#include <sys/time.h>
+#endif
+
 #include "backends/mixer/null/null-mixer.h"
+#include "common/endian.h"
 #include "common/savefile.h"
+#include "common/system.h"
+
+static uint64 getProfileTime() {
+#ifdef POSIX
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+	return (uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+	// Only usable without the events recorder, which fakes the time
+	return (uint64)g_system->getMillis() * 1000;
+#endif
+}
 
-NullMixerManager::NullMixerManager() : MixerManager() {
+NullMixerManager::NullMixerManager() : MixerManager(), _wav(nullptr), _renderedFrames(0) {
 	_outputRate = 22050;
 	_callsCounter = 0;
 	_samples = 8192;
@@ -32,6 +50,8 @@ NullMixerManager::NullMixerManager() : MixerManager() {
 }
 
 NullMixerManager::~NullMixerManager() {
+	if (_wav)
+		stopRendering();
 	delete[] _samplesBuf;
 }
 
@@ -58,7 +78,7 @@ bool NullMixerManager::isNullDevice() const {
 }
 
 void NullMixerManager::update(uint8 callbackPeriod) {
-	if (_audioSuspended) {
+	if (_audioSuspended || _wav) {
 		return;
 	}
 	_callsCounter++;
@@ -67,3 +87,65 @@ void NullMixerManager::update(uint8 callbackPeriod) {
 		_mixer->mixCallback(_samplesBuf, _samples);
 	}
 }
+
+void NullMixerManager::startRendering(Common::SeekableWriteStream *wav) {
+	assert(_mixer && !_wav);
+	_wav = wav;
+	_renderedFrames = 0;
+
+	// The sizes are filled in by stopRendering()
+	_wav->writeUint32BE(MKTAG('R', 'I', 'F', 'F'));
+	_wav->writeUint32LE(0);
+	_wav->writeUint32BE(MKTAG('W', 'A', 'V', 'E'));
+	_wav->writeUint32BE(MKTAG('f', 'm', 't', ' '));
+	_wav->writeUint32LE(16);
+	_wav->writeUint16LE(1);
+	_wav->writeUint16LE(2);
+	_wav->writeUint32LE(_outputRate);
+	_wav->writeUint32LE(_outputRate * 4);
+	_wav->writeUint16LE(4);
+	_wav->writeUint16LE(16);
+	_wav->writeUint32BE(MKTAG('d', 'a', 't', 'a'));
+	_wav->writeUint32LE(0);
+
+	_mixer->setProfileClock(getProfileTime);
+}
+
+void NullMixerManager::renderUntil(uint32 millis) {
+	assert(_wav);
+
+	const uint64 frames = (uint64)millis * _outputRate / 1000;
+	while (_renderedFrames + _samples <= frames) {
+		if (_audioSuspended)
+			memset(_samplesBuf, 0, _samples * 4);
+		else
+			_mixer->mixCallback(_samplesBuf, _samples * 4);
+
+#ifdef SCUMM_LITTLE_ENDIAN
+		_wav->write(_samplesBuf, _samples * 4);
+#else
+		const int16 *samples = (const int16 *)_samplesBuf;
+		for (uint32 i = 0; i < _samples * 2; i++)
+			_wav->writeSint16LE(samples[i]);
+#endif
+		_renderedFrames += _samples;
+	}
+}
+
+Audio::MixerImpl::Profile NullMixerManager::stopRendering() {
+	assert(_wav);
+
+	const uint32 dataSize = _renderedFrames * 4;
+	_wav->seek(4, SEEK_SET);
+	_wav->writeUint32LE(36 + dataSize);
+	_wav->seek(40, SEEK_SET);
+	_wav->writeUint32LE(dataSize);
+	_wav->finalize();
+
+	delete _wav;
+	_wav = nullptr;
+
+	const Audio::MixerImpl::Profile profile = _mixer->getProfile();
+	_mixer->setProfileClock(nullptr);
+	return profile;
+}
@@ -24,6 +24,10 @@
 
 #include "backends/mixer/mixer.h"
 
+namespace Common {
+class SeekableWriteStream;
+}
+
 /** Audio mixer which in fact does not output audio.
  *
  *  It is used by events recorder since the recorder is intentionally
@@ -31,6 +35,11 @@
  *
  *  It returns correct output and shoots callbacks, so all OSystem
  *  users could work without modifications.
+ *
+ *  It can also render the output to a WAV file, mixing from a virtual
+ *  clock as fast as possible. Together with the events recorder, that
+ *  allows replaying a session headless and comparing both the audio and
+ *  the time spent mixing it against a reference.
  */
 
 class NullMixerManager : public MixerManager {
@@ -46,11 +55,41 @@ public:
 
 	bool isNullDevice() const override;
 
+	/**
+	 * Start writing the mixer output to a WAV file, and profiling the
+	 * mixer with a real time clock.
+	 *
+	 * While rendering, update() does nothing: the mixer is driven by
+	 * renderUntil() instead. The virtual clock starts at 0.
+	 *
+	 * @param wav  the stream to write to, which the mixer manager takes
+	 *             ownership of
+	 */
+	void startRendering(Common::SeekableWriteStream *wav);
+
+	/**
+	 * Mix until the output reaches the given time of the virtual clock.
+	 * Silence is written while audio is suspended.
+	 */
+	void renderUntil(uint32 millis);
+
+	/**
+	 * Complete the WAV file and stop rendering.
+	 *
+	 * @return the profile of the mixer while rendering
+	 */
+	Audio::MixerImpl::Profile stopRendering();
+
+	bool isRendering() const { return _wav != nullptr; }
+
 private:
 	uint32 _outputRate;
 	uint32 _callsCounter;
 	uint32 _samples;
 	uint8 *_samplesBuf;
+
+	Common::SeekableWriteStream *_wav;
+	uint64 _renderedFrames;
 };
 
 #endif
@@ -24,6 +24,7 @@ MODULE_OBJS := \
 	midi/stmidi.o \
 	midi/timidity.o \
 	saves/savefile.o \
+	saves/default/async-saves.o \
 	saves/default/default-saves.o \
 	timer/default/default-timer.o
 
@@ -53,12 +53,13 @@ typedef void (*sighandler_t)(int);
 #include "backends/mutex/null/null-mutex.h"
 #include "base/main.h"
 
-#ifndef NULL_DRIVER_USE_FOR_TEST
+#include "backends/graphics/null/null-graphics.h"
 #include "backends/saves/default/default-saves.h"
+
+#ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
-#include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
 #endif
 
@@ -144,6 +145,9 @@ void OSystem_NULL::initBackend() {
 	_startTime = GetTickCount();
 #endif
 
+	_savefileManager = new DefaultSaveFileManager();
+	_graphicsManager = new NullGraphicsManager();
+
 #ifndef NULL_DRIVER_USE_FOR_TEST
 #ifdef POSIX
 	last_handler = signal(SIGINT, intHandler);
@@ -151,8 +155,6 @@ void OSystem_NULL::initBackend() {
 
 	_timerManager = new DefaultTimerManager();
 	_eventManager = new DefaultEventManager(this);
-	_savefileManager = new DefaultSaveFileManager();
-	_graphicsManager = new NullGraphicsManager();
 	_mixerManager = new NullMixerManager();
 	// Setup and start mixer
 	_mixerManager->init();
@@ -0,0 +1,264 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+
+#include "backends/saves/default/async-saves.h"
+#include "backends/saves/default/default-saves.h"
+
+#include "common/ptr.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+namespace Common {
+DECLARE_SINGLETON(AsyncSaveWriter);
+}
+
+enum {
+	// At the fastest compression level, a chunk takes a few milliseconds
+	kChunkSize = 128 * 1024,
+	kProcessInterval = 10 * 1000
+};
+
+/**
+ * Buffers the data of a save file, and queues it for writing when the file
+ * is finalized or deleted. Unlike a compressed file, it can be seeked.
+ */
+class AsyncSaveStream : public Common::SeekableWriteStream {
+public:
+	AsyncSaveStream(DefaultSaveFileManager *manager, const Common::FSNode &node, const DefaultSaveFileManager::Compression &compression) :
+			_manager(manager), _node(node), _compression(compression),
+			_buffer(DisposeAfterUse::NO), _queued(false) {
+	}
+
+	~AsyncSaveStream() {
+		finalize();
+	}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) override {
+		if (_queued)
+			return 0;
+		return _buffer.write(dataPtr, dataSize);
+	}
+
+	void finalize() override {
+		if (_queued)
+			return;
+		_queued = true;
+
+		AsyncSaveWriter::Job *job = new AsyncSaveWriter::Job();
+		job->manager = _manager;
+		job->node = _node;
+		job->compression = _compression;
+		job->data = _buffer.getData();
+		job->size = _buffer.size();
+		job->pos = 0;
+		job->stream = nullptr;
+		job->buffer = nullptr;
+		job->compressed = false;
+		job->error = Common::kNoError;
+		AsyncSaveWriter::instance().queue(job);
+	}
+
+	int64 pos() const override { return _buffer.pos(); }
+	int64 size() const override { return _buffer.size(); }
+	bool seek(int64 offset, int whence = SEEK_SET) override { return !_queued && _buffer.seek(offset, whence); }
+
+private:
+	DefaultSaveFileManager *_manager;
+	Common::FSNode _node;
+	DefaultSaveFileManager::Compression _compression;
+
+	Common::MemoryWriteStreamDynamic _buffer;
+	bool _queued;
+};
+
+AsyncSaveWriter::AsyncSaveWriter() {
+	// The null backend used by the tests has no timer manager, the files
+	// are then only compressed by flush()
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+	if (timerManager)
+		timerManager->installTimerProc(timerProc, kProcessInterval, this, "AsyncSaveWriter");
+}
+
+AsyncSaveWriter::~AsyncSaveWriter() {
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+	if (timerManager)
+		timerManager->removeTimerProc(timerProc);
+
+	flush();
+}
+
+Common::OutSaveFile *AsyncSaveWriter::openForSaving(DefaultSaveFileManager *manager, const Common::FSNode &node, const DefaultSaveFileManager::Compression &compression) {
+	return new Common::OutSaveFile(new AsyncSaveStream(manager, node, compression));
+}
+
+bool AsyncSaveWriter::hasPendingSaves(const DefaultSaveFileManager *manager) const {
+	Common::StackLock lock(_queueMutex);
+
+	for (Common::List<Job *>::const_iterator it = _jobs.begin(); it != _jobs.end(); ++it) {
+		if ((*it)->manager == manager && !(*it)->compressed)
+			return true;
+	}
+	return false;
+}
+
+bool AsyncSaveWriter::isPending(const DefaultSaveFileManager *manager, const Common::String &name) const {
+	Common::StackLock lock(_queueMutex);
+
+	for (Common::List<Job *>::const_iterator it = _jobs.begin(); it != _jobs.end(); ++it) {
+		if ((*it)->manager == manager && (*it)->node.getName().equalsIgnoreCase(name))
+			return true;
+	}
+	return false;
+}
+
+void AsyncSaveWriter::flush() {
+	Common::StackLock lock(_processMutex);
+
+	compress(0xFFFFFFFF);
+
+	while (true) {
+		Job *job;
+		{
+			Common::StackLock queueLock(_queueMutex);
+			if (_jobs.empty())
+				break;
+			job = _jobs.front();
+		}
+
+		finishJob(job, job->error != Common::kNoError ? job->error : writeJob(job));
+	}
+}
+
+void AsyncSaveWriter::takeResults(const DefaultSaveFileManager *manager, Common::Array<Result> &results) {
+	Common::StackLock lock(_queueMutex);
+
+	for (uint i = 0; i < _results.size();) {
+		if (_results[i].manager == manager) {
+			results.push_back(_results[i].result);
+			_results.remove_at(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void AsyncSaveWriter::queue(Job *job) {
+	Common::StackLock lock(_queueMutex);
+	_jobs.push_back(job);
+}
+
+void AsyncSaveWriter::compress(uint32 budget) {
+	Common::StackLock lock(_processMutex);
+
+	while (budget > 0) {
+		Job *job = nullptr;
+		{
+			Common::StackLock queueLock(_queueMutex);
+			for (Common::List<Job *>::const_iterator it = _jobs.begin(); it != _jobs.end(); ++it) {
+				if (!(*it)->compressed) {
+					job = *it;
+					break;
+				}
+			}
+		}
+
+		if (!job || !compressJob(job, budget))
+			break;
+	}
+}
+
+bool AsyncSaveWriter::compressJob(Job *job, uint32 &budget) {
+	if (!job->stream) {
+		job->buffer = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		job->stream = DefaultSaveFileManager::wrapCompressedWriteStream(job->buffer, job->compression);
+	}
+
+	const uint32 size = MIN(budget, job->size - job->pos);
+	job->stream->write(job->data + job->pos, size);
+	job->pos += size;
+	budget -= size;
+
+	if (job->pos < job->size)
+		return false;
+
+	job->stream->finalize();
+	if (job->stream->err())
+		job->error = Common::kWritingFailed;
+
+	// The uncompressed data is replaced by the compressed file, whose
+	// buffer is kept when the stream owning it is deleted
+	free(job->data);
+	job->data = job->buffer->getData();
+	job->size = job->buffer->size();
+	delete job->stream;
+	job->stream = nullptr;
+	job->buffer = nullptr;
+
+	Common::StackLock queueLock(_queueMutex);
+	job->compressed = true;
+	return true;
+}
+
+Common::ErrorCode AsyncSaveWriter::writeJob(Job *job) {
+	job->tempNode = Common::FSNode(job->node.getPath().append(".tmp"));
+	Common::ScopedPtr<Common::WriteStream> file(job->tempNode.createWriteStream(false));
+	if (!file)
+		return Common::kCreatingFileFailed;
+
+	file->write(job->data, job->size);
+	file->finalize();
+	const bool failed = file->err();
+	// Close the file before renaming it
+	file.reset();
+
+	if (failed)
+		return Common::kWritingFailed;
+	return job->manager->renameFile(job->tempNode, job->node);
+}
+
+void AsyncSaveWriter::finishJob(Job *job, Common::ErrorCode error) {
+	if (error != Common::kNoError && job->tempNode.exists())
+		job->manager->removeFile(job->tempNode);
+
+	ManagerResult result;
+	result.manager = job->manager;
+	result.result.name = job->node.getName();
+	result.result.error = error;
+
+	{
+		Common::StackLock lock(_queueMutex);
+		_jobs.pop_front();
+		_results.push_back(result);
+	}
+
+	free(job->data);
+	delete job;
+}
+
+void AsyncSaveWriter::timerProc(void *refCon) {
+	static_cast<AsyncSaveWriter *>(refCon)->compress(kChunkSize);
+}
+
+#endif // !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
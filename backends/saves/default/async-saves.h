@@ -0,0 +1,141 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if !defined(BACKEND_SAVES_ASYNC_H) && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+#define BACKEND_SAVES_ASYNC_H
+
+#include "common/array.h"
+#include "common/error.h"
+#include "common/fs.h"
+#include "common/list.h"
+#include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/savefile.h"
+#include "common/singleton.h"
+
+#include "backends/saves/default/default-saves.h"
+
+/**
+ * Compresses save files in the background.
+ *
+ * The data of a save file is buffered in memory until the file is
+ * finalized or deleted. A timer proc then compresses it into memory, a
+ * chunk at a time. The timer thread also drives the music and the sound
+ * chips, so it does no file I/O: the compressed file is written by flush()
+ * on the game thread, to a temporary file which is renamed over the save
+ * file. The save file is replaced atomically, so a failed write leaves the
+ * previous save intact.
+ *
+ * The writer is shared by all save file managers, as the timer manager does
+ * not allow installing the same proc twice.
+ */
+class AsyncSaveWriter : public Common::Singleton<AsyncSaveWriter> {
+public:
+	/** The outcome of writing a save file in the background */
+	struct Result {
+		Common::String name;
+		Common::ErrorCode error;
+	};
+
+	/**
+	 * Create a save file which is written to @p node in the background.
+	 *
+	 * The file is written with the renameFile() and removeFile() of
+	 * @p manager, which must wait for its files with flush() before it is
+	 * deleted.
+	 */
+	Common::OutSaveFile *openForSaving(DefaultSaveFileManager *manager, const Common::FSNode &node, const DefaultSaveFileManager::Compression &compression);
+
+	/** Return whether any save file of @p manager is still to be compressed. */
+	bool hasPendingSaves(const DefaultSaveFileManager *manager) const;
+
+	/** Return whether the save file @p name of @p manager is still to be written. */
+	bool isPending(const DefaultSaveFileManager *manager, const Common::String &name) const;
+
+	/**
+	 * Compress the queued save files which are not compressed yet, and
+	 * write all of them, on the calling thread.
+	 */
+	void flush();
+
+	/**
+	 * Append the results of the save files of @p manager which were written
+	 * since the last call to @p results.
+	 */
+	void takeResults(const DefaultSaveFileManager *manager, Common::Array<Result> &results);
+
+	/**
+	 * Compress up to @p budget bytes of buffered data. This is called from
+	 * the timer proc.
+	 */
+	void compress(uint32 budget);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	friend class AsyncSaveStream;
+	AsyncSaveWriter();
+	~AsyncSaveWriter();
+
+	struct Job {
+		DefaultSaveFileManager *manager;
+		Common::FSNode node;
+		Common::FSNode tempNode;
+		DefaultSaveFileManager::Compression compression;
+
+		byte *data;
+		uint32 size;
+		uint32 pos;
+
+		// Created by the first call to compress() for the job, and deleted
+		// with the buffer it owns once the data is compressed
+		Common::WriteStream *stream;
+		Common::MemoryWriteStreamDynamic *buffer;
+
+		// Set once the data is compressed, after which data and size are
+		// those of the compressed file
+		bool compressed;
+		Common::ErrorCode error;
+	};
+
+	struct ManagerResult {
+		const DefaultSaveFileManager *manager;
+		Result result;
+	};
+
+	void queue(Job *job);
+	bool compressJob(Job *job, uint32 &budget);
+	Common::ErrorCode writeJob(Job *job);
+	void finishJob(Job *job, Common::ErrorCode error);
+
+	static void timerProc(void *refCon);
+
+	// Serializes the compression and the writing of the jobs, which are
+	// only touched while holding it
+	Common::Mutex _processMutex;
+
+	// Guards the queue and the results; may be taken while holding
+	// _processMutex
+	mutable Common::Mutex _queueMutex;
+	Common::List<Job *> _jobs;
+	Common::Array<ManagerResult> _results;
+};
+
+#endif
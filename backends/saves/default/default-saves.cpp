@@ -30,6 +30,7 @@
 #if !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
 
 #include "backends/saves/default/default-saves.h"
+#include "backends/saves/default/async-saves.h"
 
 #include "common/savefile.h"
 #include "common/util.h"
@@ -37,20 +38,27 @@
 #include "common/archive.h"
 #include "common/config-manager.h"
 #include "common/compression/deflate.h"
+#include "common/compression/lz4.h"
 
-#include <errno.h>	// for removeSavefile()
+#include <errno.h>	// for removeFile() and renameFile()
 
 #ifdef USE_CLOUD
 const char *const DefaultSaveFileManager::TIMESTAMPS_FILENAME = "timestamps";
 #endif
 
-DefaultSaveFileManager::DefaultSaveFileManager() {
+DefaultSaveFileManager::DefaultSaveFileManager() : _backgroundSaving(false), _backgroundCompressionLevel(1), _compressionDictionaryId(0) {
 }
 
-DefaultSaveFileManager::DefaultSaveFileManager(const Common::Path &defaultSavepath) {
+DefaultSaveFileManager::DefaultSaveFileManager(const Common::Path &defaultSavepath) : _backgroundSaving(false), _backgroundCompressionLevel(1), _compressionDictionaryId(0) {
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	// Writes the remaining files of all managers
+	if (AsyncSaveWriter::hasInstance())
+		AsyncSaveWriter::destroy();
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -97,6 +105,8 @@ Common::InSaveFile *DefaultSaveFileManager::openRawFile(const Common::String &fi
 	if (getError().getCode() != Common::kNoError)
 		return nullptr;
 
+	waitForPendingSave(filename);
+
 	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
 	if (file == _saveFileCache.end()) {
 		return nullptr;
@@ -120,6 +130,8 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 		}
 	}
 
+	waitForPendingSave(filename);
+
 	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
 	if (file == _saveFileCache.end()) {
 		setError(Common::kPathDoesNotExist, Common::String::format("Savefile '%s' does not exist", filename.c_str()));
@@ -127,6 +139,8 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 	} else {
 		// Open the file for loading.
 		Common::SeekableReadStream *sf = file->_value.createReadStream();
+		if (sf)
+			loadCompressionDictionary(*sf);
 		return Common::wrapCompressedReadStream(sf);
 	}
 }
@@ -163,11 +177,24 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 		fileNode = file->_value;
 	}
 
-	// Open the file for saving.
-	Common::SeekableWriteStream *const sf = fileNode.createWriteStream(false);
-	if (!sf)
-		return nullptr;
-	Common::OutSaveFile *const result = new Common::OutSaveFile(compress ? Common::wrapCompressedWriteStream(sf) : sf);
+	const Compression compression = getCompression(compress, _backgroundSaving ? _backgroundCompressionLevel : -1);
+	if (!compression.dictionary.empty())
+		storeCompressionDictionary();
+
+	Common::OutSaveFile *result;
+	if (_backgroundSaving) {
+		// The file is created once its data has been written
+		result = AsyncSaveWriter::instance().openForSaving(this, fileNode, compression);
+	} else {
+		// An earlier write in the background would overwrite the file
+		waitForPendingSave(filename);
+
+		// Open the file for saving.
+		Common::SeekableWriteStream *const sf = fileNode.createWriteStream(false);
+		if (!sf)
+			return nullptr;
+		result = new Common::OutSaveFile(wrapCompressedWriteStream(sf, compression));
+	}
 
 	// Add file to cache now that it exists.
 	_saveFileCache[filename] = Common::FSNode(fileNode.getPath());
@@ -191,6 +218,8 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 	}
 #endif
 
+	waitForPendingSave(filename);
+
 	// Obtain node if exists.
 	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
 	if (file == _saveFileCache.end()) {
@@ -221,6 +250,148 @@ Common::ErrorCode DefaultSaveFileManager::removeFile(const Common::FSNode &fileN
 	return Common::kUnknownError;
 }
 
+Common::ErrorCode DefaultSaveFileManager::renameFile(const Common::FSNode &fileNode, const Common::FSNode &newNode) {
+	Common::String filepath(fileNode.getPath().toString(Common::Path::kNativeSeparator));
+	Common::String newFilepath(newNode.getPath().toString(Common::Path::kNativeSeparator));
+	if (rename(filepath.c_str(), newFilepath.c_str()) == 0)
+		return Common::kNoError;
+	if (errno == EACCES)
+		return Common::kWritePermissionDenied;
+	if (errno == ENOENT)
+		return Common::kPathDoesNotExist;
+	return Common::kUnknownError;
+}
+
+void DefaultSaveFileManager::setBackgroundSaving(bool enable, int compressionLevel) {
+	_backgroundSaving = enable;
+	_backgroundCompressionLevel = compressionLevel;
+}
+
+bool DefaultSaveFileManager::hasPendingSaves() {
+	return AsyncSaveWriter::hasInstance() && AsyncSaveWriter::instance().hasPendingSaves(this);
+}
+
+bool DefaultSaveFileManager::waitForPendingSaves() {
+	if (!AsyncSaveWriter::hasInstance())
+		return true;
+
+	AsyncSaveWriter &writer = AsyncSaveWriter::instance();
+	writer.flush();
+
+	Common::Array<AsyncSaveWriter::Result> results;
+	writer.takeResults(this, results);
+
+	bool success = true;
+	for (uint i = 0; i < results.size(); i++) {
+		const AsyncSaveWriter::Result &result = results[i];
+		if (result.error == Common::kNoError)
+			continue;
+
+		success = false;
+		Common::Error error(result.error);
+		setError(error, "Failed to write savefile '" + result.name + "': " + error.getDesc());
+		warning("DefaultSaveFileManager: %s", getErrorDesc().c_str());
+
+		// Keep the cache in sync if there was no previous version of the file
+		SaveFileCache::iterator file = _saveFileCache.find(result.name);
+		if (file != _saveFileCache.end() && !Common::FSNode(file->_value.getPath()).exists())
+			_saveFileCache.erase(file);
+	}
+
+#ifdef USE_CLOUD
+	// The files were not there yet when they were closed
+	if (!results.empty())
+		CloudMan.syncSaves();
+#endif
+
+	return success;
+}
+
+void DefaultSaveFileManager::waitForPendingSave(const Common::String &filename) {
+	if (AsyncSaveWriter::hasInstance() && AsyncSaveWriter::instance().isPending(this, filename))
+		AsyncSaveWriter::instance().flush();
+}
+
+void DefaultSaveFileManager::setCompressionDictionary(const byte *data, uint32 size) {
+	if (!data || !size) {
+		_compressionDictionary.clear();
+		_compressionDictionaryId = 0;
+		return;
+	}
+
+	// Loading the files written from now on needs the dictionary
+	_compressionDictionaryId = Common::registerLZ4Dictionary(data, size);
+
+	const uint32 dictSize = MIN<uint32>(size, 64 * 1024);
+	_compressionDictionary.resize(dictSize);
+	memcpy(_compressionDictionary.data(), data + size - dictSize, dictSize);
+}
+
+DefaultSaveFileManager::Compression DefaultSaveFileManager::getCompression(bool compress, int level) const {
+	Compression compression;
+	compression.method = Compression::kNone;
+	compression.level = level;
+
+	if (compress) {
+		if (ConfMan.get("save_compression") == "lz4") {
+			compression.method = Compression::kLZ4;
+			compression.dictionary = _compressionDictionary;
+		} else {
+			compression.method = Compression::kDeflate;
+		}
+	}
+
+	return compression;
+}
+
+Common::WriteStream *DefaultSaveFileManager::wrapCompressedWriteStream(Common::WriteStream *stream, const Compression &compression) {
+	switch (compression.method) {
+	case Compression::kDeflate:
+		return Common::wrapCompressedWriteStream(stream, compression.level);
+	case Compression::kLZ4:
+		return Common::wrapLZ4WriteStream(stream, compression.dictionary.data(), compression.dictionary.size());
+	default:
+		return stream;
+	}
+}
+
+Common::String DefaultSaveFileManager::getDictionaryFilename(uint32 id) {
+	return Common::String::format("scummvm-%08x.lz4dict", id);
+}
+
+void DefaultSaveFileManager::storeCompressionDictionary() {
+	const Common::String filename = getDictionaryFilename(_compressionDictionaryId);
+	if (exists(filename))
+		return;
+
+	// Not compressed, so this does not recurse
+	Common::ScopedPtr<Common::OutSaveFile> file(openForSaving(filename, false));
+	if (!file) {
+		warning("DefaultSaveFileManager: Failed to store the compression dictionary '%s'", filename.c_str());
+		return;
+	}
+
+	file->write(_compressionDictionary.data(), _compressionDictionary.size());
+	file->finalize();
+}
+
+void DefaultSaveFileManager::loadCompressionDictionary(Common::SeekableReadStream &file) {
+	const uint32 id = Common::getLZ4DictionaryId(file);
+	if (!id || Common::hasLZ4Dictionary(id))
+		return;
+
+	// The save file cannot be read without it, which is reported when it is
+	// wrapped
+	Common::ScopedPtr<Common::InSaveFile> dictFile(openRawFile(getDictionaryFilename(id)));
+	if (!dictFile)
+		return;
+
+	Common::Array<byte> data(dictFile->size());
+	if (dictFile->read(data.data(), data.size()) != data.size() ||
+			Common::registerLZ4Dictionary(data.data(), data.size()) != id)
+		warning("DefaultSaveFileManager: Failed to load the compression dictionary '%s'", getDictionaryFilename(id).c_str());
+}
+
 bool DefaultSaveFileManager::exists(const Common::String &filename) {
 	// Assure the savefile name cache is up-to-date.
 	assureCached(getSavePath());
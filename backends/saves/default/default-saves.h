@@ -23,6 +23,7 @@
 #define BACKEND_SAVES_DEFAULT_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/fs.h"
@@ -32,9 +33,12 @@
  * Provides a default savefile manager implementation for common platforms.
  */
 class DefaultSaveFileManager : public Common::SaveFileManager {
+	friend class AsyncSaveWriter;
+
 public:
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::Path &defaultSavepath);
+	~DefaultSaveFileManager() override;
 
 	void updateSavefilesList(Common::StringArray &lockedFiles) override;
 	Common::StringArray listSavefiles(const Common::String &pattern) override;
@@ -44,6 +48,31 @@ public:
 	bool removeSavefile(const Common::String &filename) override;
 	bool exists(const Common::String &filename) override;
 
+	void setBackgroundSaving(bool enable, int compressionLevel = 1) override;
+	bool hasPendingSaves() override;
+	bool waitForPendingSaves() override;
+
+	void setCompressionDictionary(const byte *data, uint32 size) override;
+
+	/** How a save file is compressed. */
+	struct Compression {
+		enum Method {
+			kNone,
+			kDeflate,
+			kLZ4
+		};
+
+		Method method;
+		int level;	///< Level of deflate
+		Common::Array<byte> dictionary;	///< Dictionary of LZ4, if any
+	};
+
+	/**
+	 * Wrap @p stream in a stream compressing the data written to it as
+	 * described by @p compression.
+	 */
+	static Common::WriteStream *wrapCompressedWriteStream(Common::WriteStream *stream, const Compression &compression);
+
 #ifdef USE_CLOUD
 
 	static const uint32 INVALID_TIMESTAMP = UINT_MAX;
@@ -75,6 +104,40 @@ protected:
 	 */
 	virtual Common::ErrorCode removeFile(const Common::FSNode &fileNode);
 
+	/**
+	 * Renames the given file, replacing the target file if it exists.
+	 * This is called with full file paths when a save file compressed in the
+	 * background is moved into place.
+	 */
+	virtual Common::ErrorCode renameFile(const Common::FSNode &fileNode, const Common::FSNode &newNode);
+
+	/**
+	 * Writes the given file if it was saved in the background and is not
+	 * written yet.
+	 */
+	void waitForPendingSave(const Common::String &filename);
+
+	/**
+	 * Get how a save file opened for saving is compressed, depending on the
+	 * "save_compression" setting.
+	 */
+	Compression getCompression(bool compress, int level) const;
+
+	/**
+	 * Store the compression dictionary in the save directory, unless it is
+	 * already there.
+	 */
+	void storeCompressionDictionary();
+
+	/**
+	 * Register the dictionary needed by the LZ4 compressed @p file, if it is
+	 * not registered yet, from the save directory.
+	 */
+	void loadCompressionDictionary(Common::SeekableReadStream &file);
+
+	/** Get the name of the file storing the dictionary @p id. */
+	static Common::String getDictionaryFilename(uint32 id);
+
 	/**
 	 * Assure that the given save path is cached.
 	 *
@@ -104,6 +167,21 @@ private:
 	 * The currently cached directory.
 	 */
 	Common::Path _cachedDirectory;
+
+	/**
+	 * Whether the files opened for saving are written in the background,
+	 * and the compression level used for them.
+	 */
+	bool _backgroundSaving;
+	int _backgroundCompressionLevel;
+
+	/**
+	 * The dictionary of the save files compressed with LZ4, and its id. The
+	 * files written in the background take a copy, so they do not share it
+	 * with the timer thread.
+	 */
+	Common::Array<byte> _compressionDictionary;
+	uint32 _compressionDictionaryId;
 };
 
 #endif
@@ -68,4 +68,21 @@ Common::ErrorCode WindowsSaveFileManager::removeFile(const Common::FSNode &fileN
 	return Common::kUnknownError;
 }
 
+Common::ErrorCode WindowsSaveFileManager::renameFile(const Common::FSNode &fileNode, const Common::FSNode &newNode) {
+	// Unlike rename(), this replaces an existing file
+	TCHAR *tFile = Win32::stringToTchar(fileNode.getPath().toString(Common::Path::kNativeSeparator));
+	TCHAR *tNewFile = Win32::stringToTchar(newNode.getPath().toString(Common::Path::kNativeSeparator));
+	const BOOL result = MoveFileEx(tFile, tNewFile, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+	const DWORD lastError = GetLastError();
+	free(tFile);
+	free(tNewFile);
+	if (result)
+		return Common::kNoError;
+	if (lastError == ERROR_ACCESS_DENIED)
+		return Common::kWritePermissionDenied;
+	if (lastError == ERROR_FILE_NOT_FOUND || lastError == ERROR_PATH_NOT_FOUND)
+		return Common::kPathDoesNotExist;
+	return Common::kUnknownError;
+}
+
 #endif
@@ -33,6 +33,7 @@ public:
 
 protected:
 	Common::ErrorCode removeFile(const Common::FSNode &fileNode) override;
+	Common::ErrorCode renameFile(const Common::FSNode &fileNode, const Common::FSNode &newNode) override;
 };
 
 #endif
@@ -25,79 +25,117 @@
 #include "common/system.h"
 
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
-
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = nullptr;
-
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
-	while (true) {
-		assert(slot);
-		if (slot->next == nullptr || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
-	}
+enum {
+	// Missed calls further behind than this are skipped, in microseconds
+	kMaxCatchUp = 1000 * 1000
+};
+
+static bool isEarlier(const TimerSlot *slot, const TimerSlot *other) {
+	if (slot->deadline != other->deadline)
+		return slot->deadline < other->deadline;
+	return (int32)(slot->order - other->order) < 0;
 }
 
 
 DefaultTimerManager::DefaultTimerManager() :
 	_timerCallbackNext(0),
-	_head(nullptr) {
-
-	_head = new TimerSlot();
+	_lastMillis(0),
+	_micros(0),
+	_nextOrder(0) {
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
+	for (uint i = 0; i < _queue.size(); i++)
+		delete _queue[i];
+	_queue.clear();
+}
+
+uint64 DefaultTimerManager::getMicros(bool skipRecord) {
+	// Extend the milliseconds past their wrap around. The event recorder may
+	// switch to a clock which is behind, which is not counted as elapsed.
+	const uint32 millis = g_system->getMillis(skipRecord);
+	if ((int32)(millis - _lastMillis) > 0)
+		_micros += (uint64)(millis - _lastMillis) * 1000;
+	_lastMillis = millis;
+	return _micros;
+}
+
+void DefaultTimerManager::pushSlot(TimerSlot *slot) {
+	uint pos = _queue.size();
+	_queue.push_back(slot);
+	while (pos > 0) {
+		const uint parent = (pos - 1) / 2;
+		if (!isEarlier(slot, _queue[parent]))
+			break;
+		_queue[pos] = _queue[parent];
+		pos = parent;
 	}
-	_head = nullptr;
+	_queue[pos] = slot;
+}
+
+TimerSlot *DefaultTimerManager::popSlot() {
+	assert(!_queue.empty());
+	TimerSlot *const result = _queue[0];
+	TimerSlot *const last = _queue.back();
+	_queue.pop_back();
+
+	const uint size = _queue.size();
+	if (size) {
+		uint pos = 0;
+		while (true) {
+			uint child = pos * 2 + 1;
+			if (child >= size)
+				break;
+			if (child + 1 < size && isEarlier(_queue[child + 1], _queue[child]))
+				child++;
+			if (!isEarlier(_queue[child], last))
+				break;
+			_queue[pos] = _queue[child];
+			pos = child;
+		}
+		_queue[pos] = last;
+	}
+
+	return result;
+}
+
+void DefaultTimerManager::reschedule(TimerSlot *slot, uint64 curTime) {
+	assert(slot->interval > 0);
+
+	const uint64 lateness = curTime - slot->deadline;
+	slot->calls++;
+	slot->totalLateness += lateness;
+	slot->maxLateness = (uint32)MAX<uint64>(slot->maxLateness, MIN<uint64>(lateness, 0xFFFFFFFF));
+
+	// The deadlines do not depend on when the calls are made, so the calls
+	// do not drift. After a stall, the missed calls are made in a row.
+	slot->deadline += slot->interval;
+	if (slot->deadline + kMaxCatchUp < curTime) {
+		const uint64 missed = (curTime - slot->deadline) / slot->interval + 1;
+		slot->deadline += missed * slot->interval;
+		slot->skipped += (uint32)MIN<uint64>(missed, 0xFFFFFFFF);
+	}
+
+	// Slots due at the same time are called in the order they were queued
+	slot->order = _nextOrder++;
+	pushSlot(slot);
 }
 
 void DefaultTimerManager::handler() {
 	Common::StackLock lock(_mutex);
 
-	uint32 curTime = g_system->getMillis(true);
-
-	// On slow systems this could still be run after destructor
-	if (!_head)
-		return;
+	const uint64 curTime = getMicros(true);
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
-
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
-		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
-		}
-		insertPrioQueue(_head, slot);
+	while (!_queue.empty() && _queue[0]->deadline <= curTime) {
+		TimerSlot *slot = popSlot();
+		reschedule(slot, curTime);
 
 		// Invoke the timer callback
 		assert(slot->callback);
 		slot->callback(slot->refCon);
-
-		// Look at the next scheduled timer
-		slot = _head->next;
 	}
 }
 
@@ -111,6 +149,45 @@ void DefaultTimerManager::checkTimers(uint32 interval) {
 	}
 }
 
+bool DefaultTimerManager::getNextDeadline(uint64 &deadline) {
+	Common::StackLock lock(_mutex);
+
+	if (_queue.empty())
+		return false;
+	deadline = _queue[0]->deadline;
+	return true;
+}
+
+bool DefaultTimerManager::getTimerStats(const Common::String &id, TimerStats &stats) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _queue.size(); i++) {
+		const TimerSlot *slot = _queue[i];
+		if (!slot->id.equalsIgnoreCase(id))
+			continue;
+
+		stats.calls = slot->calls;
+		stats.skipped = slot->skipped;
+		stats.meanLateness = slot->calls ? (uint32)(slot->totalLateness / slot->calls) : 0;
+		stats.maxLateness = slot->maxLateness;
+		return true;
+	}
+
+	return false;
+}
+
+void DefaultTimerManager::resetTimerStats() {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _queue.size(); i++) {
+		TimerSlot *slot = _queue[i];
+		slot->calls = 0;
+		slot->skipped = 0;
+		slot->maxLateness = 0;
+		slot->totalLateness = 0;
+	}
+}
+
 bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, void *refCon, const Common::String &id) {
 	assert(interval > 0);
 	Common::StackLock lock(_mutex);
@@ -133,11 +210,10 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	slot->refCon = refCon;
 	slot->id = id;
 	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = nullptr;
+	slot->deadline = getMicros(false) + interval;
+	slot->order = _nextOrder++;
 
-	insertPrioQueue(_head, slot);
+	pushSlot(slot);
 
 	return true;
 }
@@ -145,16 +221,14 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
-		} else {
-			slot = slot->next;
-		}
+	// Rebuild the queue without the slots of the callback
+	Common::Array<TimerSlot *> slots;
+	slots.swap(_queue);
+	for (uint i = 0; i < slots.size(); i++) {
+		if (slots[i]->callback == callback)
+			delete slots[i];
+		else
+			pushSlot(slots[i]);
 	}
 
 	// We need to remove all names referencing the timer proc here.
@@ -22,6 +22,7 @@
 #ifndef BACKENDS_TIMER_DEFAULT_H
 #define BACKENDS_TIMER_DEFAULT_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
@@ -34,16 +35,27 @@ struct TimerSlot {
 	Common::String id;
 	uint32 interval;	// in microseconds
 
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
+	uint64 deadline;	// in microseconds, see DefaultTimerManager::getMicros()
+	uint32 order;	// orders the slots due at the same time by when they were queued
 
-	TimerSlot *next;
+	// Jitter statistics
+	uint32 calls;
+	uint32 skipped;
+	uint32 maxLateness;	// in microseconds
+	uint64 totalLateness;	// in microseconds
 
-	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), nextFireTime(0), nextFireTimeMicro(0), next(nullptr) {}
+	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), deadline(0), order(0),
+		calls(0), skipped(0), maxLateness(0), totalLateness(0) {}
 };
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot);
-
+/**
+ * Calls the timer procs at their deadlines, which are absolute so the calls
+ * do not drift, whenever handler() is invoked by the backend.
+ *
+ * When the handler is invoked late, the missed calls are made at once to
+ * catch up, unless the timer procs are so far behind (e.g. after the system
+ * was suspended) that the missed calls are skipped instead.
+ */
 class DefaultTimerManager : public Common::TimerManager {
 private:
 	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
@@ -52,11 +64,50 @@ private:
 
 	uint32 _timerCallbackNext;
 
+	// Clock of getMicros()
+	uint32 _lastMillis;
+	uint64 _micros;
+
+	uint32 _nextOrder;
+
 protected:
 	Common::Mutex _mutex;
-	TimerSlot *_head;
+
+	/**
+	 * The installed timer procs, as a binary heap ordered by their
+	 * deadlines. Use pushSlot() and popSlot() to modify it.
+	 */
+	Common::Array<TimerSlot *> _queue;
+
+	/**
+	 * Return the time the deadlines are measured in, in microseconds.
+	 *
+	 * The default implementation uses OSystem::getMillis(), which the event
+	 * recorder replays, so it only has a resolution of a millisecond.
+	 */
+	virtual uint64 getMicros(bool skipRecord);
+
+	/** Add @p slot, whose order is set, to the queue. */
+	void pushSlot(TimerSlot *slot);
+
+	/** Remove the slot with the earliest deadline from the queue. */
+	TimerSlot *popSlot();
+
+	/**
+	 * Record the jitter of the call of @p slot which is about to be made at
+	 * @p curTime, move its deadline to the next call and queue it again.
+	 */
+	void reschedule(TimerSlot *slot, uint64 curTime);
 
 public:
+	/** Timing of the calls of a timer proc. */
+	struct TimerStats {
+		uint32 calls;	///< Number of calls made
+		uint32 skipped;	///< Number of calls skipped to catch up
+		uint32 meanLateness;	///< Mean delay of a call after its deadline, in microseconds
+		uint32 maxLateness;	///< Largest delay of a call after its deadline, in microseconds
+	};
+
 	DefaultTimerManager();
 	virtual ~DefaultTimerManager();
 	bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) override;
@@ -64,6 +115,7 @@ public:
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
+	 * It calls the timer procs whose deadline has passed.
 	 */
 	virtual void handler();
 
@@ -72,6 +124,23 @@ public:
 	 * Should be called from pollEvents() on backends without threads.
 	 */
 	void checkTimers(uint32 interval = 10);
+
+	/**
+	 * Get the deadline of the next timer proc, in the time of getMicros(),
+	 * so a backend can invoke handler() just in time. Return false if no
+	 * timer proc is installed.
+	 */
+	bool getNextDeadline(uint64 &deadline);
+
+	/**
+	 * Get the timing of the calls of the timer proc @p id since it was
+	 * installed or since resetTimerStats(). Return false if there is no such
+	 * timer proc.
+	 */
+	bool getTimerStats(const Common::String &id, TimerStats &stats);
+
+	/** Reset the timing statistics of all the timer procs. */
+	void resetTimerStats();
 };
 
 #endif
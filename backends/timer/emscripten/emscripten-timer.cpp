@@ -33,12 +33,13 @@ EmscriptenTimerManager::~EmscriptenTimerManager() {
 void EmscriptenTimerManager::handler() {
 	Common::StackLock lock(_mutex);
 
-	uint32 curTime = g_system->getMillis(true);
-	TimerSlot *slot = _head->next;
-	TimerSlot *prev = _head;
+	const uint64 curTime = getMicros(true);
+	Common::Array<TimerSlot *> skippedSlots;
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	while (slot && slot->nextFireTime < curTime) {
+	while (!_queue.empty() && _queue[0]->deadline <= curTime) {
+		TimerSlot *slot = popSlot();
+
 		// avoid a recursion loop if a timer callback decides to call OSystem::delayMillis()
 		// timers should not be triggering timers, but many timers trigger I/O - which in case
 		// of virtual FS will trigger delayMillis for the network timer to keep running.
@@ -46,18 +47,9 @@ void EmscriptenTimerManager::handler() {
 		static bool inTimer = false;
 		bool isConnManTimer = (slot->id == "Networking::ConnectionManager's Timer");
 		if (!inTimer || isConnManTimer) {
-			// Remove the slot from the priority queue
-			prev->next = slot->next;
-			// Update the fire time and reinsert the TimerSlot into the priority
+			// Update the deadline and reinsert the TimerSlot into the priority
 			// queue.
-			assert(slot->interval > 0);
-			slot->nextFireTime += (slot->interval / 1000);
-			slot->nextFireTimeMicro += (slot->interval % 1000);
-			if (slot->nextFireTimeMicro > 1000) {
-				slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-				slot->nextFireTimeMicro %= 1000;
-			}
-			insertPrioQueue(_head, slot);
+			reschedule(slot, curTime);
 
 			// Invoke the timer callback
 			assert(slot->callback);
@@ -68,8 +60,10 @@ void EmscriptenTimerManager::handler() {
 				inTimer = false;
 		} else {
 			// Skip to the next timer, leaving this one in place to be checked again later
-			prev = slot;
+			skippedSlots.push_back(slot);
 		}
-		slot = prev->next;
 	}
+
+	for (uint i = 0; i < skippedSlots.size(); i++)
+		pushSlot(skippedSlots[i]);
 }
@@ -27,26 +27,141 @@
 #include "backends/timer/sdl/sdl-timer.h"
 
 #include "common/textconsole.h"
+#include "common/util.h"
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+
+enum {
+	// The thread sleeps to the millisecond, and may wake up late by a bit,
+	// so it spends this long before a deadline in SDL_DelayPrecise(), or
+	// yielding where SDL 2 lacks it, in microseconds
+	kSpinTime = 200,
+
+	// The longest time the thread sleeps at once, in milliseconds
+	kMaxWait = 100
+};
+
+SdlTimerManager::SdlTimerManager() : _quit(false) {
+#if !SDL_VERSION_ATLEAST(3, 0, 0)
+	// Initializes the SDL timer subsystem
+	if (SDL_InitSubSystem(SDL_INIT_TIMER) == -1) {
+		error("Could not initialize SDL: %s", SDL_GetError());
+	}
+
+	_counterStart = SDL_GetPerformanceCounter();
+	_counterFrequency = SDL_GetPerformanceFrequency();
+#endif
+
+	_semaphore = SDL_CreateSemaphore(0);
+	_thread = SDL_CreateThread(threadProc, "ScummVM timer", this);
+	if (!_semaphore || !_thread) {
+		error("Could not create the timer thread: %s", SDL_GetError());
+	}
+}
+
+SdlTimerManager::~SdlTimerManager() {
+	{
+		Common::StackLock lock(_mutex);
+		_quit = true;
+	}
+
+	wakeUpThread();
+	SDL_WaitThread(_thread, nullptr);
+	SDL_DestroySemaphore(_semaphore);
+
+#if !SDL_VERSION_ATLEAST(3, 0, 0)
+	SDL_QuitSubSystem(SDL_INIT_TIMER);
+#endif
+}
+
+bool SdlTimerManager::installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) {
+	const bool result = DefaultTimerManager::installTimerProc(proc, interval, refCon, id);
+
+	// The thread may be sleeping past the first deadline of the new proc
+	wakeUpThread();
+	return result;
+}
+
+uint64 SdlTimerManager::getMicros(bool skipRecord) {
 #if SDL_VERSION_ATLEAST(3, 0, 0)
-static Uint32 timer_handler(void *userdata, SDL_TimerID timerID, Uint32 interval) {
-	((DefaultTimerManager *)userdata)->handler();
-	return interval;
+	return SDL_GetTicksNS() / 1000;
+#else
+	// Split the conversion, as multiplying the ticks would overflow
+	const Uint64 ticks = SDL_GetPerformanceCounter() - _counterStart;
+	return ticks / _counterFrequency * 1000000 + ticks % _counterFrequency * 1000000 / _counterFrequency;
+#endif
+}
+
+int SDLCALL SdlTimerManager::threadProc(void *data) {
+	((SdlTimerManager *)data)->run();
+	return 0;
+}
+
+void SdlTimerManager::run() {
+	// The thread keeps the normal priority. Raising it would let the final
+	// stretch before each deadline starve the game and audio threads on
+	// single core systems.
+	while (true) {
+		handler();
+
+		{
+			Common::StackLock lock(_mutex);
+			if (_quit)
+				break;
+		}
+
+		uint64 deadline;
+		if (!getNextDeadline(deadline))
+			deadline = getMicros(true) + kMaxWait * 1000;
+		waitUntil(deadline);
+	}
+}
+
+void SdlTimerManager::waitUntil(uint64 deadline) {
+	uint64 curTime = getMicros(true);
+	if (deadline > curTime + kSpinTime) {
+		const uint64 wait = (deadline - curTime - kSpinTime) / 1000;
+		if (wait > 0) {
+#if SDL_VERSION_ATLEAST(3, 0, 0)
+			const bool wokenUp = SDL_WaitSemaphoreTimeout(_semaphore, (Sint32)MIN<uint64>(wait, kMaxWait));
+#else
+			const bool wokenUp = SDL_SemWaitTimeout(_semaphore, (Uint32)MIN<uint64>(wait, kMaxWait)) == 0;
+#endif
+			if (wokenUp || wait > kMaxWait)
+				return;
+		}
+	}
+
+#if SDL_VERSION_ATLEAST(3, 0, 0)
+	curTime = getMicros(true);
+	if (deadline > curTime)
+		SDL_DelayPrecise((deadline - curTime) * 1000);
+#else
+	while (getMicros(true) < deadline)
+		SDL_Delay(0);
+#endif
+}
+
+void SdlTimerManager::wakeUpThread() {
+#if SDL_VERSION_ATLEAST(3, 0, 0)
+	SDL_SignalSemaphore(_semaphore);
+#else
+	SDL_SemPost(_semaphore);
+#endif
 }
+
 #else
+
 static Uint32 timer_handler(Uint32 interval, void *param) {
 	((DefaultTimerManager *)param)->handler();
 	return interval;
 }
-#endif
 
 SdlTimerManager::SdlTimerManager() {
-#if !SDL_VERSION_ATLEAST(3, 0, 0)
 	// Initializes the SDL timer subsystem
 	if (SDL_InitSubSystem(SDL_INIT_TIMER) == -1) {
 		error("Could not initialize SDL: %s", SDL_GetError());
 	}
-#endif
 
 	// Creates the timer callback
 	_timerID = SDL_AddTimer(10, &timer_handler, this);
@@ -56,9 +171,9 @@ SdlTimerManager::~SdlTimerManager() {
 	// Removes the timer callback
 	SDL_RemoveTimer(_timerID);
 
-#if !SDL_VERSION_ATLEAST(3, 0, 0)
 	SDL_QuitSubSystem(SDL_INIT_TIMER);
-#endif
 }
 
 #endif
+
+#endif
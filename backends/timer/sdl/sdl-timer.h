@@ -27,16 +27,47 @@
 #include "backends/platform/sdl/sdl-sys.h"
 
 /**
- * SDL timer manager. Setups the timer callback for
- * DefaultTimerManager.
+ * SDL timer manager. Invokes the handler of DefaultTimerManager from a
+ * dedicated thread at the deadline of the next timer proc, measured with
+ * the high resolution clock of SDL.
  */
 class SdlTimerManager : public DefaultTimerManager {
 public:
 	SdlTimerManager();
 	virtual ~SdlTimerManager();
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) override;
+
+protected:
+	uint64 getMicros(bool skipRecord) override;
+
+private:
+	static int SDLCALL threadProc(void *data);
+	void run();
+
+	/**
+	 * Wait until @p deadline, or until a timer proc is installed. This may
+	 * return early when the deadline is far.
+	 */
+	void waitUntil(uint64 deadline);
+
+	/** Make the thread look at the queue again. */
+	void wakeUpThread();
+
+	SDL_Thread *_thread;
+#if SDL_VERSION_ATLEAST(3, 0, 0)
+	SDL_Semaphore *_semaphore;
+#else
+	SDL_sem *_semaphore;
+	Uint64 _counterStart;
+	Uint64 _counterFrequency;
+#endif
+	bool _quit;
+#else
 protected:
 	SDL_TimerID _timerID;
+#endif
 };
 
 
@@ -177,6 +177,9 @@ static const char HELP_STRING4[] =
 	"  --native-mt32            True Roland MT-32 (disable GM emulation)\n"
 	"  --dump-midi              Dumps MIDI events to 'dump.mid', until quitting from game\n"
 	"                           (if file already exists, it will be overwritten)\n"
+	"  --dump-chips             Dumps OPL (AdLib) and CMS chip traffic to 'dump.oplc' and\n"
+	"                           'dump.cmsc', until quitting from game\n"
+	"                           (if files already exist, they will be overwritten)\n"
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-channels=CHANNELS Select output channel count (e.g. 2 for stereo)\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
@@ -210,8 +213,14 @@ static const char HELP_STRING4[] =
 	"                           atari, macintosh, macintoshbw, vgaGray)\n"
 #ifdef ENABLE_EVENTRECORDER
 	"  --record-mode=MODE       Specify record mode for event recorder (record, playback,\n"
-	"                           fast_playback, info, update, passthrough [default])\n"
+	"                           fast_playback, benchmark, info, update, passthrough [default])\n"
 	"  --record-file-name=FILE  Specify record file name\n"
+	"  --record-audio-file=FILE When playing back, render the audio to a WAV file from\n"
+	"                           the recorded time, and log the time spent mixing it\n"
+	"  --record-report-file=FILE\n"
+	"                           When playing back, write a JSON report of the time spent\n"
+	"                           on each frame and of the memory used to FILE (benchmark\n"
+	"                           defaults to the record file name with .json appended)\n"
 	"  --disable-display        Disable any gfx output. Used for headless events\n"
 	"                           playback by Event Recorder\n"
 	"  --screenshot-period=NUM  When recording, trigger a screenshot every NUM milliseconds\n"
@@ -333,8 +342,11 @@ void registerDefaults() {
 	ConfMan.registerDefault("multi_midi", false);
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("dump_midi", false);
+	ConfMan.registerDefault("dump_chips", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("audio_render_ahead", 0);
+	ConfMan.registerDefault("video_decode_ahead", false);
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
@@ -357,6 +369,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("subtitles", false);
 	ConfMan.registerDefault("boot_param", 0);
 	ConfMan.registerDefault("dump_scripts", false);
+	ConfMan.registerDefault("save_compression", "gzip");
 	ConfMan.registerDefault("save_slot", -1);
 	ConfMan.registerDefault("autosave_period", 5 * 60); // By default, trigger autosave every 5 minutes
 	ConfMan.registerDefault("engine_speed", 60); // FPS limit for 3D games
@@ -830,6 +843,12 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("record-file-name")
 			END_OPTION
 
+			DO_LONG_OPTION("record-audio-file")
+			END_OPTION
+
+			DO_LONG_OPTION("record-report-file")
+			END_OPTION
+
 			DO_LONG_COMMAND("list-records")
 			END_COMMAND
 
@@ -927,6 +946,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_BOOL("dump-midi")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("dump-chips")
+			END_OPTION
+
 			DO_LONG_OPTION_BOOL("enable-gs")
 			END_OPTION
 
@@ -1096,6 +1118,7 @@ static void listGames(const Common::String &engineID, bool jsonOutput) {
 			"------------------------------ -----------------------------------------------------------\n");
 	}
 
+	PluginMan.loadDeferredPlugins();
 	const PluginList &plugins = EngineMan.getPlugins(PLUGIN_TYPE_ENGINE);
 	for (const auto &plugin : plugins) {
 		const Plugin *p = EngineMan.findDetectionPlugin(plugin->getName());
@@ -1162,6 +1185,7 @@ static void listEngines(bool jsonOutput) {
 			"--------------- ------------------------------------------------------\n");
 	}
 
+	PluginMan.loadDeferredPlugins();
 	const PluginList &plugins = EngineMan.getPlugins(PLUGIN_TYPE_ENGINE);
 	bool first = true;
 	for (const auto &plugin : plugins) {
@@ -550,6 +550,9 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		ConfMan.registerDefault("dump_midi", true);
 	}
 
+	if (settings.contains("dump-chips"))
+		ConfMan.registerDefault("dump_chips", true);
+
 #ifdef USE_OPENGL
 	if (settings.contains("last_window_width")) {
 		ConfMan.setInt("last_window_width", atoi(settings["last_window_width"].c_str()), Common::ConfigManager::kApplicationDomain);
@@ -598,7 +601,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		ConfMan.set("gfx_mode", gfxModeSetting, Common::ConfigManager::kSessionDomain);
 	}
 #ifdef ENABLE_EVENTRECORDER
-	if (settings.contains("disable-display")) {
+	if (settings.contains("disable-display") || ConfMan.get("record_mode") == "benchmark") {
 		ConfMan.setInt("disable_display", 1, Common::ConfigManager::kTransientDomain);
 	}
 #endif
@@ -809,6 +812,12 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 			} else if (recordMode == "fast_playback") {
 				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderPlayback);
 				g_eventRec.setFastPlayback(true);
+			} else if (recordMode == "benchmark") {
+				// Headless fast playback, profiling every frame
+				if (!ConfMan.hasKey("record_report_file"))
+					ConfMan.set("record_report_file", recordFileName + ".json", Common::ConfigManager::kTransientDomain);
+				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderPlayback);
+				g_eventRec.setFastPlayback(true);
 			} else if ((recordMode == "info") && (!recordFileName.empty())) {
 				Common::PlaybackFile record;
 				record.openRead(recordFileName);
@@ -25,11 +25,16 @@
 #include "common/debug.h"
 #include "common/debug-channels.h"
 #include "common/config-manager.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/formats/ini-file.h"
 
 #ifdef DYNAMIC_MODULES
 #include "common/fs.h"
 #endif
 
+#include "base/version.h"
 #include "base/detection/detection.h"
 
 #include "engines/advancedDetector.h"
@@ -262,6 +267,129 @@ void FilePluginProvider::addCustomDirectories(Common::FSList &dirs) const {
 
 #pragma mark -
 
+Common::FSNode PluginManifest::getManifestNode() {
+	Common::Path configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return Common::FSNode(configFile.getParent().appendComponent("plugins.manifest"));
+}
+
+int64 PluginManifest::getFileSize(const Common::Path &filename) {
+	// The file systems do not report modification times, but a rebuilt
+	// plugin hardly ever keeps its size
+	Common::ScopedPtr<Common::SeekableReadStream> file(Common::FSNode(filename).createReadStream());
+	return file ? file->size() : -1;
+}
+
+void PluginManifest::load() {
+	if (_loaded)
+		return;
+	_loaded = true;
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream(getManifestNode().createReadStream());
+	if (!stream)
+		return;
+
+	Common::INIFile manifest;
+	Common::String version, engineVersion;
+	if (!manifest.loadFromStream(*stream) ||
+	    !manifest.getKey("version", "manifest", version) || version != gScummVMFullVersion ||
+	    !manifest.getKey("engine_version", "manifest", engineVersion) || engineVersion.asUint64() != PLUGIN_TYPE_ENGINE_VERSION) {
+		debug(1, "Discarding the plugin manifest of another ScummVM build");
+		_dirty = true;
+		return;
+	}
+
+	for (const auto &section : manifest.getSections()) {
+		const Common::INIFile::KeyValue *file = section.getKey("file");
+		const Common::INIFile::KeyValue *engine = section.getKey("engine");
+		const Common::INIFile::KeyValue *size = section.getKey("size");
+		if (!file || !engine || !size)
+			continue;
+
+		Entry &entry = _entries[Common::Path::fromConfig(file->value)];
+		entry.engineId = engine->value;
+		entry.size = size->value.asUint64();
+	}
+
+	debug(1, "Read %u plugins from the plugin manifest", _entries.size());
+}
+
+void PluginManifest::save() {
+	if (!_dirty)
+		return;
+
+	Common::INIFile manifest;
+	manifest.setKey("version", "manifest", gScummVMFullVersion);
+	manifest.setKey("engine_version", "manifest", Common::String::format("%d", PLUGIN_TYPE_ENGINE_VERSION));
+
+	uint index = 0;
+	for (const auto &entry : _entries) {
+		const Common::String section = Common::String::format("plugin%u", ++index);
+		manifest.setKey("file", section, entry._key.toConfig());
+		manifest.setKey("engine", section, entry._value.engineId);
+		manifest.setKey("size", section, Common::String::format("%lld", (long long)entry._value.size));
+	}
+
+	Common::ScopedPtr<Common::SeekableWriteStream> stream(getManifestNode().createWriteStream());
+	if (!stream || !manifest.saveToStream(*stream)) {
+		debug(1, "Couldn't write the plugin manifest");
+		return;
+	}
+	stream->finalize();
+
+	_dirty = false;
+}
+
+bool PluginManifest::isValid(EntryMap::iterator entry) {
+	if (getFileSize(entry->_key) == entry->_value.size)
+		return true;
+
+	debug(1, "Plugin '%s' has changed since it was added to the manifest", entry->_key.toString().c_str());
+	_entries.erase(entry);
+	_dirty = true;
+	return false;
+}
+
+Common::String PluginManifest::findEngine(const Common::Path &filename) {
+	EntryMap::iterator entry = _entries.find(filename);
+	if (entry == _entries.end() || !isValid(entry))
+		return Common::String();
+
+	return entry->_value.engineId;
+}
+
+Common::Path PluginManifest::findFile(const Common::String &engineId) {
+	// Invalid entries are removed, so look again after finding one
+	while (true) {
+		EntryMap::iterator entry = _entries.begin();
+		while (entry != _entries.end() && entry->_value.engineId != engineId)
+			++entry;
+
+		if (entry == _entries.end())
+			return Common::Path();
+		if (isValid(entry))
+			return entry->_key;
+	}
+}
+
+void PluginManifest::add(const Common::String &engineId, const Common::Path &filename) {
+	const int64 size = getFileSize(filename);
+	if (size < 0)
+		return;
+
+	Entry &entry = _entries[filename];
+	if (entry.engineId == engineId && entry.size == size)
+		return;
+
+	entry.engineId = engineId;
+	entry.size = size;
+	_dirty = true;
+}
+
+#pragma mark -
+
 PluginManager *PluginManager::_instance = nullptr;
 
 PluginManager &PluginManager::instance() {
@@ -285,6 +413,12 @@ PluginManager::~PluginManager() {
 	// Explicitly unload all loaded plugins
 	unloadAllPlugins();
 
+#ifdef DYNAMIC_MODULES
+	for (auto &deferredPlugin : _deferredPlugins) {
+		delete deferredPlugin._value;
+	}
+#endif
+
 	// Delete the plugin providers
 	for (auto *pluginProvider : _providers) {
 		delete pluginProvider;
@@ -314,6 +448,7 @@ PluginManagerUncached::~PluginManagerUncached() {
  **/
 void PluginManagerUncached::init() {
 	ConfMan.setBool("always_run_fallback_detection_extern", false);
+	_manifest.load();
 
 	unloadPluginsExcept(PLUGIN_TYPE_ENGINE, nullptr, false); // empty the engine plugins
 
@@ -366,10 +501,14 @@ Common::String detectPluginName = "detection";
 }
 
 /**
- * Try to load the plugin by searching in the ConfigManager for a matching
- * engine ID under the domain 'engine_plugin_files'.
+ * Try to load the plugin by searching in the manifest for a matching
+ * engine ID, or in the ConfigManager under the domain 'engine_plugin_files'
+ * where older versions recorded the plugin files.
  **/
 bool PluginManagerUncached::loadPluginFromEngineId(const Common::String &engineId) {
+	if (loadPluginByFileName(_manifest.findFile(engineId)))
+		return true;
+
 	Common::ConfigManager::Domain *domain = ConfMan.getDomain("engine_plugin_files");
 
 	if (domain) {
@@ -418,20 +557,14 @@ bool PluginManagerUncached::loadPluginByFileName(const Common::Path &filename) {
 }
 
 /**
- * Update the config manager with a plugin file name that we found can handle
+ * Update the manifest with a plugin file name that we found can handle
  * the engine.
  **/
-void PluginManagerUncached::updateConfigWithFileName(const Common::String &engineId) {
+void PluginManagerUncached::updateManifest(const Common::String &engineId) {
 	// Check if we have a filename for the current plugin
 	if (!(*_currentPlugin)->getFileName().empty()) {
-		if (!ConfMan.hasMiscDomain("engine_plugin_files"))
-			ConfMan.addMiscDomain("engine_plugin_files");
-
-		Common::ConfigManager::Domain *domain = ConfMan.getDomain("engine_plugin_files");
-		assert(domain);
-		(*domain).setVal(engineId, (*_currentPlugin)->getFileName().toConfig());
-
-		ConfMan.flushToDisk();
+		_manifest.add(engineId, (*_currentPlugin)->getFileName());
+		_manifest.save();
 	}
 }
 
@@ -507,13 +640,35 @@ bool PluginManagerUncached::loadNextPlugin() {
 /**
  * Used by only the cached plugin manager. The uncached manager can only have
  * one plugin in memory at a time.
+ *
+ * The engine plugins listed in the manifest are only loaded when their
+ * engine is needed.
  **/
 void PluginManager::loadAllPlugins() {
+#ifdef DYNAMIC_MODULES
+	_manifest.load();
+#endif
+
 	for (auto &pluginProvider : _providers) {
 		PluginList pl(pluginProvider->getPlugins());
-		Common::for_each(pl.begin(), pl.end(), Common::bind1st(Common::mem_fun(&PluginManager::tryLoadPlugin), this));
+		for (auto *plugin : pl) {
+#ifdef DYNAMIC_MODULES
+			if (pluginProvider->isFilePluginProvider() && deferPlugin(plugin))
+				continue;
+#endif
+			if (!tryLoadPlugin(plugin))
+				continue;
+#ifdef DYNAMIC_MODULES
+			if (pluginProvider->isFilePluginProvider())
+				addToManifest(plugin);
+#endif
+		}
 	}
 
+#ifdef DYNAMIC_MODULES
+	_manifest.save();
+#endif
+
 #ifndef DETECTION_STATIC
 	/*
 	 * When detection is dynamic, loading above only gets us a PLUGIN_TYPE_DETECTION plugin
@@ -533,9 +688,17 @@ void PluginManager::loadAllPluginsOfType(PluginType type) {
 	for (auto &pluginProvider : _providers) {
 		PluginList pluginList(pluginProvider->getPlugins());
 		for (auto *plugin : pluginList) {
+#ifdef DYNAMIC_MODULES
+			if (type == PLUGIN_TYPE_ENGINE && pluginProvider->isFilePluginProvider() && deferPlugin(plugin))
+				continue;
+#endif
 			if (plugin->loadPlugin()) {
 				if (plugin->getType() == type) {
 					addToPluginsInMemList(plugin);
+#ifdef DYNAMIC_MODULES
+					if (pluginProvider->isFilePluginProvider())
+						addToManifest(plugin);
+#endif
 				} else {
 					// Plugin is wrong type
 					plugin->unloadPlugin();
@@ -547,8 +710,79 @@ void PluginManager::loadAllPluginsOfType(PluginType type) {
 			}
 		}
 	}
+
+#ifdef DYNAMIC_MODULES
+	_manifest.save();
+#endif
 }
 
+/**
+ * Load the engine plugins which the cached plugin manager has not loaded
+ * yet, for listing all the engines.
+ **/
+void PluginManager::loadDeferredPlugins() {
+#ifdef DYNAMIC_MODULES
+	for (auto &deferredPlugin : _deferredPlugins) {
+		Plugin *plugin = deferredPlugin._value;
+		if (tryLoadPlugin(plugin))
+			addToManifest(plugin);
+	}
+	_deferredPlugins.clear();
+
+	_manifest.save();
+#endif
+}
+
+/**
+ * Load the engine plugin which the manifest lists for the engine, if the
+ * cached plugin manager has deferred loading it.
+ **/
+bool PluginManager::loadPluginFromEngineId(const Common::String &engineId) {
+#ifdef DYNAMIC_MODULES
+	PluginMap::iterator deferredPlugin = _deferredPlugins.find(engineId);
+	if (deferredPlugin == _deferredPlugins.end())
+		return false;
+
+	Plugin *plugin = deferredPlugin->_value;
+	_deferredPlugins.erase(deferredPlugin);
+	if (tryLoadPlugin(plugin)) {
+		addToManifest(plugin);
+		if (findLoadedPlugin(engineId))
+			return true;
+	}
+
+	// The plugin file has changed without the manifest noticing, so look
+	// for the engine in all of them
+	loadDeferredPlugins();
+	return findLoadedPlugin(engineId) != nullptr;
+#else
+	return false;
+#endif
+}
+
+#ifdef DYNAMIC_MODULES
+/**
+ * Keep an engine plugin listed in the manifest aside, to load it when its
+ * engine is needed.
+ **/
+bool PluginManager::deferPlugin(Plugin *plugin) {
+	const Common::String engineId = _manifest.findEngine(plugin->getFileName());
+	if (engineId.empty())
+		return false;
+
+	// Like with loaded plugins, a duplicated engine replaces the old one
+	Plugin *&deferredPlugin = _deferredPlugins[engineId];
+	delete deferredPlugin;
+	deferredPlugin = plugin;
+	return true;
+}
+
+void PluginManager::addToManifest(const Plugin *plugin) {
+	if (plugin->getType() == PLUGIN_TYPE_ENGINE)
+		_manifest.add(plugin->getName(), plugin->getFileName());
+}
+#endif
+
 void PluginManager::unloadAllPlugins() {
 	for (int i = 0; i < PLUGIN_TYPE_MAX; i++)
 		unloadPluginsExcept((PluginType)i, nullptr);
@@ -704,8 +938,10 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist, uint32
 		}
 	}
 
-	// Close all archives that were opened during detection
+	// Close all archives that were opened during detection, and drop the
+	// directory listings shared between the engines
 	ADCacheMan.clearArchives();
+	ADCacheMan.clearDirectories();
 
 	return DetectionResults(candidates);
 }
@@ -803,8 +1039,10 @@ const Plugin *PluginManager::findEnginePlugin(const Common::String &engineId) {
 	// by plugin
 	if (loadPluginFromEngineId(engineId))  {
 		plugin = findLoadedPlugin(engineId);
-		if (plugin)
+		if (plugin) {
+			PluginMan.updateManifest(engineId);
 			return plugin;
+		}
 	}
 
 	// We failed to find it using the engine ID. Scan the list of plugins
@@ -813,7 +1051,7 @@ const Plugin *PluginManager::findEnginePlugin(const Common::String &engineId) {
 		plugin = findLoadedPlugin(engineId);
 		if (plugin) {
 			// Update with new plugin file name
-			PluginMan.updateConfigWithFileName(engineId);
+			PluginMan.updateManifest(engineId);
 			return plugin;
 		}
 	} while (PluginMan.loadNextPlugin());
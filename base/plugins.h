@@ -24,6 +24,8 @@
 
 #include "common/array.h"
 #include "common/fs.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/str.h"
 #include "backends/plugins/elf/version.h"
 
@@ -289,6 +291,64 @@ protected:
 
 #endif // DYNAMIC_MODULES
 
+/**
+ * Record of the engines provided by the engine plugin files, stored next to
+ * the configuration file. It allows finding the plugin of an engine without
+ * loading every plugin to ask it.
+ *
+ * An entry is only used while the size of its file is unchanged, and the
+ * whole manifest is discarded when ScummVM is rebuilt.
+ */
+class PluginManifest {
+public:
+	PluginManifest() : _loaded(false), _dirty(false) {}
+
+	/**
+	 * Read the manifest from disk, unless it has already been read.
+	 */
+	void load();
+
+	/**
+	 * Write the manifest to disk if it has changed since it was read.
+	 */
+	void save();
+
+	/**
+	 * Return the ID of the engine provided by a plugin file, or an empty
+	 * string if the file is unknown or has changed.
+	 */
+	Common::String findEngine(const Common::Path &filename);
+
+	/**
+	 * Return a plugin file which provides an engine, or an empty path if
+	 * none is known.
+	 */
+	Common::Path findFile(const Common::String &engineId);
+
+	/**
+	 * Record that a plugin file provides an engine.
+	 */
+	void add(const Common::String &engineId, const Common::Path &filename);
+
+private:
+	struct Entry {
+		Common::String engineId;
+		int64 size;
+
+		Entry() : size(-1) {}
+	};
+
+	typedef Common::HashMap<Common::Path, Entry, Common::Path::Hash, Common::Path::EqualTo> EntryMap;
+
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+
+	static Common::FSNode getManifestNode();
+	static int64 getFileSize(const Common::Path &filename);
+	bool isValid(EntryMap::iterator entry);
+};
+
 #define PluginMan PluginManager::instance()
 
 /**
@@ -310,6 +370,17 @@ protected:
 	PluginManager();
 
 	void unloadAllPlugins();
+
+	PluginManifest _manifest;
+
+#ifdef DYNAMIC_MODULES
+	typedef Common::HashMap<Common::String, Plugin *> PluginMap;
+
+	PluginMap _deferredPlugins; // Engine plugins known from the manifest, not loaded yet
+
+	bool deferPlugin(Plugin *plugin);
+	void addToManifest(const Plugin *plugin);
+#endif
 public:
 	virtual ~PluginManager();
 
@@ -331,14 +402,15 @@ public:
 	virtual void init()	{}
 	virtual void loadFirstPlugin() {}
 	virtual bool loadNextPlugin() { return false; }
-	virtual bool loadPluginFromEngineId(const Common::String &engineId) { return false; }
-	virtual void updateConfigWithFileName(const Common::String &engineId) {}
+	virtual bool loadPluginFromEngineId(const Common::String &engineId);
+	virtual void updateManifest(const Common::String &engineId) {}
 	virtual void loadDetectionPlugin() {}
 	virtual void unloadDetectionPlugin() {}
 
 	// Functions used only by the cached PluginManager
 	virtual void loadAllPlugins();
 	virtual void loadAllPluginsOfType(PluginType type);
+	void loadDeferredPlugins();
 
 	void unloadPluginsExcept(PluginType type, const Plugin *plugin, bool deletePlugin = true);
 
@@ -367,7 +439,7 @@ public:
 	void loadFirstPlugin() override;
 	bool loadNextPlugin() override;
 	bool loadPluginFromEngineId(const Common::String &engineId) override;
-	void updateConfigWithFileName(const Common::String &engineId) override;
+	void updateManifest(const Common::String &engineId) override;
 #ifndef DETECTION_STATIC
 	void loadDetectionPlugin() override;
 	void unloadDetectionPlugin() override;
@@ -115,11 +115,12 @@ static inline bool inflateClickteam(byte *dst, uint  dstLen, const byte *src, ui
 /**
  * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
  * provides transparent on-the-fly decompression. Assumes the data it
- * retrieves from the wrapped stream to be either uncompressed or in gzip
- * format. In the former case, the original stream is returned unmodified
- * (and in particular, not wrapped). In the latter case the stream is
- * returned wrapped, unless there is no ZLIB support, then NULL is returned
- * and the old stream is destroyed.
+ * retrieves from the wrapped stream to be either uncompressed, in gzip
+ * format or an LZ4 frame. In the first case, the original stream is
+ * returned unmodified (and in particular, not wrapped). In the gzip case
+ * the stream is returned wrapped, unless there is no ZLIB support, then
+ * NULL is returned and the old stream is destroyed. LZ4 frames are handled
+ * by wrapLZ4ReadStream().
  *
  * Certain GZip-formats don't supply an easily readable length, if you
  * still need the length carried along with the stream, and you know
@@ -177,8 +178,12 @@ SeekableReadStream *wrapClickteamReadStream(SeekableReadStream *toBeWrapped,
  *
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
+ *
+ * @param toBeWrapped the stream to write the compressed data to
+ * @param level       the compression level, from 1 (fastest) to 9 (smallest),
+ *                    or -1 for the default trade-off of zlib
  */
-WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped);
+WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped, int level = -1);
 
 /** @} */
 
@@ -41,6 +41,7 @@
 #include "common/memstream.h"
 #include "common/textconsole.h"
 #include "common/compression/deflate.h"
+#include "common/compression/lz4.h"
 
 
 /* Compression methods (see algorithm.doc) */
@@ -1342,6 +1343,9 @@ SeekableReadStream* wrapCompressedReadStream(Common::SeekableReadStream *parent,
 		return nullptr;
 	}
 
+	if (isLZ4Stream(*parent))
+		return wrapLZ4ReadStream(parent, disposeParent);
+
 	uint16 header = parent->readUint16BE();
 	bool isCompressed = (header == 0x1F8B ||
 			     ((header & 0x0F00) == 0x0800 &&
@@ -1388,7 +1392,7 @@ SeekableReadStream* wrapDeflateReadStream(Common::SeekableReadStream *parent, Di
 	return gzio;
 }
 
-WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
+WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped, int level) {
 	// Not supported, return stream itself to write uncompressed data
 	return toBeWrapped;
 }
@@ -0,0 +1,781 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Implementation of the LZ4 frame format, see
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md
+// and https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+
+#include "common/compression/lz4.h"
+
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/hashmap.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Common {
+
+namespace {
+
+const uint32 kFrameMagic = 0x184D2204;
+// Skippable frames use the magic numbers 0x184D2A50 to 0x184D2A5F
+const uint32 kSkippableFrameMagic = 0x184D2A50;
+const uint32 kSkippableFrameMask = 0xFFFFFFF0;
+const uint32 kUncompressedBlock = 0x80000000;
+
+enum {
+	kFlagVersion = 0x40,
+	kFlagVersionMask = 0xC0,
+	kFlagBlockIndependence = 0x20,
+	kFlagBlockChecksum = 0x10,
+	kFlagContentSize = 0x08,
+	kFlagContentChecksum = 0x04,
+	kFlagReserved = 0x02,
+	kFlagDictId = 0x01,
+
+	// Matches may refer up to 64 KB back, into the previous blocks
+	kHistorySize = 64 * 1024,
+	kMaxOffset = 65535,
+	kBlockSize = 64 * 1024,
+	kBlockSizeId = 4,
+
+	kMinMatch = 4,
+	// The last match must start 12 bytes before the end of a block, and
+	// the last 5 bytes are always literals
+	kMatchLimit = 12,
+	kLastLiterals = 5,
+	kHashBits = 12,
+
+	// The skippable frame following the written frames
+	kTrailerSize = 16
+};
+
+const uint32 kPrime1 = 2654435761U;
+const uint32 kPrime2 = 2246822519U;
+const uint32 kPrime3 = 3266489917U;
+const uint32 kPrime4 = 668265263U;
+const uint32 kPrime5 = 374761393U;
+
+/** The 32-bit xxHash, with a seed of 0, as used by the frame format */
+class XXHash32 {
+public:
+	XXHash32() {
+		reset();
+	}
+
+	void reset() {
+		_acc[0] = kPrime1 + kPrime2;
+		_acc[1] = kPrime2;
+		_acc[2] = 0;
+		_acc[3] = 0 - kPrime1;
+		_length = 0;
+		_bufferSize = 0;
+	}
+
+	void update(const byte *data, uint32 size) {
+		_length += size;
+
+		if (_bufferSize + size < sizeof(_buffer)) {
+			memcpy(_buffer + _bufferSize, data, size);
+			_bufferSize += size;
+			return;
+		}
+
+		if (_bufferSize) {
+			const uint32 fill = sizeof(_buffer) - _bufferSize;
+			memcpy(_buffer + _bufferSize, data, fill);
+			processStripe(_buffer);
+			data += fill;
+			size -= fill;
+			_bufferSize = 0;
+		}
+
+		for (; size >= sizeof(_buffer); data += sizeof(_buffer), size -= sizeof(_buffer))
+			processStripe(data);
+
+		memcpy(_buffer, data, size);
+		_bufferSize = size;
+	}
+
+	uint32 digest() const {
+		uint32 hash;
+		if (_length >= sizeof(_buffer))
+			hash = ROTATE_LEFT_32(_acc[0], 1) + ROTATE_LEFT_32(_acc[1], 7) + ROTATE_LEFT_32(_acc[2], 12) + ROTATE_LEFT_32(_acc[3], 18);
+		else
+			hash = kPrime5;
+		hash += (uint32)_length;
+
+		const byte *data = _buffer;
+		uint32 size = _bufferSize;
+		for (; size >= 4; data += 4, size -= 4)
+			hash = ROTATE_LEFT_32(hash + READ_LE_UINT32(data) * kPrime3, 17) * kPrime4;
+		for (; size > 0; data++, size--)
+			hash = ROTATE_LEFT_32(hash + *data * kPrime5, 11) * kPrime1;
+
+		hash ^= hash >> 15;
+		hash *= kPrime2;
+		hash ^= hash >> 13;
+		hash *= kPrime3;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	static uint32 hash(const byte *data, uint32 size) {
+		XXHash32 hash;
+		hash.update(data, size);
+		return hash.digest();
+	}
+
+private:
+	void processStripe(const byte *data) {
+		for (int i = 0; i < 4; i++)
+			_acc[i] = ROTATE_LEFT_32(_acc[i] + READ_LE_UINT32(data + i * 4) * kPrime2, 13) * kPrime1;
+	}
+
+	uint32 _acc[4];
+	uint64 _length;
+	byte _buffer[16];
+	uint32 _bufferSize;
+};
+
+typedef HashMap<uint32, Array<byte> > DictionaryMap;
+
+// Only allocated once a dictionary is registered
+DictionaryMap *g_dictionaries = nullptr;
+
+uint32 getDictionaryId(const byte *data, uint32 size) {
+	if (size > kHistorySize) {
+		data += size - kHistorySize;
+		size = kHistorySize;
+	}
+	return XXHash32::hash(data, size);
+}
+
+} // End of anonymous namespace
+
+/**
+ * A simple wrapper class which can be used to wrap around an arbitrary
+ * other SeekableReadStream and will then provide on-the-fly decompression
+ * of the LZ4 frame it contains.
+ */
+class LZ4ReadStream : public SeekableReadStream {
+public:
+	LZ4ReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent) :
+			_wrapped(w), _disposeParent(disposeParent), _buffer(nullptr), _input(nullptr), _blockMaxSize(0), _size(-1) {
+		_valid = readFrameHeader();
+		if (_valid) {
+			_buffer = new byte[kHistorySize + _blockMaxSize];
+			_input = new byte[_blockMaxSize];
+			restart();
+		}
+	}
+
+	~LZ4ReadStream() {
+		delete[] _buffer;
+		delete[] _input;
+		if (_disposeParent == DisposeAfterUse::YES)
+			delete _wrapped;
+	}
+
+	bool isValid() const { return _valid; }
+
+	bool err() const override { return _err || _wrapped->err(); }
+	void clearErr() override { _err = false; _wrapped->clearErr(); }
+	bool eos() const override { return _eos; }
+	int64 pos() const override { return _pos; }
+	int64 size() const override { return _size; }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		byte *data = (byte *)dataPtr;
+		uint32 total = 0;
+
+		while (total < dataSize) {
+			if (_readPos == _blockEnd && !decodeBlock()) {
+				_eos = true;
+				break;
+			}
+
+			const uint32 size = MIN(dataSize - total, _blockEnd - _readPos);
+			memcpy(data + total, _buffer + _readPos, size);
+			_readPos += size;
+			total += size;
+		}
+
+		_pos += total;
+		return total;
+	}
+
+	bool seek(int64 offset, int whence = SEEK_SET) override {
+		int64 newPos;
+		switch (whence) {
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+			break;
+		case SEEK_END:
+			// Without a known size, decompress the whole frame to find it
+			if (_size < 0) {
+				skipTo(0x7FFFFFFFFFFFFFFFLL);
+				_size = _pos;
+			}
+			newPos = _size + offset;
+			break;
+		default:
+			return false;
+		}
+
+		if (newPos < 0 || (_size >= 0 && newPos > _size))
+			return false;
+
+		// Seeking backwards restarts the decompression
+		if (newPos < (int64)_pos)
+			restart();
+		skipTo(newPos);
+
+		_eos = false;
+		return !err();
+	}
+
+private:
+	bool readFrameHeader() {
+		if (_wrapped->readUint32LE() != kFrameMagic)
+			return false;
+
+		byte descriptor[2 + 8 + 4];
+		uint32 descriptorSize = 2;
+		if (_wrapped->read(descriptor, 2) != 2)
+			return false;
+
+		_flags = descriptor[0];
+		if ((_flags & kFlagVersionMask) != kFlagVersion || (_flags & kFlagReserved)) {
+			warning("LZ4ReadStream: Unsupported frame flags %02x", _flags);
+			return false;
+		}
+
+		const int blockSizeId = (descriptor[1] >> 4) & 7;
+		if (blockSizeId < 4) {
+			warning("LZ4ReadStream: Invalid block size %d", blockSizeId);
+			return false;
+		}
+		_blockMaxSize = 1 << (2 * blockSizeId + 8);
+
+		if (_flags & kFlagContentSize) {
+			if (_wrapped->read(descriptor + descriptorSize, 8) != 8)
+				return false;
+			_size = READ_LE_UINT64(descriptor + descriptorSize);
+			descriptorSize += 8;
+		}
+
+		_dictionary = nullptr;
+		if (_flags & kFlagDictId) {
+			if (_wrapped->read(descriptor + descriptorSize, 4) != 4)
+				return false;
+			const uint32 id = READ_LE_UINT32(descriptor + descriptorSize);
+			descriptorSize += 4;
+
+			DictionaryMap::iterator it;
+			if (!g_dictionaries || (it = g_dictionaries->find(id)) == g_dictionaries->end()) {
+				warning("LZ4ReadStream: Dictionary %08x is not available", id);
+				return false;
+			}
+			_dictionary = &it->_value;
+		}
+
+		const byte headerChecksum = _wrapped->readByte();
+		if (_wrapped->err() || _wrapped->eos() || headerChecksum != ((XXHash32::hash(descriptor, descriptorSize) >> 8) & 0xFF)) {
+			warning("LZ4ReadStream: Invalid frame header");
+			return false;
+		}
+		_dataStart = _wrapped->pos();
+
+		// Look for the size in the trailer written by LZ4WriteStream
+		if (_size < 0 && _wrapped->size() >= _dataStart + kTrailerSize) {
+			_wrapped->seek(-(int64)kTrailerSize, SEEK_END);
+			if ((_wrapped->readUint32LE() & kSkippableFrameMask) == kSkippableFrameMagic && _wrapped->readUint32LE() == 8)
+				_size = _wrapped->readUint32LE();
+			_wrapped->seek(_dataStart, SEEK_SET);
+		}
+
+		return !_wrapped->err();
+	}
+
+	void restart() {
+		_wrapped->seek(_dataStart, SEEK_SET);
+		_pos = 0;
+		_err = false;
+		_eos = false;
+		_endOfFrame = false;
+		_checksum.reset();
+
+		_historySize = 0;
+		if (_dictionary) {
+			_historySize = _dictionary->size();
+			memcpy(_buffer + kHistorySize - _historySize, _dictionary->data(), _historySize);
+		}
+		_readPos = _blockEnd = kHistorySize;
+	}
+
+	void skipTo(int64 newPos) {
+		while ((int64)_pos < newPos) {
+			if (_readPos == _blockEnd && !decodeBlock())
+				break;
+
+			const uint32 size = MIN<int64>(newPos - _pos, _blockEnd - _readPos);
+			_readPos += size;
+			_pos += size;
+		}
+	}
+
+	bool decodeBlock() {
+		if (_endOfFrame || err())
+			return false;
+
+		// The end of the previous block is the history of the next one
+		if (_blockEnd > kHistorySize) {
+			_historySize = MIN<uint32>(kHistorySize, _historySize + _blockEnd - kHistorySize);
+			memmove(_buffer + kHistorySize - _historySize, _buffer + _blockEnd - _historySize, _historySize);
+			_readPos = _blockEnd = kHistorySize;
+		}
+
+		const uint32 blockSize = _wrapped->readUint32LE();
+		if (_wrapped->err() || _wrapped->eos()) {
+			_err = true;
+			return false;
+		}
+
+		if (blockSize == 0) {
+			_endOfFrame = true;
+			if ((_flags & kFlagContentChecksum) && _wrapped->readUint32LE() != _checksum.digest()) {
+				warning("LZ4ReadStream: Checksum mismatch");
+				_err = true;
+			}
+			return false;
+		}
+
+		const uint32 size = blockSize & ~kUncompressedBlock;
+		if (size > _blockMaxSize) {
+			warning("LZ4ReadStream: Invalid block size %u", size);
+			_err = true;
+			return false;
+		}
+
+		byte *output = _buffer + kHistorySize;
+		uint32 outputSize = size;
+		if (blockSize & kUncompressedBlock) {
+			if (_wrapped->read(output, size) != size) {
+				_err = true;
+				return false;
+			}
+		} else {
+			if (_wrapped->read(_input, size) != size || !decompress(_input, size, output, outputSize)) {
+				warning("LZ4ReadStream: Corrupt block");
+				_err = true;
+				return false;
+			}
+		}
+
+		if (_flags & kFlagBlockChecksum)
+			_wrapped->skip(4);
+		if (_flags & kFlagContentChecksum)
+			_checksum.update(output, outputSize);
+
+		_blockEnd = kHistorySize + outputSize;
+		return true;
+	}
+
+	bool decompress(const byte *input, uint32 inputSize, byte *output, uint32 &outputSize) const {
+		const byte *ip = input;
+		const byte *const inputEnd = input + inputSize;
+		byte *op = output;
+		byte *const outputEnd = output + _blockMaxSize;
+		const byte *const lowest = (_flags & kFlagBlockIndependence) ? output : output - _historySize;
+
+		while (ip < inputEnd) {
+			const byte token = *ip++;
+
+			uint32 literals = token >> 4;
+			if (literals == 15) {
+				byte extra;
+				do {
+					if (ip == inputEnd)
+						return false;
+					extra = *ip++;
+					literals += extra;
+				} while (extra == 255);
+			}
+			if (literals > (uint32)(inputEnd - ip) || literals > (uint32)(outputEnd - op))
+				return false;
+			memcpy(op, ip, literals);
+			op += literals;
+			ip += literals;
+
+			// The last sequence has no match
+			if (ip == inputEnd)
+				break;
+
+			if (inputEnd - ip < 2)
+				return false;
+			const uint32 offset = READ_LE_UINT16(ip);
+			ip += 2;
+			if (offset == 0 || offset > (uint32)(op - lowest))
+				return false;
+
+			uint32 length = token & 15;
+			if (length == 15) {
+				byte extra;
+				do {
+					if (ip == inputEnd)
+						return false;
+					extra = *ip++;
+					length += extra;
+				} while (extra == 255);
+			}
+			length += kMinMatch;
+			if (length > (uint32)(outputEnd - op))
+				return false;
+
+			// The match may overlap the data it produces
+			const byte *match = op - offset;
+			if (offset >= length) {
+				memcpy(op, match, length);
+				op += length;
+			} else {
+				while (length--)
+					*op++ = *match++;
+			}
+		}
+
+		outputSize = op - output;
+		return true;
+	}
+
+	SeekableReadStream *_wrapped;
+	DisposeAfterUse::Flag _disposeParent;
+	int64 _dataStart;
+	bool _valid;
+
+	byte _flags;
+	uint32 _blockMaxSize;
+	const Array<byte> *_dictionary;
+
+	// The decoded block follows the history in the buffer
+	byte *_buffer;
+	byte *_input;
+	uint32 _historySize;
+	uint32 _readPos;
+	uint32 _blockEnd;
+
+	XXHash32 _checksum;
+	int64 _size;
+	uint64 _pos;
+	bool _err;
+	bool _eos;
+	bool _endOfFrame;
+};
+
+/**
+ * A simple wrapper class which can be used to wrap around an arbitrary
+ * other WriteStream and will then provide on-the-fly compression support.
+ * The compressed data is written in the LZ4 frame format.
+ */
+class LZ4WriteStream : public WriteStream {
+public:
+	LZ4WriteStream(WriteStream *w, const byte *dict, uint32 dictSize) :
+			_wrapped(w), _blockFill(0), _base(0), _pos(0), _finalized(false) {
+		assert(w != nullptr);
+
+		_buffer = new byte[kHistorySize + kBlockSize];
+		_output = new byte[kBlockSize];
+		memset(_hashTable, 0, sizeof(_hashTable));
+
+		_historySize = MIN<uint32>(dictSize, kHistorySize);
+		if (_historySize) {
+			memcpy(_buffer + kHistorySize - _historySize, dict + dictSize - _historySize, _historySize);
+			for (uint32 i = kHistorySize - _historySize; i + kMinMatch <= kHistorySize; i++)
+				_hashTable[hash(READ_LE_UINT32(_buffer + i))] = i;
+		}
+
+		byte descriptor[2 + 4];
+		uint32 descriptorSize = 2;
+		descriptor[0] = kFlagVersion | kFlagContentChecksum;
+		descriptor[1] = kBlockSizeId << 4;
+		if (_historySize) {
+			descriptor[0] |= kFlagDictId;
+			WRITE_LE_UINT32(descriptor + descriptorSize, getDictionaryId(dict, dictSize));
+			descriptorSize += 4;
+		}
+
+		_wrapped->writeUint32LE(kFrameMagic);
+		_wrapped->write(descriptor, descriptorSize);
+		_wrapped->writeByte((XXHash32::hash(descriptor, descriptorSize) >> 8) & 0xFF);
+	}
+
+	~LZ4WriteStream() {
+		finalize();
+		delete[] _buffer;
+		delete[] _output;
+	}
+
+	bool err() const override { return _wrapped->err(); }
+	void clearErr() override { _wrapped->clearErr(); }
+	int64 pos() const override { return _pos; }
+
+	uint32 write(const void *dataPtr, uint32 dataSize) override {
+		if (_finalized || err())
+			return 0;
+
+		const byte *data = (const byte *)dataPtr;
+		_checksum.update(data, dataSize);
+		_pos += dataSize;
+
+		while (dataSize > 0) {
+			const uint32 size = MIN<uint32>(dataSize, kBlockSize - _blockFill);
+			memcpy(_buffer + kHistorySize + _blockFill, data, size);
+			_blockFill += size;
+			data += size;
+			dataSize -= size;
+
+			if (_blockFill == kBlockSize)
+				writeBlock();
+		}
+
+		return err() ? 0 : (uint32)(data - (const byte *)dataPtr);
+	}
+
+	void finalize() override {
+		if (_finalized)
+			return;
+		_finalized = true;
+
+		if (_blockFill)
+			writeBlock();
+
+		const uint32 checksum = _checksum.digest();
+		_wrapped->writeUint32LE(0);
+		_wrapped->writeUint32LE(checksum);
+
+		_wrapped->writeUint32LE(kSkippableFrameMagic);
+		_wrapped->writeUint32LE(8);
+		_wrapped->writeUint32LE((uint32)_pos);
+		_wrapped->writeUint32LE(checksum);
+
+		// Finalize the wrapped savefile, too
+		_wrapped->finalize();
+	}
+
+private:
+	static uint32 hash(uint32 sequence) {
+		return (sequence * kPrime1) >> (32 - kHashBits);
+	}
+
+	void writeBlock() {
+		const uint32 size = compress(_blockFill);
+		if (size) {
+			_wrapped->writeUint32LE(size);
+			_wrapped->write(_output, size);
+		} else {
+			_wrapped->writeUint32LE(_blockFill | kUncompressedBlock);
+			_wrapped->write(_buffer + kHistorySize, _blockFill);
+		}
+
+		// Only the last block is partial, so the history is a whole block
+		memcpy(_buffer, _buffer + kHistorySize, _blockFill);
+		_historySize = _blockFill;
+		_base += kHistorySize;
+		_blockFill = 0;
+	}
+
+	// Positions in the hash table are relative to the start of the buffer
+	// when _base was 0, so that they stay valid when the buffer moves
+	uint32 getPosition(uint32 index) const { return _base + index; }
+
+	uint32 emit(byte *&op, const byte *literals, uint32 literalCount, uint32 offset, uint32 matchLength) const {
+		// Worst case size of the sequence, then check it fits
+		const uint32 size = 1 + literalCount / 255 + 1 + literalCount + 2 + matchLength / 255 + 1;
+		if (op + size > _output + kBlockSize)
+			return 0;
+
+		byte *token = op++;
+		*token = MIN<uint32>(literalCount, 15) << 4;
+		if (literalCount >= 15) {
+			uint32 extra = literalCount - 15;
+			for (; extra >= 255; extra -= 255)
+				*op++ = 255;
+			*op++ = extra;
+		}
+		memcpy(op, literals, literalCount);
+		op += literalCount;
+
+		if (matchLength) {
+			WRITE_LE_UINT16(op, offset);
+			op += 2;
+
+			uint32 extra = matchLength - kMinMatch;
+			*token |= MIN<uint32>(extra, 15);
+			if (extra >= 15) {
+				for (extra -= 15; extra >= 255; extra -= 255)
+					*op++ = 255;
+				*op++ = extra;
+			}
+		}
+		return size;
+	}
+
+	/**
+	 * Compress the current block into _output. Return the compressed size,
+	 * or 0 if the block does not get smaller.
+	 */
+	uint32 compress(uint32 blockSize) {
+		const byte *const src = _buffer;
+		const uint32 historyStart = kHistorySize - _historySize;
+		const uint32 end = kHistorySize + blockSize;
+
+		byte *op = _output;
+		uint32 anchor = kHistorySize;
+		uint32 ip = kHistorySize;
+
+		if (blockSize > kMatchLimit) {
+			const uint32 matchLimit = end - kMatchLimit;
+			const uint32 matchEnd = end - kLastLiterals;
+
+			while (ip < matchLimit) {
+				const uint32 sequence = READ_LE_UINT32(src + ip);
+				uint32 &entry = _hashTable[hash(sequence)];
+				uint32 ref = entry - _base;
+				entry = getPosition(ip);
+
+				if (ref < historyStart || ref >= ip || ip - ref > kMaxOffset || READ_LE_UINT32(src + ref) != sequence) {
+					// Skip faster through data which does not compress
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				while (ip > anchor && ref > historyStart && src[ip - 1] == src[ref - 1]) {
+					ip--;
+					ref--;
+				}
+
+				uint32 length = kMinMatch;
+				while (ip + length < matchEnd && src[ip + length] == src[ref + length])
+					length++;
+
+				if (!emit(op, src + anchor, ip - anchor, ip - ref, length))
+					return 0;
+
+				ip += length;
+				anchor = ip;
+
+				if (ip < matchLimit)
+					_hashTable[hash(READ_LE_UINT32(src + ip - 2))] = getPosition(ip - 2);
+			}
+		}
+
+		if (!emit(op, src + anchor, end - anchor, 0, 0))
+			return 0;
+
+		const uint32 size = op - _output;
+		return size < blockSize ? size : 0;
+	}
+
+	ScopedPtr<WriteStream> _wrapped;
+
+	// The block being filled follows the history in the buffer
+	byte *_buffer;
+	byte *_output;
+	uint32 _historySize;
+	uint32 _blockFill;
+	uint32 _base;
+	uint32 _hashTable[1 << kHashBits];
+
+	XXHash32 _checksum;
+	uint64 _pos;
+	bool _finalized;
+};
+
+bool isLZ4Stream(SeekableReadStream &stream) {
+	const int64 pos = stream.pos();
+	const bool isLZ4 = stream.readUint32LE() == kFrameMagic && !stream.err() && !stream.eos();
+	stream.clearErr();
+	stream.seek(pos, SEEK_SET);
+	return isLZ4;
+}
+
+uint32 getLZ4DictionaryId(SeekableReadStream &stream) {
+	const int64 pos = stream.pos();
+	uint32 id = 0;
+
+	if (stream.readUint32LE() == kFrameMagic) {
+		const byte flags = stream.readByte();
+		stream.skip((flags & kFlagContentSize) ? 1 + 8 : 1);
+		if (flags & kFlagDictId)
+			id = stream.readUint32LE();
+	}
+
+	if (stream.err() || stream.eos())
+		id = 0;
+	stream.clearErr();
+	stream.seek(pos, SEEK_SET);
+	return id;
+}
+
+uint32 registerLZ4Dictionary(const byte *data, uint32 size) {
+	if (size > kHistorySize) {
+		data += size - kHistorySize;
+		size = kHistorySize;
+	}
+
+	const uint32 id = getDictionaryId(data, size);
+	if (!g_dictionaries)
+		g_dictionaries = new DictionaryMap();
+
+	Array<byte> &dictionary = (*g_dictionaries)[id];
+	dictionary.resize(size);
+	memcpy(dictionary.data(), data, size);
+	return id;
+}
+
+bool hasLZ4Dictionary(uint32 id) {
+	return g_dictionaries && g_dictionaries->contains(id);
+}
+
+SeekableReadStream *wrapLZ4ReadStream(SeekableReadStream *toBeWrapped, DisposeAfterUse::Flag disposeParent) {
+	if (!toBeWrapped)
+		return nullptr;
+
+	LZ4ReadStream *stream = new LZ4ReadStream(toBeWrapped, disposeParent);
+	if (!stream->isValid()) {
+		delete stream;
+		return nullptr;
+	}
+	return stream;
+}
+
+WriteStream *wrapLZ4WriteStream(WriteStream *toBeWrapped, const byte *dict, uint32 dictSize) {
+	if (!toBeWrapped)
+		return nullptr;
+	return new LZ4WriteStream(toBeWrapped, dict, dictSize);
+}
+
+} // End of namespace Common
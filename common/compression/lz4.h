@@ -0,0 +1,115 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_LZ4_H
+#define COMMON_LZ4_H
+
+#include "common/scummsys.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_lz4 LZ4
+ * @ingroup common
+ *
+ * @brief API for the LZ4 frame format.
+ *
+ * LZ4 compresses several times faster than deflate, and decompresses
+ * faster still, at the cost of larger output. It needs no external library.
+ *
+ * The written frames use linked 64 KB blocks and a content checksum, and are
+ * followed by a skippable frame holding the size and the checksum of the
+ * data. The size allows seeking relative to the end without decompressing
+ * the whole frame first, and the last bytes identify the contents like the
+ * trailer of a gzip file does. Standard LZ4 tools can read these files.
+ *
+ * A frame may be compressed against a dictionary: data which precedes the
+ * actual data, and which near-identical files can refer to. A frame only
+ * records the id of its dictionary, so the dictionary has to be registered
+ * before the frame can be read.
+ *
+ * @{
+ */
+
+class SeekableReadStream;
+class WriteStream;
+
+/**
+ * Return whether @p stream starts with an LZ4 frame. The position of the
+ * stream is restored.
+ */
+bool isLZ4Stream(SeekableReadStream &stream);
+
+/**
+ * Return the id of the dictionary which the LZ4 frame at the start of
+ * @p stream needs, or 0 if it needs none. The position of the stream is
+ * restored.
+ */
+uint32 getLZ4DictionaryId(SeekableReadStream &stream);
+
+/**
+ * Register a dictionary for reading LZ4 frames. Only the last 64 KB of
+ * the data are used, and copied.
+ *
+ * @return the id of the dictionary, which is recorded in the frames
+ *         compressed against it
+ */
+uint32 registerLZ4Dictionary(const byte *data, uint32 size);
+
+/** Return whether the dictionary @p id has been registered. */
+bool hasLZ4Dictionary(uint32 id);
+
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
+ * provides transparent on-the-fly decompression of the LZ4 frame it
+ * contains. Seeking backwards restarts the decompression.
+ *
+ * NULL is returned if the frame header is invalid, or if its dictionary is
+ * not registered. The created stream also becomes responsible for freeing
+ * the passed stream, as does a failed call.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ */
+SeekableReadStream *wrapLZ4ReadStream(SeekableReadStream *toBeWrapped,
+		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES);
+
+/**
+ * Take an arbitrary WriteStream and wrap it in a custom stream which provides
+ * transparent on-the-fly compression in the LZ4 frame format. The created
+ * stream also becomes responsible for freeing the passed stream.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param toBeWrapped the stream to write the compressed data to
+ * @param dict        the dictionary to compress against, which must be
+ *                    registered to read the data back, or nullptr
+ * @param dictSize    the size of the dictionary
+ */
+WriteStream *wrapLZ4WriteStream(WriteStream *toBeWrapped, const byte *dict = nullptr, uint32 dictSize = 0);
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
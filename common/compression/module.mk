@@ -7,6 +7,7 @@ MODULE_OBJS := \
 	gzio.o \
 	installshield_cab.o \
 	installshieldv3_archive.o \
+	lz4.o \
 	packice.o \
 	powerpacker.o \
 	rnc_deco.o \
@@ -32,6 +32,7 @@
 #endif
 
 #include "common/compression/deflate.h"
+#include "common/compression/lz4.h"
 
 #include "common/ptr.h"
 #include "common/util.h"
@@ -308,7 +309,7 @@ protected:
 	}
 
 public:
-	GZipWriteStream(WriteStream *w) : _wrapped(w), _stream(), _pos(0) {
+	GZipWriteStream(WriteStream *w, int level) : _wrapped(w), _stream(), _pos(0) {
 		assert(w != nullptr);
 
 		// Adding 16 to windowBits indicates to zlib that it is supposed to
@@ -316,7 +317,7 @@ public:
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
 		_zlibErr = deflateInit2(&_stream,
-		                 Z_DEFAULT_COMPRESSION,
+		                 level,
 		                 Z_DEFLATED,
 		                 MAX_WBITS + 16,
 		                 8,
@@ -397,6 +398,9 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, Di
 		return nullptr;
 	}
 
+	if (isLZ4Stream(*toBeWrapped))
+		return wrapLZ4ReadStream(toBeWrapped, disposeParent);
+
 	uint16 header = toBeWrapped->readUint16BE();
 	bool isCompressed = (header == 0x1F8B ||
 			     ((header & 0x0F00) == 0x0800 &&
@@ -422,10 +426,10 @@ SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, Dispo
 	return new GZipReadStream(toBeWrapped, disposeParent, knownSize, dict, dictLen);
 }
 
-WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
+WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped, int level) {
 	if (!toBeWrapped)
 		return nullptr;
-	return new GZipWriteStream(toBeWrapped);
+	return new GZipWriteStream(toBeWrapped, level);
 }
 
 } // End of namespace Common
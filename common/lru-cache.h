@@ -0,0 +1,144 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_LRU_CACHE_H
+#define COMMON_LRU_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_lru_cache LRU cache
+ * @ingroup common
+ *
+ * @brief Memory-bounded cache evicting the least recently used values.
+ *
+ * @{
+ */
+
+/**
+ * A map whose values have a size, such as the size of the decoded data
+ * they hold. When adding a value would exceed the memory limit, the least
+ * recently used values are removed first.
+ *
+ * It is not thread safe.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class LRUCache {
+public:
+	explicit LRUCache(uint32 memoryLimit) : _memoryLimit(memoryLimit), _memoryUsage(0) {}
+
+	/**
+	 * Look up a value and mark it as the most recently used one.
+	 *
+	 * @return The value, or nullptr if it is not in the cache. It stays
+	 *         valid until the cache is next modified.
+	 */
+	Val *get(const Key &key) {
+		typename EntryMap::iterator it = _entries.find(key);
+		if (it == _entries.end())
+			return nullptr;
+
+		_lru.erase(it->_value.lruPosition);
+		it->_value.lruPosition = _lru.insert(_lru.end(), it->_key);
+		return &it->_value.value;
+	}
+
+	/**
+	 * Add a value, replacing the one with the same key, after evicting the
+	 * least recently used values until @p size fits in the memory limit.
+	 *
+	 * @return The added value.
+	 */
+	Val &put(const Key &key, const Val &value, uint32 size) {
+		erase(key);
+		evict(size);
+
+		Entry &entry = _entries[key];
+		entry.value = value;
+		entry.size = size;
+		entry.lruPosition = _lru.insert(_lru.end(), key);
+		_memoryUsage += size;
+		return entry.value;
+	}
+
+	/** Remove a value, if it is in the cache. */
+	void erase(const Key &key) {
+		typename EntryMap::iterator it = _entries.find(key);
+		if (it == _entries.end())
+			return;
+
+		_memoryUsage -= it->_value.size;
+		_lru.erase(it->_value.lruPosition);
+		_entries.erase(it);
+	}
+
+	/** Remove all values. */
+	void clear() {
+		_entries.clear();
+		_lru.clear();
+		_memoryUsage = 0;
+	}
+
+	/** Set the memory limit, and evict values to stay within it. */
+	void setMemoryLimit(uint32 bytes) {
+		_memoryLimit = bytes;
+		evict(0);
+	}
+
+	uint32 getMemoryLimit() const { return _memoryLimit; }
+	uint32 getMemoryUsage() const { return _memoryUsage; }
+	uint32 size() const { return _entries.size(); }
+
+private:
+	typedef List<Key> KeyList;
+
+	struct Entry {
+		Val value;
+		uint32 size;
+		typename KeyList::iterator lruPosition; ///< Position in the LRU list
+	};
+
+	typedef HashMap<Key, Entry, HashFunc, EqualFunc> EntryMap;
+
+	void evict(uint32 needed) {
+		while (!_lru.empty() && _memoryUsage + needed > _memoryLimit) {
+			typename EntryMap::iterator oldest = _entries.find(_lru.front());
+			_lru.pop_front();
+
+			_memoryUsage -= oldest->_value.size;
+			_entries.erase(oldest);
+		}
+	}
+
+	EntryMap _entries;
+	KeyList _lru; ///< Keys of the entries, least recently used first
+	uint32 _memoryLimit;
+	uint32 _memoryUsage;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -25,6 +25,7 @@
 #include "common/recorderfile.h"
 #include "common/savefile.h"
 #include "common/bufferedstream.h"
+#include "common/compression/lz4.h"
 #include "graphics/thumbnail.h"
 #include "graphics/managed_surface.h"
 #include "graphics/scaler.h"
@@ -33,6 +34,13 @@
 
 namespace Common {
 
+// Recordings are written while the game runs, so they are always compressed
+// with the fast LZ4 codec, whatever the save compression setting is. Loading
+// detects the format, so recordings compressed with gzip still play.
+static WriteStream *openRecordingForSaving(const String &fileName) {
+	return wrapLZ4WriteStream(g_system->getSavefileManager()->openForSaving(fileName, false));
+}
+
 PlaybackFile::PlaybackFile()
 	: _tmpBuffer(kRecordBuffSize)
 	, _tmpRecordFile(_tmpBuffer.data(), kRecordBuffSize)
@@ -62,7 +70,7 @@ bool PlaybackFile::openWrite(const String &fileName) {
 		error("Filename may not contain a path");
 	}
 	_header.fileName = fileName;
-	_writeStream = wrapBufferedWriteStream(g_system->getSavefileManager()->openForSaving(fileName), 128 * 1024);
+	_writeStream = wrapBufferedWriteStream(openRecordingForSaving(fileName), 128 * 1024);
 	_headerDumped = false;
 	_recordCount = 0;
 	if (_writeStream == NULL) {
@@ -86,7 +94,7 @@ bool PlaybackFile::openRead(const String &fileName) {
 		debugC(1, kDebugLevelEventRec, "playback:action=\"Load File\" result=fail reason=\"header parsing failed\"");
 		return false;
 	}
-	_screenshotsFile = wrapBufferedWriteStream(g_system->getSavefileManager()->openForSaving("screenshots.bin"), 128 * 1024);
+	_screenshotsFile = wrapBufferedWriteStream(openRecordingForSaving("screenshots.bin"), 128 * 1024);
 	debugC(1, kDebugLevelEventRec, "playback:action=\"Load File\" result=success");
 	_mode = kRead;
 	return true;
@@ -725,7 +733,7 @@ void PlaybackFile::updateHeader() {
 	_readStream->seek(0);
 	skipHeader();
 	String tmpFilename = "_" + _header.fileName;
-	_writeStream = g_system->getSavefileManager()->openForSaving(tmpFilename);
+	_writeStream = openRecordingForSaving(tmpFilename);
 	dumpHeaderToFile();
 	uint32 readedSize = 0;
 	do {
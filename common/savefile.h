@@ -276,6 +276,56 @@ public:
 	 * @return true if the file exists. false otherwise.
 	 */
 	virtual bool exists(const String &name) = 0;
+
+	/**
+	 * Write the save files opened for saving from now on in the background,
+	 * so creating them does not stall the game. This is used for autosaves.
+	 *
+	 * The data of such a file is buffered in memory, and compressed in the
+	 * background after the file has been finalized. It is written to disk
+	 * by waitForPendingSaves(), which reports the errors instead of the
+	 * file. Loading, overwriting or removing the file waits for it to be
+	 * written.
+	 *
+	 * Save file managers which cannot write in the background ignore this.
+	 *
+	 * @param enable            Whether to write in the background.
+	 * @param compressionLevel  Compression level of the files, from 1 (fastest)
+	 *                          to 9 (smallest).
+	 */
+	virtual void setBackgroundSaving(bool enable, int compressionLevel = 1) {}
+
+	/**
+	 * Check whether save files are still being compressed in the background.
+	 *
+	 * @return true if some save files are not compressed yet. false otherwise.
+	 */
+	virtual bool hasPendingSaves() { return false; }
+
+	/**
+	 * Write the save files compressed in the background to disk, after
+	 * compressing what is left of them on the calling thread.
+	 *
+	 * @return false if writing any of them failed since the last call, in
+	 *         which case the error is set. true otherwise.
+	 */
+	virtual bool waitForPendingSaves() { return true; }
+
+	/**
+	 * Set data resembling the save files of the running game, such as the
+	 * state of a new game, which the save files compressed with LZ4 refer
+	 * to. Near-identical save files then take a fraction of their space.
+	 *
+	 * The dictionary is stored alongside the save files, so they can be
+	 * loaded without setting it first. The engine resets it when it quits.
+	 *
+	 * Save file managers which cannot use a dictionary ignore this.
+	 *
+	 * @param data  The dictionary, of which only the last 64 KB are used,
+	 *              or nullptr to compress without a dictionary.
+	 * @param size  Size of the dictionary.
+	 */
+	virtual void setCompressionDictionary(const byte *data, uint32 size) {}
 };
 
 /** @} */
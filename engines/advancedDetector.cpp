@@ -21,6 +21,7 @@
 
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "common/algorithm.h"
 #include "common/debug.h"
 #include "common/util.h"
 #include "common/file.h"
@@ -394,13 +395,14 @@ Common::Error AdvancedMetaEngineDetectionBase::identifyGame(DetectedGame &game,
 	// the _directoryGlobsMap
 	preprocessDescriptions();
 
+	// Clear md5 cache before each detection starts, just in case. This
+	// also drops any stale directory listings.
+	ADCacheMan.clear();
+
 	// Compose a hashmap of all files in fslist.
 	FileMap allFiles;
 	composeFileHashMap(allFiles, files, (_maxScanDepth == 0 ? 1 : _maxScanDepth));
 
-	// Clear md5 cache before each detection starts, just in case.
-	ADCacheMan.clear();
-
 	// Run the detector on this
 	ADDetectedGames matches = detectGame(files.begin()->getParent(), allFiles, language, platform, extra);
 
@@ -427,8 +429,9 @@ Common::Error AdvancedMetaEngineDetectionBase::identifyGame(DetectedGame &game,
 		}
 	}
 
-	// Detection is done, no need to keep archives in memory anymore
+	// Detection is done, no need to keep archives and listings in memory anymore
 	ADCacheMan.clearArchives();
+	ADCacheMan.clearDirectories();
 
 	if (!agdDesc.desc)
 		return Common::kNoGameDataFoundError;
@@ -464,7 +467,7 @@ void AdvancedMetaEngineDetectionBase::composeFileHashMap(FileMap &allFiles, cons
 				continue;
 
 			Common::FSList files;
-			if (!file.getChildren(files, Common::FSNode::kListAll))
+			if (!ADCacheMan.getChildren(file, files))
 				continue;
 
 			composeFileHashMap(allFiles, files, depth - 1, tstr);
@@ -726,16 +729,21 @@ ADDetectedGames AdvancedMetaEngineDetectionBase::detectGame(const Common::FSNode
 
 	const ADGameFileDescription *fileDesc;
 	const ADGameDescription *g;
-	const byte *descPtr;
 
 	debugC(3, kDebugGlobalDetection, "Starting detection for engine '%s' in dir '%s'", getName(), parent.getPath().toString(Common::Path::kNativeSeparator).c_str());
 
 	preprocessDescriptions();
 
-	// Check which files are included in some ADGameDescription *and* whether
-	// they are present. Compute MD5s and file sizes for the available files.
-	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
-		g = (const ADGameDescription *)descPtr;
+	// Only the entries which have their indexed file present can match
+	Common::Array<uint> candidates;
+	findCandidates(parent, allFiles, candidates);
+
+	debugC(3, kDebugGlobalDetection, "Checking %d of %d detection entries", candidates.size(), getGameVariantCount());
+
+	// Check which files are included in some candidate ADGameDescription *and*
+	// whether they are present. Compute MD5s and file sizes for the available files.
+	for (uint c = 0; c < candidates.size(); c++) {
+		g = (const ADGameDescription *)(_gameDescriptors + candidates[c] * _descItemSize);
 
 		for (fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
 			MD5Properties md5prop = gameFileToMD5Props(fileDesc, g->flags);
@@ -763,9 +771,9 @@ ADDetectedGames AdvancedMetaEngineDetectionBase::detectGame(const Common::FSNode
 	bool gotAnyMatchesWithAllFiles = false;
 
 	// MD5 based matching
-	uint i;
-	for (i = 0, descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize, ++i) {
-		g = (const ADGameDescription *)descPtr;
+	for (uint c = 0; c < candidates.size(); c++) {
+		const uint i = candidates[c];
+		g = (const ADGameDescription *)(_gameDescriptors + i * _descItemSize);
 
 		// Do not even bother to look at entries which do not have matching
 		// language and platform (if specified).
@@ -891,6 +899,70 @@ ADDetectedGames AdvancedMetaEngineDetectionBase::detectGame(const Common::FSNode
 	return matched;
 }
 
+/**
+ * Return the name of the file whose Mac fork may be stored in @p path, as
+ * MacResManager looks for forks in AppleDouble files (also in a __MACOSX
+ * directory), MacBinary files and raw forks next to the file.
+ */
+static bool getForkFileName(const Common::Path &path, Common::Path &fileName) {
+	Common::StringArray components = path.splitComponents();
+	Common::String &name = components.back();
+
+	if (name.hasPrefix("._")) {
+		name.erase(0, 2);
+
+		for (uint i = 0; i + 1 < components.size(); i++) {
+			if (components[i].equalsIgnoreCase("__MACOSX")) {
+				components.remove_at(i);
+				break;
+			}
+		}
+	} else if (name.hasSuffixIgnoreCase(".rsrc") || name.hasSuffixIgnoreCase(".data")) {
+		name.erase(name.size() - 5);
+	} else if (name.hasSuffixIgnoreCase(".bin")) {
+		name.erase(name.size() - 4);
+	} else {
+		return false;
+	}
+
+	fileName = Common::Path::joinComponents(components);
+	return true;
+}
+
+void AdvancedMetaEngineDetectionBase::findCandidates(const Common::FSNode &parent, const FileMap &allFiles, Common::Array<uint> &candidates) const {
+	candidates = _unindexedEntries;
+
+	// MacResManager also looks for AppleDouble files in a __MACOSX
+	// directory outside of the scanned files
+	const bool checkAllForks = !_forkEntries.empty() && parent.getChild("__MACOSX").isDirectory();
+	if (checkAllForks)
+		candidates.push_back(_forkEntries);
+
+	for (FileMap::const_iterator file = allFiles.begin(); file != allFiles.end(); ++file) {
+		FileIndex::const_iterator entries = _fileIndex.find(file->_key);
+		if (entries != _fileIndex.end())
+			candidates.push_back(entries->_value);
+
+		Common::Path forkFileName;
+		if (!_forkEntries.empty() && !checkAllForks && getForkFileName(file->_key, forkFileName)) {
+			entries = _fileIndex.find(forkFileName);
+			if (entries != _fileIndex.end())
+				candidates.push_back(entries->_value);
+		}
+	}
+
+	// Keep the order of the detection table, which decides between matches,
+	// and check every entry once
+	Common::sort(candidates.begin(), candidates.end());
+
+	uint count = 0;
+	for (uint i = 0; i < candidates.size(); i++) {
+		if (i == 0 || candidates[i] != candidates[i - 1])
+			candidates[count++] = candidates[i];
+	}
+	candidates.resize(count);
+}
+
 ADDetectedGame AdvancedMetaEngineDetectionBase::detectGameFilebased(const FileMap &allFiles, const ADFileBasedFallback *fileBasedFallback) const {
 	const ADFileBasedFallback *ptr;
 	const char* const* filenames;
@@ -1015,9 +1087,27 @@ void AdvancedMetaEngineDetectionBase::preprocessDescriptions() {
 	}
 
 	// Now scan all detection entries
-	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
+	uint index = 0;
+	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize, index++) {
 		const ADGameDescription *g = (const ADGameDescription *)descPtr;
 
+		// Index the entry by its first file which is not inside an archive
+		const ADGameFileDescription *indexDesc = g->filesDescriptions;
+		MD5Properties indexProp = kMD5Head;
+		for (; indexDesc->fileName; indexDesc++) {
+			indexProp = gameFileToMD5Props(indexDesc, g->flags);
+			if (!(indexProp & kMD5Archive))
+				break;
+		}
+
+		if (indexDesc->fileName) {
+			_fileIndex[Common::Path(indexDesc->fileName)].push_back(index);
+			if (indexProp & kMD5MacMask)
+				_forkEntries.push_back(index);
+		} else {
+			_unindexedEntries.push_back(index);
+		}
+
 		// Scan for potential directory globs
 		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
 			if (strchr(fileDesc->fileName, '/')) {
@@ -25,13 +25,13 @@
 #include "engines/metaengine.h"
 #include "engines/engine.h"
 
+#include "common/fs.h"
 #include "common/hash-str.h"
 
 #include "common/gui_options.h" // Keep it here, so detection tables can refer to them
 
 namespace Common {
 class Error;
-class FSList;
 }
 /**
  * @defgroup engines_advdetector Advanced Detector
@@ -550,12 +550,29 @@ private:
 	static Common::StringArray getPathsFromEntry(const ADGameDescription *g);
 	bool isEntryGrayListed(const ADGameDescription *g) const;
 	void detectClashes() const;
+	void findCandidates(const Common::FSNode &parent, const FileMap &allFiles, Common::Array<uint> &candidates) const;
 
 private:
 	Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> _grayListMap;
 	Common::HashMap<Common::String, bool, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> _globsMap;
 	bool _hashMapsInited;
 
+	/**
+	 * Indices of the detection entries, by the first of their files which
+	 * is not inside an archive. An entry can only match if that file is in
+	 * the scanned directory, or for a Mac fork, one of the files it can be
+	 * stored in.
+	 */
+	typedef Common::HashMap<Common::Path, Common::Array<uint>, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> FileIndex;
+	FileIndex _fileIndex;
+	/** Indices of the entries indexed by a Mac fork. */
+	Common::Array<uint> _forkEntries;
+	/**
+	 * Indices of the entries without files, or with only files inside
+	 * archives, which are always checked.
+	 */
+	Common::Array<uint> _unindexedEntries;
+
 protected:
 	/**
 	 * Detect games in the specified directory.
@@ -744,7 +761,7 @@ private:
 };
 
 /**
- * Singleton Cache Storage for Computed MD5s and Open Archives
+ * Singleton Cache Storage for Computed MD5s, Open Archives and Directory Listings
  */
 class AdvancedDetectorCacheManager : public Common::Singleton<AdvancedDetectorCacheManager> {
 public:
@@ -785,10 +802,34 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
+	/**
+	 * List the children of a directory, reusing the listing made by any
+	 * earlier engine during the same detection run.
+	 */
+	bool getChildren(const Common::FSNode &node, Common::FSList &files) {
+		Common::Path path = node.getPath();
+
+		DirectoryHashMap::const_iterator it = directoryHashMap.find(path);
+		if (it != directoryHashMap.end()) {
+			files = it->_value;
+			return true;
+		}
+
+		if (!node.getChildren(files, Common::FSNode::kListAll))
+			return false;
+
+		directoryHashMap.setVal(path, files);
+		return true;
+	}
+
 	AdvancedDetectorCacheManager() {
 		clear();
 	}
 
+	void clearDirectories() {
+		directoryHashMap.clear(true);
+	}
+
 	void clearArchives() {
 		for (auto &entry : archiveHashMap) {
 			delete entry._value;
@@ -800,6 +841,7 @@ public:
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
 		clearArchives();
+		clearDirectories();
 	}
 
 private:
@@ -808,9 +850,11 @@ private:
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	typedef Common::HashMap<Common::Path, Common::Archive *, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> ArchiveHashMap;
+	typedef Common::HashMap<Common::Path, Common::FSList, Common::Path::Hash, Common::Path::EqualTo> DirectoryHashMap;
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
 	ArchiveHashMap archiveHashMap;
+	DirectoryHashMap directoryHashMap;
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
@@ -147,9 +147,18 @@ void VideoWindow::closeVideo() {
 void VideoWindow::updateVideo() {
 	if (_video) {
 		if (_video->needsUpdate()) {
-			// Store the frame for later
-			const Graphics::Surface *frame = _video->decodeNextFrame();
-			if (frame) {
+			if (_vm->isTrueColor() && _video->getPixelFormat() != g_system->getScreenFormat()) {
+				// Convert straight into our own frame, which is kept
+				// between frames instead of being reallocated each time
+				if (!_ownedFrame) {
+					_ownedFrame = new Graphics::Surface();
+					_ownedFrame->create(_video->getWidth(), _video->getHeight(), g_system->getScreenFormat());
+				}
+
+				if (_video->decodeNextFrameInto(*_ownedFrame, Common::Rect(_ownedFrame->w, _ownedFrame->h)))
+					_lastFrame = _ownedFrame;
+			} else if (const Graphics::Surface *frame = _video->decodeNextFrame()) {
+				// Store the frame for later
 				if (_ownedFrame) {
 					_ownedFrame->free();
 					delete _ownedFrame;
@@ -157,13 +166,8 @@ void VideoWindow::updateVideo() {
 				}
 
 				if (_vm->isTrueColor()) {
-					// Convert to the screen format if necessary
-					if (frame->format == g_system->getScreenFormat()) {
-						_lastFrame = frame;
-					} else {
-						_ownedFrame = frame->convertTo(g_system->getScreenFormat(), _video->getPalette());
-						_lastFrame = _ownedFrame;
-					}
+					// Already in the screen format
+					_lastFrame = frame;
 				} else {
 					if (_needsPalConversion) {
 						// If it's a palette video, ensure it's using the screen palette
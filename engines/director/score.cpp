@@ -1897,7 +1897,7 @@ void Score::playSoundChannel(bool puppetOnly, bool sound1Changed, bool sound2Cha
 
 void Score::playQueuedSound() {
 	DirectorSound *sound = _window->getSoundManager();
-	sound->playFPlaySound();
+	sound->updateFPlaySound();
 }
 
 void Score::loadFrames(Common::SeekableReadStreamEndian &stream, uint16 version, bool loadSprites) {
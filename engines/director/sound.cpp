@@ -32,6 +32,7 @@
 #include "audio/decoders/raw.h"
 #include "audio/softsynth/pcspk.h"
 #include "audio/decoders/aiff.h"
+#include "audio/music_queue.h"
 
 #include "director/director.h"
 #include "director/movie.h"
@@ -56,6 +57,8 @@ DirectorSound::DirectorSound(Window *window) : _window(window) {
 	_speaker = new Audio::PCSpeaker();
 	_speaker->init();
 
+	_fplayStream = nullptr;
+
 	_enable = true;
 }
 
@@ -128,7 +131,7 @@ void DirectorSound::setChannelPitchShift(int soundChannel, int pitchShiftPercent
 }
 
 
-void DirectorSound::playStream(Audio::AudioStream &stream, int soundChannel) {
+void DirectorSound::playStream(Audio::AudioStream &stream, int soundChannel, DisposeAfterUse::Flag disposeAfterUse) {
 	if (!assertChannel(soundChannel))
 		return;
 
@@ -139,7 +142,7 @@ void DirectorSound::playStream(Audio::AudioStream &stream, int soundChannel) {
 	setChannelDefaultVolume(soundChannel);
 
 
-	_mixer->playStream(Audio::Mixer::kSFXSoundType, &_channels[soundChannel]->handle, &stream, -1, getChannelVolume(soundChannel));
+	_mixer->playStream(Audio::Mixer::kSFXSoundType, &_channels[soundChannel]->handle, &stream, -1, getChannelVolume(soundChannel), 0, disposeAfterUse);
 	_channels[soundChannel]->originalRate = (int)_mixer->getChannelRate(_channels[soundChannel]->handle);
 	if (_channels[soundChannel]->pitchShiftPercent != 100) {
 		_mixer->setChannelRate(_channels[soundChannel]->handle, _channels[soundChannel]->originalRate*_channels[soundChannel]->pitchShiftPercent/100);
@@ -534,6 +537,8 @@ void DirectorSound::stopSound(int soundChannel) {
 		_channels[soundChannel]->loopPtr = nullptr;
 	cancelFade(soundChannel);
 	_mixer->stopHandle(_channels[soundChannel]->handle);
+	if (soundChannel == 1)
+		deleteFPlayStream();
 	setLastPlayedSound(soundChannel, SoundID());
 	_channels[soundChannel]->fromLastMovie = false;
 	return;
@@ -554,6 +559,8 @@ void DirectorSound::stopSound() {
 		it._value->fromLastMovie = false;
 	}
 
+	deleteFPlayStream();
+
 	_mixer->stopHandle(_scriptSound);
 	_speaker->quit();
 }
@@ -611,24 +618,7 @@ void DirectorSound::playPuppetSound(int soundChannel) {
 	playSound(_channels[soundChannel]->puppet, soundChannel, true);
 }
 
-void DirectorSound::playFPlaySound() {
-	if (_fplayQueue.empty())
-		return;
-	// only when the previous sound is finished, shall we play next one
-	if (isChannelActive(1))
-		return;
-
-	Common::String sndName = _fplayQueue.pop();
-	if (sndName.equalsIgnoreCase("stop")) {
-		stopSound(1);
-		_currentSoundName = "";
-
-		if (_fplayQueue.empty())
-			return;
-		else
-			sndName = _fplayQueue.pop();
-	}
-
+Audio::AudioStream *DirectorSound::loadFPlaySound(const Common::String &sndName, bool looping) {
 	uint32 tag = MKTAG('s', 'n', 'd', ' ');
 	uint id = 0xFFFF;
 	Archive *archive = nullptr;
@@ -643,52 +633,94 @@ void DirectorSound::playFPlaySound() {
 	}
 
 	if (id == 0xFFFF) {
-		warning("DirectorSound:playFPlaySound: can not find sound %s", sndName.c_str());
-		return;
+		warning("DirectorSound:loadFPlaySound: can not find sound %s", sndName.c_str());
+		return nullptr;
 	}
 
 	Common::SeekableReadStreamEndian *sndData = archive->getResource(tag, id);
-	if (sndData != nullptr) {
-		SNDDecoder ad;
-		ad.loadStream(*sndData);
-		delete sndData;
+	if (sndData == nullptr)
+		return nullptr;
 
-		Audio::AudioStream *as;
-		bool looping = false;
+	SNDDecoder ad;
+	ad.loadStream(*sndData);
+	delete sndData;
 
-		if (!_fplayQueue.empty() && _fplayQueue.front().equalsIgnoreCase("continuous")) {
-			_fplayQueue.pop();
-			looping = true;
-		}
+	// FPlay is controlled by Lingo, not the score, like a puppet,
+	// so we'll get the puppet version of the stream.
+	Audio::AudioStream *as = ad.getAudioStream(looping, true);
+	if (!as)
+		warning("DirectorSound:loadFPlaySound: failed to get audio stream");
 
-		// FPlay is controlled by Lingo, not the score, like a puppet,
-		// so we'll get the puppet version of the stream.
-		as = ad.getAudioStream(looping, true);
+	return as;
+}
 
-		if (!as) {
-			warning("DirectorSound:playFPlaySound: failed to get audio stream");
-			return;
-		}
+void DirectorSound::updateFPlaySound() {
+	if (!_fplayStream)
+		return;
 
-		// update current playing sound
-		_currentSoundName = sndName;
+	// The queue moves on to the next sound itself, just follow it to
+	// update the current playing sound
+	uint32 started = _fplayNames.size() - _fplayStream->numQueuedTracks();
+	if (started > 0)
+		_currentSoundName = _fplayNames[started - 1];
+}
 
-		playStream(*as, 1);
+void DirectorSound::playFPlaySound(const Common::Array<Common::String> &fplayList) {
+	// stop the previous sounds, because new ones are coming
+	if (isChannelActive(1))
+		stopSound(1);
+	deleteFPlayStream();
+
+	// The sounds are played back to back from a music queue, which
+	// loads each one ahead of time instead of waiting for the next frame
+	// after the previous one finished.
+	Audio::MusicQueueStream *queue = nullptr;
+
+	for (uint i = 0; i < fplayList.size(); i++) {
+		const Common::String &sndName = fplayList[i];
+
+		// The next sound only starts once the previous one finished, so
+		// there is nothing left to stop
+		if (sndName.equalsIgnoreCase("stop") || sndName.equalsIgnoreCase("continuous"))
+			continue;
+
+		// A looping sound never finishes, so the ones after it never play
+		bool looping = i + 1 < fplayList.size() && fplayList[i + 1].equalsIgnoreCase("continuous");
+
+		Audio::AudioStream *as = loadFPlaySound(sndName, looping);
+		if (!as)
+			continue;
+
+		// Sounds with another format are converted to that of the first
+		if (!queue)
+			queue = new Audio::MusicQueueStream(as->getRate(), as->isStereo());
+
+		queue->queueTrack(as);
+		_fplayNames.push_back(sndName);
 	}
 
+	if (!queue)
+		return;
+
+	queue->finish();
+	queue->prefetch();
+	_fplayStream = queue;
+
+	// The queue must not be disposed of by the mixer, see deleteFPlayStream()
+	playStream(*queue, 1, DisposeAfterUse::NO);
+	updateFPlaySound();
+
 	// Set the last played sound so that cast member 0 in the sound channel doesn't stop this file.
 	setLastPlayedSound(1, SoundID(), false);
 }
 
-void DirectorSound::playFPlaySound(const Common::Array<Common::String> &fplayList) {
-	for (uint i = 0; i < fplayList.size(); i++)
-		_fplayQueue.push(fplayList[i]);
-
-	// stop the previous sound, because new one is coming
-	if (isChannelActive(1))
-		stopSound(1);
-
-	playFPlaySound();
+void DirectorSound::deleteFPlayStream() {
+	// Called once the queue no longer plays on channel 1. Deleting it
+	// waits for the timer proc topping it up, which must not happen in
+	// the mixer.
+	delete _fplayStream;
+	_fplayStream = nullptr;
+	_fplayNames.clear();
 }
 
 void DirectorSound::setChannelVolumeInternal(int soundChannel, uint8 volume) {
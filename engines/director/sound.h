@@ -30,6 +30,7 @@ namespace Audio {
 	class PCSpeaker;
 	class RewindableAudioStream;
 	class LoopableAudioStream;
+	class MusicQueueStream;
 }
 
 namespace Common {
@@ -175,8 +176,9 @@ private:
 	Audio::Mixer *_mixer;
 	Audio::PCSpeaker *_speaker;
 
-	// these two were used in fplay xobj
-	Common::Queue<Common::String> _fplayQueue;
+	// these were used in fplay xobj
+	Audio::MusicQueueStream *_fplayStream;
+	Common::Array<Common::String> _fplayNames;
 	Common::String _currentSoundName;
 
 	bool _enable;
@@ -190,12 +192,12 @@ public:
 	SoundChannel *getChannel(int soundChannel);
 	void playFile(Common::String filename, int soundChannel);
 	void playMCI(Audio::AudioStream &stream, uint32 from, uint32 to);
-	void playStream(Audio::AudioStream &stream, int soundChannel);
+	void playStream(Audio::AudioStream &stream, int soundChannel, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::YES);
 	void playSound(SoundID soundId, int soundChannel, bool forPuppet = false);
 	void playCastMember(CastMemberID memberID, int soundChannel, bool forPuppet = false);
 	void playExternalSound(uint16 menu, uint16 submenu, int soundChannel);
 	void playFPlaySound(const Common::Array<Common::String> &fplayList);
-	void playFPlaySound();
+	void updateFPlaySound();
 	void setSoundEnabled(bool enabled);
 	void systemBeep();
 	void changingMovie();
@@ -237,6 +239,9 @@ private:
 	bool isLastPlayedSound(int soundChannel, const SoundID &soundId);
 	bool shouldStopOnZero(int soundChannel);
 
+	Audio::AudioStream *loadFPlaySound(const Common::String &sndName, bool looping);
+	void deleteFPlayStream();
+
 	void setChannelVolumeInternal(int soundChannel, uint8 volume);
 	bool assertChannel(int soundChannel);
 	void cancelFade(int soundChannel);
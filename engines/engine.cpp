@@ -55,6 +55,8 @@
 #include "gui/unknown-game-dialog.h"
 
 #include "audio/mixer.h"
+#include "audio/render_ahead.h"
+#include "audio/sound_cache.h"
 
 #include "graphics/cursorman.h"
 #include "graphics/fontman.h"
@@ -63,6 +65,9 @@
 #include "graphics/font.h"
 #include "graphics/hotspot_renderer.h"
 #include "image/bmp.h"
+#include "image/codecs/dither.h"
+#include "image/image_cache.h"
+#include "video/decode_ahead.h"
 
 #include "common/text-to-speech.h"
 
@@ -152,6 +157,7 @@ Engine::Engine(OSystem *syst)
 		_pauseScreenChangeID(-1),
 		_saveSlotToLoad(-1),
 		_autoSaving(false),
+		_autosavePending(false),
 		_engineStartTime(_system->getMillis()),
 		_mainMenuDialog(NULL),
 		_debugger(NULL),
@@ -229,6 +235,26 @@ Engine::~Engine() {
 	// Remove our cursors again to prevent memory leaks
 	CursorMan.popCursor();
 	CursorMan.popCursorPalette();
+
+	// Cached images and sounds are identified by game-specific paths, and
+	// the dither tables are for the palettes of the game
+	Image::ImageCache::destroy();
+	Audio::SoundCache::destroy();
+	Image::DitherCodec::freeQuickTimeDitherTables();
+
+	// All render-ahead streams and music queues were stopped with the
+	// mixer, so stop topping them up
+	Audio::RenderAheadManager::destroy();
+
+	// The videos of the engine are closed by now
+	Video::DecodeAheadManager::destroy();
+
+	// Let the last autosave reach the disk before returning to the launcher
+	if (_autosavePending)
+		_saveFileMan->waitForPendingSaves();
+
+	// The dictionary is specific to the game
+	_saveFileMan->setCompressionDictionary(nullptr, 0);
 }
 
 void Engine::initializePath(const Common::FSNode &gamePath) {
@@ -629,6 +655,12 @@ void Engine::handleAutoSave() {
 	if (!g_eventRec.processAutosave())
 		return;
 #endif
+	if (_autosavePending && !_saveFileMan->hasPendingSaves()) {
+		_autosavePending = false;
+		if (!_saveFileMan->waitForPendingSaves())
+			g_system->displayMessageOnOSD(_("Error occurred making autosave"));
+	}
+
 	const int diff = _system->getMillis() - _lastAutosaveTime;
 
 	if (_autosaveInterval != 0 && diff > (_autosaveInterval * 1000)) {
@@ -689,10 +721,20 @@ void Engine::saveAutosaveIfEnabled() {
 	if (saveFlag)
 		saveFlag = warnBeforeOverwritingAutosave();
 
-	if (saveFlag && saveGameState(autoSaveSlot, autoSaveName, true).getCode() != Common::kNoError) {
-		// Couldn't autosave at the designated time
-		g_system->displayMessageOnOSD(_("Error occurred making autosave"));
-		saveFlag = false;
+	if (saveFlag) {
+		// Compressing the save would stall the game, so it is done in the
+		// background. handleAutoSave() then writes it and reports errors.
+		_saveFileMan->setBackgroundSaving(true);
+		const Common::Error error = saveGameState(autoSaveSlot, autoSaveName, true);
+		_saveFileMan->setBackgroundSaving(false);
+
+		if (error.getCode() != Common::kNoError) {
+			// Couldn't autosave at the designated time
+			g_system->displayMessageOnOSD(_("Error occurred making autosave"));
+			saveFlag = false;
+		} else {
+			_autosavePending = true;
+		}
 	}
 
 	_lastAutosaveTime = _system->getMillis();
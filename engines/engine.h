@@ -261,6 +261,11 @@ private:
 	 */
 	bool _autoSaving;
 
+	/**
+	 * Set until the last autosave, compressed in the background, is written.
+	 */
+	bool _autosavePending;
+
 	/**
 	 * Optional debugger for the engine.
 	 */
@@ -21,6 +21,7 @@
 
 #include "engines/metaengine.h"
 #include "engines/engine.h"
+#include "engines/saveindex.h"
 
 #include "backends/keymapper/action.h"
 #include "backends/keymapper/keymap.h"
@@ -392,6 +393,11 @@ SaveStateList MetaEngine::listSaves(const char *target) const {
 
 	filenames = saveFileMan->listSavefiles(pattern);
 
+	// Record the headers read by querySaveMetaInfos(), so that the next
+	// listing does not need to read the unchanged save files again
+	SaveStateIndex index(target);
+	const bool updateIndex = index.beginUpdate();
+
 	SaveStateList saveList;
 	for (const auto &file : filenames) {
 		// Obtain the last 2/3 digits of the filename, since they correspond to the save slot
@@ -409,6 +415,9 @@ SaveStateList MetaEngine::listSaves(const char *target) const {
 		}
 	}
 
+	if (updateIndex)
+		index.endUpdate();
+
 	// Sort saves based on slot number.
 	Common::sort(saveList.begin(), saveList.end(), SaveStateDescriptorSlotComparator());
 	return saveList;
@@ -473,15 +482,41 @@ SaveStateDescriptor MetaEngine::querySaveMetaInfos(const char *target, int slot)
 	if (!hasFeature(kSavesUseExtendedFormat))
 		return SaveStateDescriptor();
 
-	Common::ScopedPtr<Common::InSaveFile> f(g_system->getSavefileManager()->openForLoading(
-		getSavegameFile(slot, target)));
+	const Common::String filename = getSavegameFile(slot, target);
+
+	// Uncompressed save files are not indexed, their header is read directly
+	SaveStateIndex::Fingerprint fingerprint;
+	SaveStateIndex *index = nullptr;
+	Common::ScopedPtr<SaveStateIndex> loadedIndex;
+	if (SaveStateIndex::getFingerprint(filename, fingerprint)) {
+		// Use the index which MetaEngine::listSaves() is updating, if any
+		index = SaveStateIndex::getUpdating(target);
+		if (!index) {
+			loadedIndex.reset(new SaveStateIndex(target));
+			index = loadedIndex.get();
+		}
+	}
+
+	ExtendedSavegameHeader header;
+	if (index && index->find(filename, fingerprint, header)) {
+		// The thumbnail is only read if it is shown
+		SaveStateDescriptor desc(this, slot);
+		parseSavegameHeader(&header, &desc);
+		desc.setThumbnailLoader(index->getThumbnailLoader(filename, fingerprint));
+		desc.setAutosave(header.isAutosave);
+		return desc;
+	}
+
+	Common::ScopedPtr<Common::InSaveFile> f(g_system->getSavefileManager()->openForLoading(filename));
 
 	if (f) {
-		ExtendedSavegameHeader header;
 		if (!readSavegameHeader(f.get(), &header, false)) {
 			return SaveStateDescriptor();
 		}
 
+		if (index && !loadedIndex)
+			index->update(filename, fingerprint, header);
+
 		// Create the return descriptor
 		SaveStateDescriptor desc(this, slot);
 		parseSavegameHeader(&header, &desc);
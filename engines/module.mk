@@ -8,6 +8,7 @@ MODULE_OBJS := \
 	game.o \
 	metaengine.o \
 	obsolete.o \
+	saveindex.o \
 	savestate.o
 
 # Include common rules
@@ -88,31 +88,13 @@ void Movie::initFromMovieFile(const Common::Path &fileName, bool transparent) {
 
 void Movie::redrawMovieWorld() {
 	if (_video && _video->needsUpdate()) {
-		const Graphics::Surface *frame = _video->decodeNextFrame();
-
-		if (!frame)
+		// Cinepak frames are decoded straight into the surface using
+		// _movieBox, other ones are converted to the screen format on the
+		// way if necessary. The surface only holds the movie, so it is left
+		// as is between frames.
+		if (!_video->decodeNextFrameInto(*_surface, _movieBox))
 			return;
 
-		// Make sure we have a surface in the current pixel format
-		Graphics::Surface *convertedFrame = nullptr;
-
-		if (frame->format != g_system->getScreenFormat()) {
-			convertedFrame = frame->convertTo(g_system->getScreenFormat());
-			frame = convertedFrame;
-		}
-
-		// Copy to the surface using _movieBox
-		uint16 width = MIN<int>(frame->w, _movieBox.width());
-		uint16 height = MIN<int>(frame->h, _movieBox.height());
-
-		for (uint16 y = 0; y < height; y++)
-			memcpy((byte *)_surface->getBasePtr(_movieBox.left, _movieBox.top + y), (const byte *)frame->getBasePtr(0, y), width * frame->format.bytesPerPixel);
-
-		if (convertedFrame) {
-			convertedFrame->free();
-			delete convertedFrame;
-		}
-
 		triggerRedraw();
 	}
 }
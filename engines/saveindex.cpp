@@ -0,0 +1,373 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "engines/saveindex.h"
+#include "engines/metaengine.h"
+
+#include "common/compression/lz4.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/scaler.h"
+#include "graphics/surface.h"
+#include "graphics/thumbnail.h"
+
+#define SAVE_INDEX_VERSION 2
+
+// Tag, version, number of entries and size of the entries
+static const uint32 kHeaderSize = 4 + 1 + 4 + 4;
+// Size and tail of the save file
+static const uint32 kFingerprintSize = 4 + 8;
+
+SaveStateIndex *SaveStateIndex::_updating = nullptr;
+
+namespace {
+
+void writeFingerprint(Common::WriteStream &out, const SaveStateIndex::Fingerprint &fingerprint) {
+	out.writeUint32LE(fingerprint.size);
+	out.write(fingerprint.tail, sizeof(fingerprint.tail));
+}
+
+void readFingerprint(Common::ReadStream &in, SaveStateIndex::Fingerprint &fingerprint) {
+	fingerprint.size = in.readUint32LE();
+	in.read(fingerprint.tail, sizeof(fingerprint.tail));
+}
+
+class IndexThumbnailLoader : public SaveStateThumbnailLoader {
+public:
+	IndexThumbnailLoader(const Common::String &indexFilename, uint32 offset, uint32 size, const SaveStateIndex::Fingerprint &fingerprint) :
+		_indexFilename(indexFilename), _offset(offset), _size(size), _fingerprint(fingerprint) {
+	}
+
+	Graphics::Surface *loadThumbnail() const override {
+		Common::ScopedPtr<Common::InSaveFile> file(g_system->getSavefileManager()->openRawFile(_indexFilename));
+		if (!file || file->size() < _offset + kFingerprintSize + _size || !file->seek(_offset))
+			return nullptr;
+
+		// The index may have been rewritten since the descriptor was created,
+		// in which case the thumbnail has moved
+		SaveStateIndex::Fingerprint fingerprint;
+		readFingerprint(*file, fingerprint);
+		if (!(fingerprint == _fingerprint))
+			return nullptr;
+
+		// Read the whole thumbnail at once, as it is decoded a pixel at a time
+		Common::ScopedPtr<Common::SeekableReadStream> data(file->readStream(_size));
+		if (data->size() != _size)
+			return nullptr;
+
+		Graphics::Surface *thumbnail = nullptr;
+		if (!Graphics::loadThumbnail(*data, thumbnail))
+			return nullptr;
+		return thumbnail;
+	}
+
+private:
+	Common::String _indexFilename;
+	uint32 _offset;
+	uint32 _size;
+	SaveStateIndex::Fingerprint _fingerprint;
+};
+
+void writeString(Common::WriteStream &out, const Common::String &str) {
+	out.writeUint16LE(str.size());
+	out.writeString(str);
+}
+
+Common::String readString(Common::ReadStream &in) {
+	const uint16 size = in.readUint16LE();
+	return in.readString(0, size);
+}
+
+} // End of anonymous namespace
+
+bool SaveStateIndex::Fingerprint::operator==(const Fingerprint &other) const {
+	return size == other.size && !memcmp(tail, other.tail, sizeof(tail));
+}
+
+SaveStateIndex::SaveStateIndex(const Common::String &target) :
+		_target(target), _filename(getFilename(target)), _changed(false) {
+	load();
+}
+
+SaveStateIndex::~SaveStateIndex() {
+	if (_updating == this)
+		endUpdate();
+}
+
+Common::String SaveStateIndex::getFilename(const Common::String &target) {
+	// Target names cannot start with a dot, so no save file pattern of an
+	// engine matches the index, and the cloud does not synchronize it
+	return "." + target + ".saveindex";
+}
+
+bool SaveStateIndex::getFingerprint(const Common::String &filename, Fingerprint &fingerprint) {
+	// The raw file is only opened, while loading a compressed file would
+	// decompress it up to the header at its end
+	Common::ScopedPtr<Common::InSaveFile> file(g_system->getSavefileManager()->openRawFile(filename));
+	if (!file)
+		return false;
+
+	// Only the last bytes of compressed files identify their contents
+	const uint16 magic = file->readUint16BE();
+	file->seek(0);
+	if (magic != 0x1F8B && !Common::isLZ4Stream(*file))
+		return false;
+
+	fingerprint.size = file->size();
+	memset(fingerprint.tail, 0, sizeof(fingerprint.tail));
+	if (fingerprint.size >= sizeof(fingerprint.tail)) {
+		file->seek(-(int32)sizeof(fingerprint.tail), SEEK_END);
+		file->read(fingerprint.tail, sizeof(fingerprint.tail));
+	}
+
+	return !file->err();
+}
+
+SaveStateIndex *SaveStateIndex::getUpdating(const Common::String &target) {
+	if (_updating && _updating->_target == target)
+		return _updating;
+	return nullptr;
+}
+
+bool SaveStateIndex::find(const Common::String &filename, const Fingerprint &fingerprint, ExtendedSavegameHeader &header) {
+	EntryMap::iterator it = _entries.find(filename);
+	if (it == _entries.end() || !(it->_value.fingerprint == fingerprint))
+		return false;
+
+	const Entry &entry = it->_value;
+	it->_value.seen = true;
+
+	Common::strcpy_s(header.id, "SVMCR");
+	header.version = EXTENDED_SAVE_VERSION;
+	header.description = entry.description;
+	header.date = entry.date;
+	header.time = entry.time;
+	header.playtime = entry.playtime;
+	header.isAutosave = entry.isAutosave;
+	header.thumbnail = nullptr;
+	return true;
+}
+
+Common::SharedPtr<SaveStateThumbnailLoader> SaveStateIndex::getThumbnailLoader(const Common::String &filename, const Fingerprint &fingerprint) const {
+	EntryMap::const_iterator it = _entries.find(filename);
+	if (it == _entries.end() || !(it->_value.fingerprint == fingerprint) || !it->_value.thumbnailSize)
+		return Common::SharedPtr<SaveStateThumbnailLoader>();
+
+	return Common::SharedPtr<SaveStateThumbnailLoader>(new IndexThumbnailLoader(_filename, it->_value.thumbnailOffset, it->_value.thumbnailSize, fingerprint));
+}
+
+void SaveStateIndex::update(const Common::String &filename, const Fingerprint &fingerprint, const ExtendedSavegameHeader &header) {
+	Entry entry;
+	entry.fingerprint = fingerprint;
+	entry.description = header.description;
+	entry.date = header.date;
+	entry.time = header.time;
+	entry.playtime = header.playtime;
+	entry.isAutosave = header.isAutosave;
+	entry.thumbnailOffset = 0;
+	entry.thumbnailSize = 0;
+	entry.seen = true;
+
+	if (header.thumbnail) {
+		const Graphics::Surface *thumbnail = header.thumbnail;
+		Graphics::Surface *scaled = nullptr;
+
+		if (thumbnail->w > kThumbnailWidth || thumbnail->h > kThumbnailHeight2) {
+			const int width = MIN<int>(kThumbnailWidth, thumbnail->w * kThumbnailHeight2 / thumbnail->h);
+			const int height = MIN<int>(kThumbnailHeight2, thumbnail->h * kThumbnailWidth / thumbnail->w);
+			scaled = thumbnail->scale(MAX(width, 1), MAX(height, 1), true);
+			thumbnail = scaled;
+		}
+
+		Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+		if (Graphics::saveThumbnail(data, *thumbnail)) {
+			entry.thumbnail.resize(data.size());
+			memcpy(entry.thumbnail.data(), data.getData(), data.size());
+			entry.thumbnailSize = data.size();
+		}
+
+		if (scaled) {
+			scaled->free();
+			delete scaled;
+		}
+	}
+
+	_entries[filename] = entry;
+	_changed = true;
+}
+
+bool SaveStateIndex::beginUpdate() {
+	if (_updating)
+		return false;
+
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+		it->_value.seen = false;
+
+	_updating = this;
+	return true;
+}
+
+void SaveStateIndex::endUpdate() {
+	assert(_updating == this);
+	_updating = nullptr;
+
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		if (!it->_value.seen) {
+			_entries.erase(it);
+			_changed = true;
+		}
+	}
+
+	if (_changed)
+		save();
+}
+
+void SaveStateIndex::load() {
+	Common::ScopedPtr<Common::InSaveFile> file(g_system->getSavefileManager()->openRawFile(_filename));
+	if (!file)
+		return;
+
+	if (file->readUint32BE() != MKTAG('S', 'I', 'D', 'X') || file->readByte() != SAVE_INDEX_VERSION) {
+		debug(1, "Ignoring %s from a different version", _filename.c_str());
+		return;
+	}
+
+	const uint32 count = file->readUint32LE();
+	const uint32 entriesSize = file->readUint32LE();
+
+	for (uint32 i = 0; i < count && !file->err() && !file->eos(); i++) {
+		const Common::String filename = readString(*file);
+
+		Entry entry;
+		readFingerprint(*file, entry.fingerprint);
+		entry.description = readString(*file);
+		entry.date = file->readUint32LE();
+		entry.time = file->readUint16LE();
+		entry.playtime = file->readUint32LE();
+		entry.isAutosave = file->readByte();
+		entry.thumbnailOffset = kHeaderSize + entriesSize + file->readUint32LE();
+		entry.thumbnailSize = file->readUint32LE();
+		entry.seen = false;
+
+		_entries[filename] = entry;
+	}
+
+	if (file->err() || file->eos()) {
+		warning("Failed to read %s", _filename.c_str());
+		_entries.clear();
+	}
+}
+
+void SaveStateIndex::readThumbnails() {
+	Common::ScopedPtr<Common::InSaveFile> file;
+
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		Entry &entry = it->_value;
+		if (!entry.thumbnailSize || !entry.thumbnail.empty())
+			continue;
+
+		if (!file) {
+			file.reset(g_system->getSavefileManager()->openRawFile(_filename));
+			if (!file)
+				break;
+		}
+
+		entry.thumbnail.resize(entry.thumbnailSize);
+		file->seek(entry.thumbnailOffset + kFingerprintSize);
+		if (file->read(entry.thumbnail.data(), entry.thumbnailSize) != entry.thumbnailSize) {
+			entry.thumbnail.clear();
+			entry.thumbnailSize = 0;
+		}
+	}
+
+	// Thumbnails which could not be read are dropped from the new index
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		if (it->_value.thumbnail.empty())
+			it->_value.thumbnailSize = 0;
+	}
+}
+
+void SaveStateIndex::save() {
+	_changed = false;
+
+	if (_entries.empty()) {
+		Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+		if (saveFileMan->exists(_filename))
+			saveFileMan->removeSavefile(_filename);
+		return;
+	}
+
+	readThumbnails();
+
+	Common::MemoryWriteStreamDynamic entries(DisposeAfterUse::YES);
+	uint32 thumbnailOffset = 0;
+	for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		const Entry &entry = it->_value;
+
+		writeString(entries, it->_key);
+		writeFingerprint(entries, entry.fingerprint);
+		writeString(entries, entry.description);
+		entries.writeUint32LE(entry.date);
+		entries.writeUint16LE(entry.time);
+		entries.writeUint32LE(entry.playtime);
+		entries.writeByte(entry.isAutosave);
+		entries.writeUint32LE(thumbnailOffset);
+		entries.writeUint32LE(entry.thumbnailSize);
+
+		if (entry.thumbnailSize)
+			thumbnailOffset += kFingerprintSize + entry.thumbnailSize;
+	}
+
+	Common::ScopedPtr<Common::OutSaveFile> file(g_system->getSavefileManager()->openForSaving(_filename, false));
+	if (!file) {
+		warning("Failed to open %s for writing", _filename.c_str());
+		return;
+	}
+
+	file->writeUint32BE(MKTAG('S', 'I', 'D', 'X'));
+	file->writeByte(SAVE_INDEX_VERSION);
+	file->writeUint32LE(_entries.size());
+	file->writeUint32LE(entries.size());
+	file->write(entries.getData(), entries.size());
+
+	// The thumbnails follow in the same order as the entries, each preceded
+	// by the fingerprint of its save file, so that thumbnail loaders created
+	// before the index was rewritten can tell that it moved
+	thumbnailOffset = kHeaderSize + entries.size();
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		Entry &entry = it->_value;
+		if (!entry.thumbnailSize)
+			continue;
+
+		writeFingerprint(*file, entry.fingerprint);
+		file->write(entry.thumbnail.data(), entry.thumbnailSize);
+		entry.thumbnailOffset = thumbnailOffset;
+		entry.thumbnail.clear();
+		thumbnailOffset += kFingerprintSize + entry.thumbnailSize;
+	}
+
+	file->finalize();
+	if (file->err())
+		warning("Failed to write %s", _filename.c_str());
+}
@@ -0,0 +1,164 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ENGINES_SAVEINDEX_H
+#define ENGINES_SAVEINDEX_H
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/ptr.h"
+#include "common/str.h"
+
+#include "engines/savestate.h"
+
+struct ExtendedSavegameHeader;
+
+namespace Graphics {
+struct Surface;
+}
+
+/**
+ * @defgroup engines_saveindex Save state index
+ * @ingroup engines
+ *
+ * @brief Cache of the extended headers of the save states of a target.
+ *
+ * @{
+ */
+
+/**
+ * Caches the extended headers of the save files of a target in the save
+ * directory, so that listing the save states does not need to decompress
+ * each save file to reach its header.
+ *
+ * An entry is only used while the save file is unchanged, which is checked
+ * with the size and the last bytes of the raw file. For a compressed save
+ * file these are the checksum and the size of its data. Uncompressed save
+ * files are not indexed, since their last bytes do not identify them, and
+ * their header can be read without decompressing anything.
+ *
+ * The thumbnails are stored uncompressed after the entries, each preceded
+ * by the fingerprint of its save file, and are only read when a save state
+ * descriptor asks for its thumbnail.
+ *
+ * The index is only written by MetaEngine::listSaves(), which sees all the
+ * save files: it records the headers read by querySaveMetaInfos() while it
+ * is being updated, and forgets the save files which are gone. The index
+ * file is removed once no save file is left.
+ */
+class SaveStateIndex {
+public:
+	/** Identifies the contents of a save file. */
+	struct Fingerprint {
+		uint32 size;
+		byte tail[8];
+
+		bool operator==(const Fingerprint &other) const;
+	};
+
+	/** Load the index of @p target, if there is one. */
+	SaveStateIndex(const Common::String &target);
+	~SaveStateIndex();
+
+	/** Return the name of the index file of @p target. */
+	static Common::String getFilename(const Common::String &target);
+
+	/**
+	 * Compute the fingerprint of the save file @p filename. Return false if
+	 * it cannot be opened, or if it is not compressed and thus not indexed.
+	 */
+	static bool getFingerprint(const Common::String &filename, Fingerprint &fingerprint);
+
+	/**
+	 * Return the index which is being updated for @p target, or nullptr if
+	 * there is none.
+	 */
+	static SaveStateIndex *getUpdating(const Common::String &target);
+
+	/**
+	 * Fill @p header, without the thumbnail, from the entry of @p filename
+	 * if it matches @p fingerprint. Return false if there is no such entry.
+	 */
+	bool find(const Common::String &filename, const Fingerprint &fingerprint, ExtendedSavegameHeader &header);
+
+	/**
+	 * Return a loader reading the thumbnail of @p filename from the index
+	 * file, as long as its entry matches @p fingerprint.
+	 */
+	Common::SharedPtr<SaveStateThumbnailLoader> getThumbnailLoader(const Common::String &filename, const Fingerprint &fingerprint) const;
+
+	/**
+	 * Record the header read from the save file @p filename. Its thumbnail
+	 * is copied, and scaled down if it is larger than a save slot button.
+	 */
+	void update(const Common::String &filename, const Fingerprint &fingerprint, const ExtendedSavegameHeader &header);
+
+	/**
+	 * Start recording the headers read by querySaveMetaInfos(). Return false
+	 * if another index is already being updated.
+	 */
+	bool beginUpdate();
+
+	/**
+	 * Stop recording the headers, forget the save files which were not
+	 * queried since beginUpdate(), and write the index if it changed, or
+	 * remove it if no entry is left.
+	 */
+	void endUpdate();
+
+private:
+	struct Entry {
+		Fingerprint fingerprint;
+		Common::String description;
+		uint32 date;
+		uint16 time;
+		uint32 playtime;
+		bool isAutosave;
+
+		// The thumbnail, either in the index file or in memory until the
+		// index is written
+		uint32 thumbnailOffset;
+		uint32 thumbnailSize;
+		Common::Array<byte> thumbnail;
+
+		bool seen;
+	};
+
+	typedef Common::HashMap<Common::String, Entry, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> EntryMap;
+
+	void load();
+	void save();
+
+	/** Read the thumbnails of the file into memory before it is replaced. */
+	void readThumbnails();
+
+	Common::String _target;
+	Common::String _filename;
+	EntryMap _entries;
+	bool _changed;
+
+	static SaveStateIndex *_updating;
+};
+
+/** @} */
+
+#endif
@@ -65,12 +65,29 @@ void SaveStateDescriptor::initSaveSlot(const MetaEngine *metaEngine) {
 }
 
 void SaveStateDescriptor::setThumbnail(Graphics::Surface *t) {
+	_thumbnailLoader.reset();
 	if (_thumbnail.get() == t)
 		return;
 
 	_thumbnail = Common::SharedPtr<Graphics::Surface>(t, Graphics::SurfaceDeleter());
 }
 
+const Graphics::Surface *SaveStateDescriptor::getThumbnail() const {
+	if (_thumbnailLoader) {
+		Graphics::Surface *thumbnail = _thumbnailLoader->loadThumbnail();
+		if (thumbnail)
+			_thumbnail = Common::SharedPtr<Graphics::Surface>(thumbnail, Graphics::SurfaceDeleter());
+		_thumbnailLoader.reset();
+	}
+
+	return _thumbnail.get();
+}
+
+void SaveStateDescriptor::setThumbnailLoader(Common::SharedPtr<SaveStateThumbnailLoader> loader) {
+	_thumbnail.reset();
+	_thumbnailLoader = loader;
+}
+
 void SaveStateDescriptor::setSaveDate(int year, int month, int day) {
 	_saveDate = Common::String::format("%.4d-%.2d-%.2d", year, month, day);
 }
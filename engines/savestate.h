@@ -42,6 +42,21 @@ struct Surface;
  * @{
  */
 
+/**
+ * Loads the thumbnail of a save state when it is first requested, so that
+ * listing the save states does not read the thumbnails of all of them.
+ */
+class SaveStateThumbnailLoader {
+public:
+	virtual ~SaveStateThumbnailLoader() {}
+
+	/**
+	 * Load the thumbnail. Ownership of the surface is transferred to the
+	 * caller. Return nullptr if there is no thumbnail.
+	 */
+	virtual Graphics::Surface *loadThumbnail() const = 0;
+};
+
 /**
  * Object describing a save state.
  *
@@ -134,8 +149,10 @@ public:
 	 * This is usually a scaled down version of the game graphics. The size
 	 * should be either 160x100 or 160x120 pixels, depending on the aspect
 	 * ratio of the game. If another ratio is required, contact the core team.
+	 *
+	 * If a thumbnail loader was set, the thumbnail is loaded by the first call.
 	 */
-	const Graphics::Surface *getThumbnail() const { return _thumbnail.get(); }
+	const Graphics::Surface *getThumbnail() const;
 
 	/**
 	 * Set a thumbnail graphics surface representing the savestate visually.
@@ -143,7 +160,13 @@ public:
 	 * Hence the caller must not delete the surface.
 	 */
 	void setThumbnail(Graphics::Surface *t);
-	void setThumbnail(Common::SharedPtr<Graphics::Surface> t) { _thumbnail = t; }
+	void setThumbnail(Common::SharedPtr<Graphics::Surface> t) { _thumbnail = t; _thumbnailLoader.reset(); }
+
+	/**
+	 * Set a loader for the thumbnail, which is called when the thumbnail is
+	 * first requested by getThumbnail().
+	 */
+	void setThumbnailLoader(Common::SharedPtr<SaveStateThumbnailLoader> loader);
 
 	/**
 	 * Sets the date the save state was created.
@@ -277,7 +300,12 @@ private:
 	/**
 	 * The thumbnail of the save state.
 	 */
-	Common::SharedPtr<Graphics::Surface> _thumbnail;
+	mutable Common::SharedPtr<Graphics::Surface> _thumbnail;
+
+	/**
+	 * The loader of the thumbnail, until it is called.
+	 */
+	mutable Common::SharedPtr<SaveStateThumbnailLoader> _thumbnailLoader;
 
 	/**
 	 * Save file type
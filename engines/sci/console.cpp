@@ -117,6 +117,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
+	registerCmd("resource_bench",		WRAP_METHOD(Console, cmdResourceBench));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
@@ -163,6 +165,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -233,6 +236,9 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("selector_cache",	WRAP_METHOD(Console, cmdSelectorCache));
+	registerCmd("vm_bench",			WRAP_METHOD(Console, cmdVMBench));
+	registerCmd("vmbench",			WRAP_METHOD(Console, cmdVMBench));	// alias
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -357,6 +363,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_types - Shows the valid resource types\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
+	debugPrintf(" resource_cache - Shows the statistics of the resource cache, or sets its size\n");
+	debugPrintf(" resource_bench - Measures the time to load the resources of rooms\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
@@ -398,6 +406,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows the pause times and the objects of the garbage collections\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -447,6 +456,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" selector_cache - Shows the statistics of the selector lookup cache, or turns it on or off\n");
+	debugPrintf(" vm_bench / vmbench - Measures the speed of decoding instructions and looking up selectors\n");
 	debugPrintf(" script_objects / scro - Shows all objects inside a specified script\n");
 	debugPrintf(" script_strings / scrs - Shows all strings inside a specified script\n");
 	debugPrintf(" script_said - Shows all said - strings inside a specified script\n");
@@ -1134,6 +1145,96 @@ bool Console::cmdAllocList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc > 3 || (argc == 2 && strcmp(argv[1], "reset")) || (argc == 3 && strcmp(argv[1], "size"))) {
+		debugPrintf("Shows the statistics of the cache of the resources which are not locked.\n");
+		debugPrintf("Usage: %s [reset | size <kilobytes>]\n", argv[0]);
+		debugPrintf("reset resets the statistics, and size sets the size of the cache.\n");
+		debugPrintf("The size can also be set with the resource_cache_size setting of the game.\n");
+		return true;
+	}
+
+	if (argc == 2)
+		resMan->resetCacheStats();
+	else if (argc == 3)
+		resMan->setCacheBudget(MAX(atoi(argv[2]), 0) * 1024);
+
+	const ResourceManager::CacheStats &stats = resMan->getCacheStats();
+	const uint32 lookups = stats.hits + stats.misses;
+	debugPrintf("Cache: %u resources, %d KB of %d KB, locked resources: %d KB\n", resMan->getCacheEntryCount(),
+	            resMan->getCacheMemory() / 1024, resMan->getCacheBudget() / 1024, resMan->getLockedMemory() / 1024);
+	debugPrintf("Lookups: %u, hits: %u (%u%%), evictions: %u\n", lookups, stats.hits,
+	            lookups ? (uint)((uint64)stats.hits * 100 / lookups) : 0, stats.evictions);
+	debugPrintf("Loaded: %u KB in %u ms\n", stats.loadedBytes / 1024, stats.loadTime);
+	return true;
+}
+
+bool Console::cmdResourceBench(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "help")) {
+		debugPrintf("Measures the time to load the scripts, pictures, views, palettes and sounds\n");
+		debugPrintf("which have the number of a room, for all rooms one after another, and then\n");
+		debugPrintf("once again. The second time shows what the resource cache saves.\n");
+		debugPrintf("Usage: %s [<room number> ...]\n", argv[0]);
+		debugPrintf("If no rooms are given, the numbers of all scripts are used.\n");
+		return true;
+	}
+
+	static const ResourceType roomTypes[] = {
+		kResourceTypeScript, kResourceTypeHeap, kResourceTypePic,
+		kResourceTypeView, kResourceTypePalette, kResourceTypeSound
+	};
+	ResourceManager *resMan = _engine->getResMan();
+
+	Common::Array<uint16> rooms;
+	if (argc > 1) {
+		for (int i = 1; i < argc; i++)
+			rooms.push_back(atoi(argv[i]));
+	} else {
+		Common::List<ResourceId> scripts = resMan->listResources(kResourceTypeScript);
+		Common::sort(scripts.begin(), scripts.end());
+		for (Common::List<ResourceId>::const_iterator it = scripts.begin(); it != scripts.end(); ++it)
+			rooms.push_back(it->getNumber());
+	}
+
+	if (rooms.empty()) {
+		debugPrintf("No rooms to load\n");
+		return true;
+	}
+
+	resMan->freeCachedResources();
+
+	for (int pass = 0; pass < 2; pass++) {
+		const ResourceManager::CacheStats before = resMan->getCacheStats();
+		uint32 totalTime = 0;
+		uint32 maxTime = 0;
+		uint maxRoom = 0;
+
+		for (uint i = 0; i < rooms.size(); i++) {
+			const uint32 startTime = g_system->getMillis();
+			for (uint j = 0; j < ARRAYSIZE(roomTypes); j++)
+				resMan->findResource(ResourceId(roomTypes[j], rooms[i]), false);
+			const uint32 time = g_system->getMillis() - startTime;
+
+			totalTime += time;
+			if (time > maxTime) {
+				maxTime = time;
+				maxRoom = rooms[i];
+			}
+		}
+
+		const ResourceManager::CacheStats &after = resMan->getCacheStats();
+		debugPrintf("%s: %u rooms in %u ms, %u.%02u ms per room, %u ms max (room %u)\n",
+		            pass ? "Loaded again" : "Loaded first", rooms.size(), totalTime,
+		            totalTime / rooms.size(), totalTime * 100 / rooms.size() % 100, maxTime, maxRoom);
+		debugPrintf("  %u resources loaded, %u KB, %u found in the cache\n", after.misses - before.misses,
+		            (after.loadedBytes - before.loadedBytes) / 1024, after.hits - before.hits);
+	}
+
+	return true;
+}
+
 bool Console::cmdDissectScript(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Examines a script\n");
@@ -2828,6 +2929,26 @@ bool Console::cmdGCInvoke(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	GCStats &stats = _engine->_gamestate->gcStats;
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows the pause times and the objects of the garbage collections.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2)
+		stats.reset();
+
+	debugPrintf("Collections: %u, pause times: %u ms last, %u ms max, %u ms mean\n", stats.cycles,
+	            stats.lastPauseTime, stats.maxPauseTime, stats.cycles ? stats.totalPauseTime / stats.cycles : 0);
+	debugPrintf("Last collection: %u live objects, %u unreachable objects, %u bytes freed\n",
+	            stats.lastLiveObjects, stats.lastUnreachable, stats.lastFreedBytes);
+	debugPrintf("Bytes freed by all collections: %u KB\n", (uint)(stats.totalFreedBytes / 1024));
+	return true;
+}
+
 bool Console::cmdGCObjects(int argc, const char **argv) {
 	AddrSet *use_map = findAllActiveReferences(_engine->_gamestate);
 
@@ -3436,6 +3557,170 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	SelectorLookupCache &cache = _engine->_gamestate->_segMan->getSelectorLookupCache();
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "on") && strcmp(argv[1], "off") && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows the statistics of the cache of selector lookups in classes.\n");
+		debugPrintf("Usage: %s [on | off | reset]\n", argv[0]);
+		debugPrintf("on/off turns the cache on or off, for comparing the speed of the scripts,\n");
+		debugPrintf("and reset resets the statistics\n");
+		return true;
+	}
+
+	if (argc == 2) {
+		if (!strcmp(argv[1], "reset"))
+			cache.resetStats();
+		else
+			cache.setEnabled(!strcmp(argv[1], "on"));
+	}
+
+	const uint32 lookups = cache.getHits() + cache.getMisses();
+	debugPrintf("Selector lookup cache: %s\n", cache.isEnabled() ? "on" : "off");
+	debugPrintf("Lookups: %u, hits: %u (%u%%), flushes: %u\n", lookups, cache.getHits(),
+	            lookups ? (uint)((uint64)cache.getHits() * 100 / lookups) : 0, cache.getFlushes());
+	return true;
+}
+
+bool Console::cmdVMBench(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Measures the speed of decoding the instructions and of looking up the selectors\n");
+		debugPrintf("of all loaded scripts, with and without the caches of the VM.\n");
+		debugPrintf("Usage: %s [<milliseconds per test>]\n", argv[0]);
+		return true;
+	}
+
+	const uint32 duration = argc == 2 ? MAX(atoi(argv[1]), 1) : 500;
+	SegManager *segMan = _engine->_gamestate->_segMan;
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+
+	struct ScriptInstructions {
+		Script *script;
+		Common::Array<uint32> offsets;
+	};
+	struct SelectorUse {
+		reg_t obj;
+		Selector selector;
+	};
+	Common::Array<ScriptInstructions> scripts;
+	Common::Array<SelectorUse> selectorUses;
+	uint instructionCount = 0;
+	uint methodCount = 0;
+
+	// Gather the instructions of the methods of all objects, the same way
+	// as the kernel function calls are searched, and the properties and
+	// methods which the objects have
+	for (SegmentId segmentId = 0; segmentId < segMan->_heap.size(); segmentId++) {
+		SegmentObj *segmentObj = segMan->_heap[segmentId];
+		if (!segmentObj || segmentObj->getType() != SEG_TYPE_SCRIPT)
+			continue;
+
+		Script *script = (Script *)segmentObj;
+		scripts.push_back(ScriptInstructions());
+		ScriptInstructions &instructions = scripts.back();
+		instructions.script = script;
+
+		const ObjMap &objects = script->getObjectMap();
+		for (ObjMap::const_iterator it = objects.begin(); it != objects.end(); ++it) {
+			const Object &obj = it->_value;
+
+			if (getSciVersion() < SCI_VERSION_3) {
+				for (uint i = 0; i < obj.getVarCount(); i++) {
+					SelectorUse use = { obj.getPos(), obj.getVarSelector(i) };
+					selectorUses.push_back(use);
+				}
+			}
+
+			for (uint16 i = 0; i < obj.getMethodCount(); i++) {
+				SelectorUse use = { obj.getPos(), obj.getFuncSelector(i) };
+				selectorUses.push_back(use);
+				methodCount++;
+
+				uint32 offset = obj.getFunction(i).getOffset();
+				uint32 maxJmpOffset = 0;
+				while (offset < script->getBufSize()) {
+					int16 opparams[4];
+					byte extOpcode;
+					instructions.offsets.push_back(offset);
+					offset += readPMachineInstruction(script->getBuf(offset), extOpcode, opparams);
+					const byte opcode = extOpcode >> 1;
+
+					if (opcode == op_bt || opcode == op_bnt || opcode == op_jmp) {
+						const uint32 jmpOffset = (uint16)(offset + opparams[0]);
+						if (jmpOffset > maxJmpOffset && jmpOffset < script->getScriptSize())
+							maxJmpOffset = jmpOffset;
+					}
+					if (opcode == op_ret && offset >= maxJmpOffset)
+						break;
+				}
+			}
+		}
+		instructionCount += instructions.offsets.size();
+	}
+
+	if (!instructionCount) {
+		debugPrintf("No script code is loaded\n");
+		return true;
+	}
+
+	uint32 passes = 0;
+	uint32 elapsed;
+	uint32 decodedSize = 0;
+	uint32 start = g_system->getMillis();
+	do {
+		for (uint i = 0; i < scripts.size(); i++) {
+			const Script *script = scripts[i].script;
+			const Common::Array<uint32> &offsets = scripts[i].offsets;
+			for (uint j = 0; j < offsets.size(); j++) {
+				int16 opparams[4];
+				byte extOpcode;
+				decodedSize += readPMachineInstruction(script->getBuf(offsets[j]), extOpcode, opparams);
+			}
+		}
+		passes++;
+	} while ((elapsed = g_system->getMillis() - start) < duration);
+	const uint64 decodeRate = (uint64)passes * instructionCount / elapsed;
+	decodedSize /= passes;
+
+	passes = 0;
+	uint32 cachedSize = 0;
+	start = g_system->getMillis();
+	do {
+		for (uint i = 0; i < scripts.size(); i++) {
+			Script *script = scripts[i].script;
+			const Common::Array<uint32> &offsets = scripts[i].offsets;
+			for (uint j = 0; j < offsets.size(); j++)
+				cachedSize += script->getInstruction(offsets[j]).size;
+		}
+		passes++;
+	} while ((elapsed = g_system->getMillis() - start) < duration);
+	const uint64 cachedRate = (uint64)passes * instructionCount / elapsed;
+	cachedSize /= passes;
+
+	debugPrintf("%u instructions in %u methods of %u scripts\n", instructionCount, methodCount, scripts.size());
+	debugPrintf("Decoding: %u instructions/ms\n", (uint)decodeRate);
+	debugPrintf("Decoded before: %u instructions/ms%s\n", (uint)cachedRate,
+	            decodedSize != cachedSize ? " (MISMATCH)" : "");
+
+	const bool cacheEnabled = cache.isEnabled();
+	for (int enabled = 0; enabled < 2; enabled++) {
+		cache.setEnabled(enabled);
+		passes = 0;
+		start = g_system->getMillis();
+		do {
+			for (uint i = 0; i < selectorUses.size(); i++)
+				lookupSelector(segMan, selectorUses[i].obj, selectorUses[i].selector, nullptr, nullptr);
+			passes++;
+		} while ((elapsed = g_system->getMillis() - start) < duration);
+
+		debugPrintf("Selector lookups, %s: %u lookups/ms\n", enabled ? "cached" : "not cached",
+		            (uint)((uint64)passes * selectorUses.size() / elapsed));
+	}
+	cache.setEnabled(cacheEnabled);
+
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("Shows all objects inside a specified script.\n");
@@ -21,6 +21,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -49,16 +50,33 @@ const char *segmentTypeNames[] = {
 };
 #endif
 
+WorklistManager::WorklistManager(const Common::Array<SegmentObj *> &heap) : _tableMarks(heap.size()) {
+	for (uint i = 1; i < heap.size(); i++) {
+		if (heap[i])
+			_tableMarks[i].resize(heap[i]->getTableSize(), false);
+	}
+}
+
 void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
 		return;
 
 	debugC(kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
 
-	if (_map.contains(reg))
-		return; // already dealt with it
+	const SegmentId segment = reg.getSegment();
+	if (isTableSegment(segment) && reg.getOffset() < _tableMarks[segment].size()) {
+		// Table entries are their own canonic addresses
+		bool &marked = _tableMarks[segment][reg.getOffset()];
+		if (marked)
+			return; // already dealt with it
+
+		marked = true;
+	} else {
+		if (_map.contains(reg))
+			return; // already dealt with it
 
-	_map.setVal(reg, true);
+		_map.setVal(reg, true);
+	}
 	_worklist.push_back(reg);
 }
 
@@ -98,11 +116,9 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void markAllActiveReferences(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -174,8 +190,22 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
+}
 
-	return normalizeAddresses(s->_segMan, wm._map);
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm(s->_segMan->getSegments());
+	markAllActiveReferences(s, wm);
+
+	AddrSet *activeRefs = normalizeAddresses(s->_segMan, wm._map);
+	for (uint seg = 1; seg < wm._tableMarks.size(); seg++) {
+		const Common::Array<bool> &marks = wm._tableMarks[seg];
+		for (uint i = 0; i < marks.size(); i++) {
+			if (marks[i])
+				activeRefs->setVal(make_reg(seg, i), true);
+		}
+	}
+
+	return activeRefs;
 }
 
 void run_gc(EngineState *s) {
@@ -190,12 +220,19 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
+	const uint32 startTime = g_system->getMillis();
+	uint32 liveObjects = 0;
+	uint32 unreachable = 0;
+	uint32 freedBytes = 0;
+
 	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	WorklistManager wm(heap);
+	markAllActiveReferences(s, wm);
+	AddrSet *activeRefs = normalizeAddresses(segMan, wm._map);
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
-	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
 	for (uint seg = 1; seg < heap.size(); seg++) {
 		SegmentObj *mobj = heap[seg];
 
@@ -207,11 +244,16 @@ void run_gc(EngineState *s) {
 
 			// Get a list of all deallocatable objects in this segment,
 			// then free any which are not referenced from somewhere.
+			const bool isTable = wm.isTableSegment(seg);
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (isTable ? wm.isTableEntryMarked(addr) : activeRefs->contains(addr)) {
+					liveObjects++;
+				} else {
 					// Not found -> we can free it
+					unreachable++;
+					freedBytes += mobj->getAllocatedSize(addr);
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
 #ifdef GC_DEBUG_CODE
@@ -225,6 +267,18 @@ void run_gc(EngineState *s) {
 
 	delete activeRefs;
 
+	GCStats &stats = s->gcStats;
+	stats.cycles++;
+	stats.lastPauseTime = g_system->getMillis() - startTime;
+	stats.maxPauseTime = MAX(stats.maxPauseTime, stats.lastPauseTime);
+	stats.totalPauseTime += stats.lastPauseTime;
+	stats.lastLiveObjects = liveObjects;
+	stats.lastUnreachable = unreachable;
+	stats.lastFreedBytes = freedBytes;
+	stats.totalFreedBytes += freedBytes;
+	debugC(kDebugLevelGC, "[GC] Done in %u ms: %u live objects, %u unreachable objects, %u bytes freed",
+	       stats.lastPauseTime, liveObjects, unreachable, freedBytes);
+
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
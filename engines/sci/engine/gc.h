@@ -57,9 +57,23 @@ void run_gc(EngineState *s);
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
+	// The reached entries of the table segments, which are far more numerous
+	// than the other addresses, and are marked here instead of in _map
+	Common::Array<Common::Array<bool> > _tableMarks;
+
+	WorklistManager(const Common::Array<SegmentObj *> &heap);
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
+
+	bool isTableSegment(SegmentId segment) const {
+		return segment < _tableMarks.size() && !_tableMarks[segment].empty();
+	}
+
+	/** Whether an entry of a table segment has been reached */
+	bool isTableEntryMarked(reg_t reg) const {
+		return reg.getOffset() < _tableMarks[reg.getSegment()].size() && _tableMarks[reg.getSegment()][reg.getOffset()];
+	}
 };
 
 
@@ -336,6 +336,9 @@ void SegManager::saveLoadWithSerializer(Common::Serializer &s) {
 #endif
 			}
 		}
+
+		// Forget any lookups made while the classes were being restored
+		_selectorLookupCache.flush();
 	}
 }
 
@@ -74,6 +74,29 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_instructionIndex.clear();
+	_instructions.clear();
+}
+
+const DecodedInstruction &Script::decodeInstruction(uint32 offset) {
+	// The buffer is final by now, as scripts are only run after they have
+	// been loaded and patched
+	if (_instructionIndex.empty())
+		_instructionIndex.resize(_buf->size());
+
+	DecodedInstruction instruction;
+	instruction.size = readPMachineInstruction(getBuf(offset), instruction.extOpcode, instruction.params);
+
+	// The index cannot refer to more instructions, which no actual script has
+	if (offset >= _instructionIndex.size() || _instructions.size() >= 0xFFFF) {
+		_uncachedInstruction = instruction;
+		return _uncachedInstruction;
+	}
+
+	_instructions.push_back(instruction);
+	_instructionIndex[offset] = _instructions.size();
+	return _instructions.back();
 }
 
 enum {
@@ -1195,6 +1218,11 @@ void Script::freeAtAddress(SegManager *segMan, reg_t addr) {
 		segMan->deallocateScript(_nr);
 }
 
+uint32 Script::getAllocatedSize(reg_t addr) const {
+	// Only scripts which are marked as deleted are freed
+	return _markedAsDeleted ? _buf->size() : 0;
+}
+
 Common::Array<reg_t> Script::listAllDeallocatable(SegmentId segId) const {
 	const reg_t r = make_reg(segId, 0);
 	return Common::Array<reg_t>(&r, 1);
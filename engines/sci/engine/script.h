@@ -68,6 +68,15 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/**
+ * An instruction of the script code, as decoded by readPMachineInstruction().
+ */
+struct DecodedInstruction {
+	byte extOpcode;     // the opcode, including the lower bit which selects byte operands
+	uint16 size;        // size of the instruction in the script buffer
+	int16 params[4];    // the operands, read with their actual widths
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -93,6 +102,10 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	Common::Array<uint16> _instructionIndex; /**< Index + 1 of the decoded instruction at each offset, or 0 */
+	Common::Array<DecodedInstruction> _instructions; /**< The instructions decoded so far */
+	DecodedInstruction _uncachedInstruction;
+
 protected:
 	offsetLookupArrayType _offsetLookupArray; // Table of all elements of currently loaded script, that may get pointed to
 
@@ -131,6 +144,22 @@ public:
 		return _buf->getUint16SEAt(offset + SCRIPT_OBJECT_MAGIC_OFFSET) == SCRIPT_OBJECT_MAGIC_NUMBER;
 	}
 
+	/**
+	 * Returns the instruction at the given offset of the script buffer. Each
+	 * instruction is only decoded when it is run for the first time, the
+	 * decoded instructions are kept until the script is freed. The returned
+	 * reference is only valid until the next call.
+	 */
+	const DecodedInstruction &getInstruction(uint32 offset) {
+		const uint16 index = offset < _instructionIndex.size() ? _instructionIndex[offset] : 0;
+		if (index)
+			return _instructions[index - 1];
+		return decodeInstruction(offset);
+	}
+
+	/** Returns the number of instructions decoded so far. */
+	uint getDecodedInstructionCount() const { return _instructions.size(); }
+
 public:
 	Script();
 	~Script() override;
@@ -142,6 +171,7 @@ public:
 	SegmentRef dereference(reg_t pointer) override;
 	reg_t findCanonicAddress(SegManager *segMan, reg_t sub_addr) const override;
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override;
+	uint32 getAllocatedSize(reg_t addr) const override;
 	Common::Array<reg_t> listAllDeallocatable(SegmentId segId) const override;
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
@@ -360,6 +390,12 @@ private:
 
 	LocalVariables *allocLocalsSegment(SegManager *segMan);
 
+	/**
+	 * Decodes the instruction at the given offset, and keeps it for
+	 * getInstruction()
+	 */
+	const DecodedInstruction &decodeInstruction(uint32 offset);
+
 	/**
 	 * Identifies certain offsets within script data and set up lookup-table
 	 */
@@ -29,6 +29,34 @@
 
 namespace Sci {
 
+SelectorLookupCache::SelectorLookupCache() : _enabled(true) {
+	flush();
+	resetStats();
+}
+
+void SelectorLookupCache::add(reg_t classPos, Selector selector, bool methods, int varIndex, reg_t func) {
+	if (!_enabled)
+		return;
+
+	Entry &entry = _entries[getIndex(classPos, selector, methods)];
+	entry.classPos = classPos;
+	entry.selector = selector;
+	entry.methods = methods;
+	entry.varIndex = varIndex;
+	entry.func = func;
+}
+
+void SelectorLookupCache::flush() {
+	// No class lives in the uninitialized segment
+	for (uint i = 0; i < kNumEntries; i++)
+		_entries[i].classPos = make_reg(kUninitializedSegment, 0);
+	++_flushes;
+}
+
+void SelectorLookupCache::setEnabled(bool enabled) {
+	flush();
+	_enabled = enabled;
+}
 
 SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
@@ -165,6 +193,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.flush();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -1099,6 +1128,9 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 		scr = allocateScript(scriptNum, segmentId);
 	}
 
+	// The classes of the script replace any freed ones at the same addresses
+	_selectorLookupCache.flush();
+
 	scr->load(scriptNum, _resMan, _scriptPatcher, applyScriptPatches);
 	scr->initializeLocals(this);
 	scr->initializeObjects(this, segmentId, applyScriptPatches);
@@ -45,6 +45,70 @@ enum ScriptLoadType {
 
 class Script;
 
+/**
+ * Cache of the selector lookups in classes, so that sending a message does not
+ * have to search the property and method tables of a class and its
+ * superclasses every time. Classes are only freed along with their script, so
+ * the cache is flushed whenever a script is loaded or freed.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		reg_t classPos;
+		Selector selector;
+		bool methods;
+		int varIndex;	///< Index of the property, or -1
+		reg_t func;		///< Address of the method, or NULL_REG
+	};
+
+	SelectorLookupCache();
+
+	/**
+	 * Find a cached lookup of a selector, either among the properties of a
+	 * class or among the methods of a class and its superclasses.
+	 * @return the lookup, or nullptr if it is not cached
+	 */
+	const Entry *find(reg_t classPos, Selector selector, bool methods) {
+		Entry &entry = _entries[getIndex(classPos, selector, methods)];
+		if (entry.classPos == classPos && entry.selector == selector && entry.methods == methods) {
+			++_hits;
+			return &entry;
+		}
+		++_misses;
+		return nullptr;
+	}
+
+	void add(reg_t classPos, Selector selector, bool methods, int varIndex, reg_t func);
+
+	/** Forget all lookups, when a class may have been freed or loaded. */
+	void flush();
+
+	bool isEnabled() const { return _enabled; }
+	void setEnabled(bool enabled);
+
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+	uint32 getFlushes() const { return _flushes; }
+	void resetStats() { _hits = _misses = _flushes = 0; }
+
+private:
+	enum {
+		kNumEntries = 2048
+	};
+
+	static uint getIndex(reg_t classPos, Selector selector, bool methods) {
+		// Only hashing, so the raw fields will do
+		const uint32 key = (classPos._segment << 16 | classPos._offset) * 0x9E3779B1 + (selector << 1 | methods) * 0x85EBCA77;
+		return key >> 21;
+	}
+
+	Entry _entries[kNumEntries];
+	bool _enabled;
+	uint32 _hits;
+	uint32 _misses;
+	uint32 _flushes;
+};
+
 class SegManager : public Common::Serializable {
 	friend class Console;
 public:
@@ -460,8 +524,11 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
 private:
 	Common::Array<SegmentObj *> _heap;
+	SelectorLookupCache _selectorLookupCache;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
 	Common::HashMap<int, SegmentId> _scriptSegMap;
@@ -126,6 +126,10 @@ void CloneTable::freeAtAddress(SegManager *segMan, reg_t addr) {
 	freeEntry(addr.getOffset());
 }
 
+uint32 CloneTable::getAllocatedSize(reg_t addr) const {
+	return sizeof(Clone) + at(addr.getOffset()).getVarCount() * sizeof(reg_t);
+}
+
 
 //-------------------- locals --------------------
 
@@ -122,6 +122,21 @@ public:
 	 */
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr) {}
 
+	/**
+	 * Returns the number of bytes which freeAtAddress() releases for the
+	 * specified address. Used by the garbage collector for its statistics.
+	 * @param addr		address (within the given segment) of the object
+	 */
+	virtual uint32 getAllocatedSize(reg_t addr) const { return 0; }
+
+	/**
+	 * Returns the number of entries, if the segment is a table whose objects
+	 * are addressed by their index. Used by the garbage collector, which
+	 * marks the reachable table entries in a bit set rather than a hash map.
+	 * @return the number of entries, or 0 if the segment is not a table
+	 */
+	virtual uint getTableSize() const { return 0; }
+
 	/**
 	 * Iterates over and reports all addresses within the segment.
 	 * Used by the garbage collector.
@@ -304,6 +319,7 @@ public:
 	}
 
 	uint size() const { return _table.size(); }
+	uint getTableSize() const override { return _table.size(); }
 
 	T &at(uint index) { return *_table[index].data; }
 	const T &at(uint index) const { return *_table[index].data; }
@@ -318,6 +334,7 @@ struct CloneTable : public SegmentObjTable<Clone> {
 	CloneTable() : SegmentObjTable<Clone>(SEG_TYPE_CLONES) {}
 
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override;
+	uint32 getAllocatedSize(reg_t addr) const override;
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
@@ -331,6 +348,9 @@ struct NodeTable : public SegmentObjTable<Node> {
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override {
 		freeEntry(sub_addr.getOffset());
 	}
+	uint32 getAllocatedSize(reg_t addr) const override {
+		return sizeof(Node);
+	}
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
@@ -344,6 +364,9 @@ struct ListTable : public SegmentObjTable<List> {
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override {
 		freeEntry(sub_addr.getOffset());
 	}
+	uint32 getAllocatedSize(reg_t addr) const override {
+		return sizeof(List);
+	}
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
@@ -373,6 +396,9 @@ struct HunkTable : public SegmentObjTable<Hunk> {
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override {
 		freeEntry(sub_addr.getOffset());
 	}
+	uint32 getAllocatedSize(reg_t addr) const override {
+		return sizeof(Hunk) + at(addr.getOffset()).size;
+	}
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
 };
@@ -336,7 +336,25 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x", PRINT_REG(obj_location));
 	}
 
-	int index = obj->locateVarSelector(segMan, selectorId);
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	int index;
+
+	// The properties are those of the class which locateVarSelector() looks
+	// them up in, except in SCI3 where each object has its own list. This is
+	// not the species, which kClone sets to the address of the clone itself,
+	// and clone slots are reused by clones of other classes.
+	if (!cache.isEnabled() || getSciVersion() == SCI_VERSION_3) {
+		index = obj->locateVarSelector(segMan, selectorId);
+	} else {
+		const reg_t classPos = obj->isClass() ? obj->getPos() : obj->getSuperClassSelector();
+		const SelectorLookupCache::Entry *lookup = cache.find(classPos, selectorId, false);
+		if (lookup) {
+			index = lookup->varIndex;
+		} else {
+			index = obj->locateVarSelector(segMan, selectorId);
+			cache.add(classPos, selectorId, false, index, NULL_REG);
+		}
+	}
 
 	if (index >= 0) {
 		// Found it as a variable
@@ -345,22 +363,44 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 			varp->varindex = index;
 		}
 		return kSelectorVariable;
+	}
+
+	// Check if it's a method of the object itself, which may differ from the
+	// methods of its class
+	index = obj->funcSelectorPosition(selectorId);
+	if (index >= 0) {
+		if (fptr)
+			*fptr = obj->getFunction(index);
+
+		return kSelectorMethod;
+	}
+
+	// Otherwise, look it up recursively in the superclasses
+	const reg_t superClassPos = obj->getSuperClassSelector();
+	const SelectorLookupCache::Entry *lookup = cache.isEnabled() ? cache.find(superClassPos, selectorId, true) : nullptr;
+	reg_t func = NULL_REG;
+	if (lookup) {
+		func = lookup->func;
 	} else {
-		// Check if it's a method, with recursive lookup in superclasses
+		obj = segMan->getObject(superClassPos);
 		while (obj) {
 			index = obj->funcSelectorPosition(selectorId);
 			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
+				func = obj->getFunction(index);
+				break;
 			} else {
 				obj = segMan->getObject(obj->getSuperClassSelector());
 			}
 		}
+		cache.add(superClassPos, selectorId, true, -1, func);
+	}
 
+	if (func.isNull())
 		return kSelectorNone;
-	}
+
+	if (fptr)
+		*fptr = func;
+	return kSelectorMethod;
 }
 
 } // End of namespace Sci
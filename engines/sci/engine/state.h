@@ -97,6 +97,27 @@ struct SciCallOrigin {
 	}
 };
 
+/**
+ * Statistics of the garbage collector, which stops the scripts while it runs.
+ */
+struct GCStats {
+	uint32 cycles;             /**< Number of collections */
+	uint32 lastPauseTime;      /**< Duration of the last collection, in milliseconds */
+	uint32 maxPauseTime;       /**< Duration of the longest collection, in milliseconds */
+	uint32 totalPauseTime;     /**< Duration of all collections, in milliseconds */
+	uint32 lastLiveObjects;    /**< Objects which were reachable in the last collection */
+	uint32 lastUnreachable;    /**< Objects which were unreachable in the last collection */
+	uint32 lastFreedBytes;     /**< Bytes freed by the last collection */
+	uint64 totalFreedBytes;    /**< Bytes freed by all collections */
+
+	GCStats() { reset(); }
+	void reset() {
+		cycles = lastPauseTime = maxPauseTime = totalPauseTime = 0;
+		lastLiveObjects = lastUnreachable = lastFreedBytes = 0;
+		totalFreedBytes = 0;
+	}
+};
+
 struct EngineState : public Common::Serializable {
 	EngineState(SegManager *segMan);
 	~EngineState() override;
@@ -188,6 +209,7 @@ struct EngineState : public Common::Serializable {
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStats gcStats;
 
 	MessageState *_msgState;
 	void initMessageState();
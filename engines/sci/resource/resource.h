@@ -309,6 +309,7 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	Common::List<Resource *>::iterator _lruPosition; /**< Position in the LRU list, if enqueued */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -380,6 +381,41 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Statistics of the cache of the resources which are not locked.
+	 */
+	struct CacheStats {
+		uint32 hits;        ///< Resources found loaded already
+		uint32 misses;      ///< Resources which had to be loaded
+		uint32 evictions;   ///< Resources freed to stay within the budget
+		uint32 loadTime;    ///< Time spent reading and decompressing, in milliseconds
+		uint32 loadedBytes; ///< Size of the loaded resources
+
+		CacheStats() { reset(); }
+		void reset() { hits = misses = evictions = loadTime = loadedBytes = 0; }
+	};
+
+	const CacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats() { _cacheStats.reset(); }
+
+	/** Returns the number of bytes of the resources which are not locked that are kept. */
+	int getCacheBudget() const { return _maxMemoryLRU; }
+
+	/**
+	 * Sets the number of bytes of the resources which are not locked that
+	 * are kept, freeing the least recently used ones which exceed it.
+	 */
+	void setCacheBudget(int bytes);
+
+	int getCacheMemory() const { return _memoryLRU; }
+	int getLockedMemory() const { return _memoryLocked; }
+	uint getCacheEntryCount() const { return _LRU.size(); }
+
+	/**
+	 * Frees all resources which are not locked.
+	 */
+	void freeCachedResources();
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -502,6 +538,7 @@ protected:
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	CacheStats _cacheStats;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
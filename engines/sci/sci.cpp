@@ -22,6 +22,7 @@
 #include "common/system.h"
 #include "common/config-manager.h"
 #include "common/debug-channels.h"
+#include "common/savefile.h"
 #include "common/translation.h"
 
 #include "engines/advancedDetector.h"
@@ -397,6 +398,7 @@ Common::Error SciEngine::run() {
 	_guestAdditions->syncAudioOptionsFromScummVM();
 	_guestAdditions->patchGameSaveRestore();
 	setLauncherLanguage();
+	setSaveCompressionDictionary();
 
 	// Check whether loading a savestate was requested
 	int directSaveSlotLoading = ConfMan.getInt("save_slot");
@@ -978,6 +980,22 @@ void SciEngine::sleep(uint32 msecs) {
 	}
 }
 
+void SciEngine::setSaveCompressionDictionary() {
+	// Saves hold the string heaps of the loaded scripts verbatim, see
+	// Script::syncStringHeap(), and the main game script is loaded in all
+	// of them. SCI3 scripts are saved differently.
+	if (getSciVersion() > SCI_VERSION_2_1_LATE)
+		return;
+
+	const ResourceType type = getSciVersion() >= SCI_VERSION_1_1 ? kResourceTypeHeap : kResourceTypeScript;
+	Resource *res = _resMan->findResource(ResourceId(type, 0), true);
+	if (!res)
+		return;
+
+	_saveFileMan->setCompressionDictionary(res->getUnsafeDataAt(0), res->size());
+	_resMan->unlockResource(res);
+}
+
 void SciEngine::setLauncherLanguage() {
 	if (_gameDescription->flags & ADGF_ADDENGLISH) {
 		// If game is multilingual
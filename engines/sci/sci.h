@@ -404,6 +404,13 @@ private:
 	 */
 	void setLauncherLanguage();
 
+	/**
+	 * Set the dictionary which saves compressed with LZ4 refer to. It is
+	 * made from the data of the main game script, so it is the same in
+	 * every session.
+	 */
+	void setSaveCompressionDictionary();
+
 	const ADGameDescription *_gameDescription;
 	const SciGameId _gameId;
 	ResourceManager *_resMan; /**< The resource manager */
@@ -215,6 +215,11 @@ bool BaseImage::getImageInfoJPG(const Common::String &filename, int32 &width, in
 bool BaseImage::loadFile(const Common::String &filename) {
 	_filename = filename;
 	_filename.toLowercase();
+
+	// Save game thumbnails change, so they cannot be cached
+	const bool cacheable = !filename.hasPrefix("savegame:");
+	Graphics::PixelFormat requestedFormat;
+
 	if (filename.hasPrefix("savegame:") || _filename.hasSuffix(".bmp")) {
 		_decoder = new Image::BitmapDecoder();
 	} else if (_filename.hasSuffix(".png")) {
@@ -225,17 +230,34 @@ bool BaseImage::loadFile(const Common::String &filename) {
 			debug(2, "BaseImage::loadFile : Buggy PNG bitmap %s, skipping...", filename.c_str());
 			return false;
 		}
-		_decoder = new Image::PNGDecoder();
+		Image::PNGDecoder *png = new Image::PNGDecoder();
+		// Only formats with alpha keep the transparency of the image
+		const Graphics::PixelFormat rendererFormat = BaseEngine::getRenderer()->getPixelFormat();
+		if (rendererFormat.aBits() > 0 && png->setOutputPixelFormat(rendererFormat))
+			requestedFormat = rendererFormat;
+		_decoder = png;
 	} else if (_filename.hasSuffix(".tga")) {
 		_decoder = new Image::TGADecoder();
 	} else if (_filename.hasSuffix(".jpg")) {
 		Image::JPEGDecoder *jpeg = new Image::JPEGDecoder();
-		jpeg->setOutputPixelFormat(BaseEngine::getRenderer()->getPixelFormat());
+		requestedFormat = BaseEngine::getRenderer()->getPixelFormat();
+		jpeg->setOutputPixelFormat(requestedFormat);
 		_decoder = jpeg;
 	} else {
 		warning("BaseImage::loadFile : Unsupported fileformat %s", filename.c_str());
 	}
 	_filename = filename;
+
+	if (cacheable) {
+		_cachedSurface = Image::ImageCache::instance().get(Common::Path(filename), requestedFormat);
+		if (_cachedSurface) {
+			_surface = _cachedSurface.get();
+			_palette = nullptr;
+			_paletteCount = 0;
+			return true;
+		}
+	}
+
 	Common::SeekableReadStream *file = _fileManager->openFile(filename);
 	if (!file) {
 		return false;
@@ -247,6 +269,17 @@ bool BaseImage::loadFile(const Common::String &filename) {
 	_paletteCount = _decoder->getPalette().size();
 	_fileManager->closeFile(file);
 
+	if (cacheable && _surface) {
+		// Hand the decoded surface over to the cache instead of copying
+		// it, when the decoder allows it
+		if (Graphics::Surface *decoded = _decoder->releaseSurface()) {
+			_cachedSurface = Image::ImageCache::instance().put(Common::Path(filename), requestedFormat, decoded);
+			_surface = _cachedSurface.get();
+		} else {
+			_cachedSurface = Image::ImageCache::instance().put(Common::Path(filename), requestedFormat, *_surface);
+		}
+	}
+
 	return true;
 }
 
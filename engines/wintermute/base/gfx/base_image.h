@@ -35,6 +35,8 @@
 #include "common/str.h"
 #include "common/stream.h"
 
+#include "image/image_cache.h"
+
 namespace Image {
 class ImageDecoder;
 }
@@ -67,6 +69,7 @@ private:
 	Image::ImageDecoder *_decoder;
 	const Graphics::Surface *_surface;
 	Graphics::Surface *_deletableSurface;
+	Image::ImageCache::SurfacePtr _cachedSurface;
 	const byte *_palette;
 	uint16 _paletteCount;
 	BaseFileManager *_fileManager;
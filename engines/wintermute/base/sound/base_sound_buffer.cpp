@@ -36,6 +36,7 @@
 
 #include "audio/audiostream.h"
 #include "audio/mixer.h"
+#include "audio/sound_cache.h"
 #ifdef USE_VORBIS
 #include "audio/decoders/vorbis.h"
 #endif
@@ -99,17 +100,30 @@ bool BaseSoundBuffer::loadFromFile(const char *filename, bool forceReload) {
 	}
 	SAFE_DELETE(_stream);
 
+	Common::String strFilename(filename);
+	strFilename.toLowercase();
+
+	// Sound effects are short and often repeated, so keep them decoded
+	const bool cacheable = _type == TSoundType::SOUND_SFX && strFilename.hasSuffix(".ogg");
+	if (cacheable) {
+		_stream = Audio::SoundCache::instance().get(Common::Path(filename));
+		if (_stream) {
+			BaseUtils::setString(&_filename, filename);
+			return STATUS_OK;
+		}
+	}
+
 	// Load a file, but avoid having the File-manager handle the disposal of it.
 	Common::SeekableReadStream *file = _game->_fileManager->openFile(filename, true, false);
 	if (!file) {
 		_game->LOG(0, "Error opening sound file '%s'", filename);
 		return STATUS_FAILED;
 	}
-	Common::String strFilename(filename);
-	strFilename.toLowercase();
 	if (strFilename.hasSuffix(".ogg")) {
 #ifdef USE_VORBIS
 		_stream = Audio::makeVorbisStream(file, DisposeAfterUse::YES);
+		if (cacheable)
+			_stream = Audio::SoundCache::instance().put(Common::Path(filename), 0, _stream);
 #else
 		error("BSoundBuffer::loadFromFile - Ogg Vorbis not supported by this version of ScummVM (please report as this shouldn't trigger)");
 #endif
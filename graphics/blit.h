@@ -274,6 +274,30 @@ void fastBlitNEON_XRGB1555_RGB565(byte *, const byte *, const uint, const uint,
  */
 FastBlitFunc getFastBlitFunc(const PixelFormat &dstFmt, const PixelFormat &srcFmt);
 
+typedef void (*FastBlitMapFunc)(byte *, const byte *, const uint, const uint, const uint, const uint, const uint32 *);
+
+#ifdef SCUMMVM_SSE2
+// Fast palette expansion functions for x86 SSE2
+void fastBlitMapSSE2_16(byte *, const byte *, const uint, const uint, const uint, const uint, const uint32 *);
+void fastBlitMapSSE2_32(byte *, const byte *, const uint, const uint, const uint, const uint, const uint32 *);
+#endif
+
+/**
+ * Look up optimised routines for expanding CLUT8 graphics through
+ * a map created with convertPaletteToMap().
+ *
+ * @param dstBpp	the number of bytes per pixel of the destination
+ * @return			a function pointer to an optimised routine,
+ *					or nullptr if none are available.
+ *
+ * @note Only 2Bpp and 4Bpp destinations are supported. Users of
+ *       this function should provide a fallback using crossBlitMap()
+ *       if no optimised functions can be found.
+ * @note Unlike crossBlitMap(), these routines cannot convert in
+ *       place; the source and destination buffers must not overlap.
+ */
+FastBlitMapFunc getFastBlitMapFunc(const uint dstBpp);
+
 bool scaleBlit(byte *dst, const byte *src,
 			   const uint dstPitch, const uint srcPitch,
 			   const uint dstW, const uint dstH,
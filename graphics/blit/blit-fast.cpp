@@ -185,6 +185,62 @@ static const FastBlitLookup fastBlitFuncs_NEON[] = {
 };
 #endif
 
+template<typename DstColor>
+static void fastBlitMap(byte *dst, const byte *src,
+                        const uint dstPitch, const uint srcPitch,
+                        const uint w, const uint h, const uint32 *map) {
+	for (uint y = 0; y < h; ++y) {
+		DstColor *d = (DstColor *)dst;
+		const byte *s = src;
+		uint x = 0;
+
+		// Unrolled so that the table lookups of neighbouring pixels
+		// can be scheduled independently of each other
+		for (; x + 4 <= w; x += 4) {
+			const DstColor c0 = map[s[0]];
+			const DstColor c1 = map[s[1]];
+			const DstColor c2 = map[s[2]];
+			const DstColor c3 = map[s[3]];
+			d[0] = c0;
+			d[1] = c1;
+			d[2] = c2;
+			d[3] = c3;
+			s += 4;
+			d += 4;
+		}
+
+		for (; x < w; ++x)
+			*d++ = map[*s++];
+
+		src += srcPitch;
+		dst += dstPitch;
+	}
+}
+
+FastBlitMapFunc getFastBlitMapFunc(const uint dstBpp) {
+#ifdef SCUMMVM_SSE2
+#if defined(__x86_64__) || defined(_M_X64)
+	// SSE2 is always available on x86_64
+	const bool hasSSE2 = true;
+#else
+	const bool hasSSE2 = g_system->hasFeature(OSystem::kFeatureCpuSSE2);
+#endif
+	if (hasSSE2) {
+		if (dstBpp == 2)
+			return fastBlitMapSSE2_16;
+		if (dstBpp == 4)
+			return fastBlitMapSSE2_32;
+	}
+#endif
+
+	if (dstBpp == 2)
+		return fastBlitMap<uint16>;
+	if (dstBpp == 4)
+		return fastBlitMap<uint32>;
+
+	return nullptr;
+}
+
 FastBlitFunc getFastBlitFunc(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
 	const uint dstBpp = dstFmt.bytesPerPixel;
 	const uint srcBpp = srcFmt.bytesPerPixel;
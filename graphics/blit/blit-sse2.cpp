@@ -326,6 +326,59 @@ void BlendBlit::blitSSE2(Args &args, const TSpriteBlendMode &blendMode, const Al
 	blitT<BlendBlitImpl_SSE2>(args, blendMode, alphaType);
 }
 
+// The palette lookups themselves are scalar, as SSE2 has no gather
+// instruction, but the pixels are assembled into vectors so that
+// there is only one store per 128 bits of output.
+void fastBlitMapSSE2_16(byte *dst, const byte *src,
+                        const uint dstPitch, const uint srcPitch,
+                        const uint w, const uint h, const uint32 *map) {
+	for (uint y = 0; y < h; ++y) {
+		const byte *s = src;
+		uint16 *d = (uint16 *)dst;
+		uint x = 0;
+
+		for (; x + 8 <= w; x += 8) {
+			const __m128i px = _mm_setr_epi16(
+				(short)map[s[0]], (short)map[s[1]], (short)map[s[2]], (short)map[s[3]],
+				(short)map[s[4]], (short)map[s[5]], (short)map[s[6]], (short)map[s[7]]);
+			_mm_storeu_si128((__m128i *)d, px);
+			s += 8;
+			d += 8;
+		}
+
+		for (; x < w; ++x)
+			*d++ = map[*s++];
+
+		src += srcPitch;
+		dst += dstPitch;
+	}
+}
+
+void fastBlitMapSSE2_32(byte *dst, const byte *src,
+                        const uint dstPitch, const uint srcPitch,
+                        const uint w, const uint h, const uint32 *map) {
+	for (uint y = 0; y < h; ++y) {
+		const byte *s = src;
+		uint32 *d = (uint32 *)dst;
+		uint x = 0;
+
+		for (; x + 8 <= w; x += 8) {
+			const __m128i px0 = _mm_setr_epi32(map[s[0]], map[s[1]], map[s[2]], map[s[3]]);
+			const __m128i px1 = _mm_setr_epi32(map[s[4]], map[s[5]], map[s[6]], map[s[7]]);
+			_mm_storeu_si128((__m128i *)d, px0);
+			_mm_storeu_si128((__m128i *)(d + 4), px1);
+			s += 8;
+			d += 8;
+		}
+
+		for (; x < w; ++x)
+			*d++ = map[*s++];
+
+		src += srcPitch;
+		dst += dstPitch;
+	}
+}
+
 } // End of namespace Graphics
 
 #if !defined(__x86_64__)
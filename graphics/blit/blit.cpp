@@ -471,6 +471,17 @@ bool crossBlitMap(byte *dst, const byte *src,
 	if (!bytesPerPixel)
 		return false;
 
+	// Attempt to use a faster method if the buffers do not overlap
+	if (w && h) {
+		const byte *srcEnd = src + (h - 1) * srcPitch + w;
+		const byte *dstEnd = dst + (h - 1) * dstPitch + w * bytesPerPixel;
+		FastBlitMapFunc blitFunc = getFastBlitMapFunc(bytesPerPixel);
+		if (blitFunc && (dstEnd <= src || srcEnd <= dst)) {
+			blitFunc(dst, src, dstPitch, srcPitch, w, h, map);
+			return true;
+		}
+	}
+
 	return crossBlitMapHelperLogic<false, false>(dst, src, nullptr, w, h, bytesPerPixel, map, srcPitch, dstPitch, 0, 0);
 }
 
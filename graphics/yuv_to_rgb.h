@@ -38,6 +38,7 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/mutex.h"
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
@@ -143,6 +144,10 @@ private:
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
 
 	YUVToRGBLookup *_lookup;
+
+	// Held while converting, as videos may be decoded ahead from a timer
+	// proc
+	Common::Mutex _mutex;
 };
  /** @} */
 } // End of namespace Graphics
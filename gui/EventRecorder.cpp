@@ -19,6 +19,15 @@
  *
  */
 
+#ifdef POSIX
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define EVENTRECORDER_HAVE_MALLINFO2
+#endif
+#endif
+#endif
 
 #include "gui/EventRecorder.h"
 
@@ -28,10 +37,13 @@ namespace Common {
 DECLARE_SINGLETON(GUI::EventRecorder);
 }
 
+#include "common/algorithm.h"
 #include "common/debug-channels.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/mixer/mixer.h"
+#include "backends/mixer/null/null-mixer.h"
 #include "common/config-manager.h"
+#include "common/file.h"
 #include "common/md5.h"
 #include "gui/gui-manager.h"
 #include "gui/widget.h"
@@ -42,6 +54,8 @@ DECLARE_SINGLETON(GUI::EventRecorder);
 #include "graphics/thumbnail.h"
 #include "graphics/surface.h"
 #include "graphics/scaler.h"
+#include "common/formats/json.h"
+#include "base/version.h"
 
 #ifdef USE_IMGUI
 #include "backends/imgui/imgui.h"
@@ -54,6 +68,39 @@ namespace GUI {
 const int kMaxRecordsNames = 0x64;
 const int kDefaultScreenshotPeriod = 60000;
 
+// getMillis() is faked during playback, so the frame profile is measured
+// in microseconds of real time
+static uint64 getRealTime() {
+	const uint64 counter = SDL_GetPerformanceCounter();
+	const uint64 frequency = SDL_GetPerformanceFrequency();
+	return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+}
+
+static uint32 getHeapSize() {
+#ifdef EVENTRECORDER_HAVE_MALLINFO2
+	const struct mallinfo2 info = mallinfo2();
+	return (uint32)MIN<size_t>(info.uordblks + info.hblkhd, 0xFFFFFFFF);
+#else
+	return 0;
+#endif
+}
+
+/** Peak resident set size of the process in kilobytes, 0 if unknown */
+static uint32 getPeakRSS() {
+#ifdef POSIX
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef MACOSX
+		// Reported in bytes instead of kilobytes
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
 EventRecorder::EventRecorder() {
 	_timerManager = nullptr;
 	_recordMode = kPassthrough;
@@ -83,6 +130,10 @@ EventRecorder::EventRecorder() {
 	_screenshotPeriod = 0;
 	_playbackFile = nullptr;
 	_recordFile = nullptr;
+	_playbackStartTime = 0;
+	_frameEndTime = 0;
+	_updateStartTime = 0;
+	_startHeapSize = 0;
 }
 
 EventRecorder::~EventRecorder() {
@@ -97,6 +148,20 @@ void EventRecorder::deinit() {
 	_needRedraw = false;
 	_initialized = false;
 	_recordMode = kPassthrough;
+	Audio::MixerImpl::Profile profile;
+	const bool renderedAudio = _fakeMixerManager->isRendering();
+	if (renderedAudio) {
+		profile = _fakeMixerManager->stopRendering();
+		debugC(1, kDebugLevelEventRec, "playback:action=\"Audio profile\" callbacks=%u overbudget=%u frames=%llu mixtime=%llu maxcallback=%llu plain=%llu music=%llu sfx=%llu speech=%llu",
+		       profile.callbacks, profile.overBudget, (unsigned long long)profile.frames, (unsigned long long)profile.mixTime, (unsigned long long)profile.maxCallbackTime,
+		       (unsigned long long)profile.typeTime[Audio::Mixer::kPlainSoundType], (unsigned long long)profile.typeTime[Audio::Mixer::kMusicSoundType],
+		       (unsigned long long)profile.typeTime[Audio::Mixer::kSFXSoundType], (unsigned long long)profile.typeTime[Audio::Mixer::kSpeechSoundType]);
+	}
+	if (!_reportFileName.empty()) {
+		writeReport(renderedAudio ? &profile : nullptr);
+		_reportFileName.clear();
+		_frameProfiles.clear();
+	}
 	delete _fakeMixerManager;
 	_fakeMixerManager = nullptr;
 	if (_controlPanel) {
@@ -294,6 +359,7 @@ void EventRecorder::processScreenUpdate() {
 		if (_controlPanel)
 			_controlPanel->setReplayedTime(_fakeTimer);
 		_processingMillis = false;
+		startFrameProfile();
 		break;
 	default:
 		break;
@@ -405,6 +471,7 @@ void EventRecorder::init(const Common::String &recordFileName, RecordMode mode)
 	_lastMillis = g_system->getMillis();
 	_lastScreenshotTime = 0;
 	_recordMode = mode;
+	_recordFileName = recordFileName;
 	_needcontinueGame = false;
 	_fastPlayback = false;
 	if (ConfMan.hasKey("disable_display")) {
@@ -429,7 +496,13 @@ void EventRecorder::init(const Common::String &recordFileName, RecordMode mode)
 		return;
 	}
 
-	if (!isImGuiRecorderEnabled()) {
+	_reportFileName.clear();
+	if ((_recordMode == kRecorderPlayback) && ConfMan.hasKey("record_report_file"))
+		_reportFileName = ConfMan.get("record_report_file");
+
+	// The control panel is not drawn while profiling, as it would be
+	// drawn on top of every frame
+	if (!isImGuiRecorderEnabled() && _reportFileName.empty()) {
 		if (_recordMode != kPassthrough) {
 			_controlPanel = new GUI::OnScreenDialog(_recordMode == kRecorderRecord);
 			_controlPanel->reflowLayout();
@@ -438,6 +511,19 @@ void EventRecorder::init(const Common::String &recordFileName, RecordMode mode)
 	if ((_recordMode == kRecorderPlayback) || (_recordMode == kRecorderUpdate)) {
 		applyPlaybackSettings();
 		_nextEvent = _playbackFile->getNextEvent();
+
+		if (ConfMan.hasKey("record_audio_file")) {
+			// Render the audio of the session from the recorded time
+			const Common::String audioFileName = ConfMan.get("record_audio_file");
+			Common::DumpFile *audioFile = new Common::DumpFile();
+			if (audioFile->open(Common::FSNode(Common::Path::fromCommandLine(audioFileName)))) {
+				debugC(1, kDebugLevelEventRec, "playback:action=\"Render audio\" filename=%s", audioFileName.c_str());
+				_fakeMixerManager->startRendering(audioFile);
+			} else {
+				warning("Could not open %s to render the audio", audioFileName.c_str());
+				delete audioFile;
+			}
+		}
 	}
 	if ((_recordMode == kRecorderRecord) || (_recordMode == kRecorderUpdate)) {
 		getConfig();
@@ -445,6 +531,14 @@ void EventRecorder::init(const Common::String &recordFileName, RecordMode mode)
 
 	switchMixer();
 	switchTimerManagers();
+	if (!_reportFileName.empty()) {
+		debugC(1, kDebugLevelEventRec, "playback:action=\"Profile frames\" filename=%s", _reportFileName.c_str());
+		_frameProfiles.clear();
+		_startHeapSize = getHeapSize();
+		_playbackStartTime = getRealTime();
+		_frameEndTime = _playbackStartTime;
+		_updateStartTime = 0;
+	}
 	_needRedraw = true;
 	_initialized = true;
 }
@@ -593,7 +687,10 @@ void EventRecorder::updateSubsystems() {
 	}
 	RecordMode oldRecordMode = _recordMode;
 	_recordMode = kPassthrough;
-	_fakeMixerManager->update();
+	if (_fakeMixerManager->isRendering())
+		_fakeMixerManager->renderUntil(_fakeTimer);
+	else
+		_fakeMixerManager->update();
 	_recordMode = oldRecordMode;
 }
 
@@ -736,7 +833,7 @@ Common::SaveFileManager *EventRecorder::getSaveManager(Common::SaveFileManager *
 }
 
 void EventRecorder::preDrawOverlayGui() {
-	if (isImGuiRecorderEnabled())
+	if (isImGuiRecorderEnabled() || !_controlPanel)
 		return;
 
 	if ((_initialized) || (_needRedraw)) {
@@ -756,7 +853,9 @@ void EventRecorder::preDrawOverlayGui() {
 }
 
 void EventRecorder::postDrawOverlayGui() {
-	if (isImGuiRecorderEnabled())
+	endFrameProfile();
+
+	if (isImGuiRecorderEnabled() || !_controlPanel)
 		return;
 
 	if ((_initialized) || (_needRedraw)) {
@@ -767,6 +866,96 @@ void EventRecorder::postDrawOverlayGui() {
 	}
 }
 
+void EventRecorder::startFrameProfile() {
+	if (!_reportFileName.empty())
+		_updateStartTime = getRealTime();
+}
+
+void EventRecorder::endFrameProfile() {
+	if (_reportFileName.empty() || !_updateStartTime)
+		return;
+
+	FrameProfile frame;
+	frame.time = _fakeTimer;
+	frame.engineTime = _updateStartTime - _frameEndTime;
+	frame.updateTime = getRealTime() - _updateStartTime;
+	frame.heapSize = getHeapSize();
+	_frameProfiles.push_back(frame);
+
+	_updateStartTime = 0;
+	_frameEndTime = getRealTime();
+}
+
+static Common::String formatTimeStats(Common::Array<uint32> &times) {
+	if (times.empty())
+		return "{}";
+
+	uint64 total = 0;
+	for (uint i = 0; i < times.size(); i++)
+		total += times[i];
+	Common::sort(times.begin(), times.end());
+
+	const uint last = times.size() - 1;
+	return Common::String::format("{ \"total\": %llu, \"mean\": %llu, \"median\": %u, \"p95\": %u, \"p99\": %u, \"max\": %u }",
+		(unsigned long long)total, (unsigned long long)(total / times.size()), times[last / 2], times[last * 95 / 100], times[last * 99 / 100], times[last]);
+}
+
+void EventRecorder::writeReport(const Audio::MixerImpl::Profile *audioProfile) {
+	const uint64 wallTime = getRealTime() - _playbackStartTime;
+
+	Common::DumpFile report;
+	if (!report.open(Common::FSNode(Common::Path::fromCommandLine(_reportFileName)))) {
+		warning("Could not open %s to write the playback report", _reportFileName.c_str());
+		return;
+	}
+
+	Common::Array<uint32> engineTimes;
+	Common::Array<uint32> updateTimes;
+	uint32 peakHeapSize = _startHeapSize;
+	for (uint i = 0; i < _frameProfiles.size(); i++) {
+		engineTimes.push_back(_frameProfiles[i].engineTime);
+		updateTimes.push_back(_frameProfiles[i].updateTime);
+		peakHeapSize = MAX(peakHeapSize, _frameProfiles[i].heapSize);
+	}
+	const uint32 endHeapSize = _frameProfiles.empty() ? _startHeapSize : _frameProfiles.back().heapSize;
+
+	// Times are in microseconds of real time, except for the recorded time
+	// of the frames, and sizes are in bytes, except for the peak RSS
+	report.writeString("{\n");
+	report.writeString(Common::String::format("\t\"version\": %s,\n", Common::JSONValue(gScummVMFullVersion).stringify().c_str()));
+	report.writeString(Common::String::format("\t\"recording\": %s,\n", Common::JSONValue(_recordFileName).stringify().c_str()));
+	report.writeString(Common::String::format("\t\"target\": %s,\n", Common::JSONValue(ConfMan.getActiveDomainName()).stringify().c_str()));
+	report.writeString(Common::String::format("\t\"fastPlayback\": %s,\n", _fastPlayback ? "true" : "false"));
+	report.writeString(Common::String::format("\t\"recordedTime\": %u,\n", _fakeTimer));
+	report.writeString(Common::String::format("\t\"wallTime\": %llu,\n", (unsigned long long)wallTime));
+	report.writeString(Common::String::format("\t\"frames\": %u,\n", _frameProfiles.size()));
+	report.writeString(Common::String::format("\t\"engineTime\": %s,\n", formatTimeStats(engineTimes).c_str()));
+	report.writeString(Common::String::format("\t\"updateTime\": %s,\n", formatTimeStats(updateTimes).c_str()));
+	report.writeString(Common::String::format("\t\"heap\": { \"start\": %u, \"end\": %u, \"peak\": %u },\n", _startHeapSize, endHeapSize, peakHeapSize));
+	report.writeString(Common::String::format("\t\"peakRSSKB\": %u,\n", getPeakRSS()));
+	if (audioProfile) {
+		report.writeString(Common::String::format("\t\"audio\": { \"callbacks\": %u, \"overBudget\": %u, \"frames\": %llu, \"mixTime\": %llu, \"maxCallbackTime\": %llu },\n",
+			audioProfile->callbacks, audioProfile->overBudget, (unsigned long long)audioProfile->frames,
+			(unsigned long long)audioProfile->mixTime, (unsigned long long)audioProfile->maxCallbackTime));
+	}
+
+	// One frame per line, so reports of the same recording diff well
+	report.writeString("\t\"frameColumns\": [ \"time\", \"engineTime\", \"updateTime\", \"heap\" ],\n");
+	report.writeString("\t\"frameProfile\": [");
+	for (uint i = 0; i < _frameProfiles.size(); i++) {
+		const FrameProfile &frame = _frameProfiles[i];
+		report.writeString(Common::String::format("%s\n\t\t[ %u, %u, %u, %u ]", i ? "," : "",
+			frame.time, frame.engineTime, frame.updateTime, frame.heapSize));
+	}
+	report.writeString("\n\t]\n}\n");
+
+	if (!report.flush() || report.err())
+		warning("Could not write the playback report to %s", _reportFileName.c_str());
+	else
+		debugC(1, kDebugLevelEventRec, "playback:action=\"Write report\" filename=%s frames=%u", _reportFileName.c_str(), _frameProfiles.size());
+	report.close();
+}
+
 Common::StringArray EventRecorder::listSaveFiles(const Common::String &pattern) {
 	if ((_recordMode == kRecorderPlayback) || (_recordMode == kRecorderUpdate)) {
 		Common::StringArray result;
@@ -237,6 +237,18 @@ private:
 
 	bool checkGameHash(const ADGameDescription *desc);
 
+	/** Time spent on a played back frame, in microseconds of real time */
+	struct FrameProfile {
+		uint32 time;		/**< recorded time of the frame, in milliseconds */
+		uint32 engineTime;	/**< time since the previous frame was displayed */
+		uint32 updateTime;	/**< time spent displaying the frame */
+		uint32 heapSize;	/**< bytes allocated on the heap after the frame, 0 if unknown */
+	};
+
+	void startFrameProfile();
+	void endFrameProfile();
+	void writeReport(const Audio::MixerImpl::Profile *audioProfile);
+
 	void checkForKeyCode(const Common::Event &event);
 	/**
 	 * @return false because we don't want to remap the given event again. This already happened on
@@ -259,6 +271,13 @@ private:
 	bool _fastPlayback;
 	bool _needRedraw;
 	bool _processingMillis;
+
+	Common::String _reportFileName;
+	Common::Array<FrameProfile> _frameProfiles;
+	uint64 _playbackStartTime;
+	uint64 _frameEndTime;
+	uint64 _updateStartTime;
+	uint32 _startHeapSize;
 };
 
 } // End of namespace GUI
@@ -182,6 +182,7 @@ void AboutDialog::buildLines() {
 	// Unload all MetaEnginesDetection if we're using uncached plugins to save extra memory.
 	if (!_inGame) PluginMan.unloadDetectionPlugin();
 #endif
+	if (!_inGame) PluginMan.loadDeferredPlugins(); // only for cached manager
 	if (!_inGame) PluginMan.loadFirstPlugin();
 	do {
 		uint32 currentTime = g_system->getMillis(true);
@@ -36,6 +36,8 @@
 
 #include "engines/engine.h"
 
+#include "audio/sound_cache.h"
+
 #include "gui/debugger.h"
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 	#include "gui/console.h"
@@ -81,6 +83,8 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("soundcache",		WRAP_METHOD(Debugger, cmdSoundCache));
 }
 
 Debugger::~Debugger() {
@@ -858,6 +862,30 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdSoundCache(int argc, const char **argv) {
+	Audio::SoundCache &cache = Audio::SoundCache::instance();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "clear")) {
+		cache.clear();
+		cache.resetStats();
+		debugPrintf("Sound cache cleared\n");
+		return true;
+	} else if (argc == 3 && !scumm_stricmp(argv[1], "limit")) {
+		cache.setMemoryLimit(atoi(argv[2]) * 1024);
+		debugPrintf("Sound cache limit set to %d KB\n", cache.getMemoryLimit() / 1024);
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [clear | limit <KB>]\n", argv[0]);
+		debugPrintf("A limit of 0 disables the cache\n");
+		return true;
+	}
+
+	const uint32 lookups = cache.getHits() + cache.getMisses();
+	debugPrintf("Sound cache: %d sounds, %d of %d KB used\n", cache.getEntryCount(), cache.getMemoryUsage() / 1024, cache.getMemoryLimit() / 1024);
+	debugPrintf("%d hits, %d misses, hit rate %d%%\n", cache.getHits(), cache.getMisses(), lookups ? cache.getHits() * 100 / lookups : 0);
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
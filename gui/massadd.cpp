@@ -23,12 +23,17 @@
 #include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/debug.h"
+#include "common/hash-str.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/taskbar.h"
 #include "common/translation.h"
 
 #include "engines/advancedDetector.h"
 
+#include "base/plugins.h"
+#include "base/version.h"
+
 #include "gui/massadd.h"
 
 #ifndef DISABLE_MASS_ADD
@@ -54,13 +59,17 @@ enum {
 	kCancelCmd = 'CNCL'
 };
 
+#define SCAN_CACHE_FILENAME "scummvm-massadd-cache.txt"
+
 
 
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
 	_dirsScanned(0),
+	_dirsUnchanged(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
+	_scanStartTime(g_system->getMillis()),
 	_okButton(nullptr),
 	_dirProgressText(nullptr),
 	_gameProgressText(nullptr) {
@@ -70,6 +79,9 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	// The dir we start our scan at
 	_scanStack.push(startDir);
 
+	_startPath = startDir.getPath();
+	_startPath.removeTrailingSeparators();
+
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
 
@@ -107,6 +119,8 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 			_pathToTargets[path].push_back(iter->_key);
 		}
 	}
+
+	loadScanCache();
 }
 
 struct GameTargetLess {
@@ -156,7 +170,11 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 
 		close();
 	} else if (cmd == kCancelCmd) {
-		// User cancelled, so we don't do anything and just leave.
+		// User cancelled, so we don't do anything and just leave. The
+		// directories scanned so far still speed up the next scan.
+		if (!_scanStack.empty())
+			saveScanCache();
+
 		_games.clear();
 		close();
 	} else if (cmd == kListSelectionChangedCmd) {
@@ -198,63 +216,88 @@ void MassAddDialog::handleTickle() {
 			continue;
 		}
 
-		// Run the detector on the dir
-		DetectionResults detectionResults = EngineMan.detectGames(files, (ADGF_WARNING | ADGF_UNSUPPORTED | ADGF_ADDON), true);
+		Common::Path path = dir.getPath();
+		path.removeTrailingSeparators();
 
-		if (detectionResults.foundUnknownGames()) {
-			Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
-			g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
-		}
+		// Skip the detectors if no games were found here last time, and
+		// nothing changed since then. Detectors also match files in the
+		// subdirectories, which the fingerprint does not cover, so only
+		// directories without any are skipped.
+		bool hasSubdirs = false;
+		for (const auto &file : files)
+			hasSubdirs |= file.isDirectory();
+
+		const uint32 fingerprint = hasSubdirs ? 0 : getDirectoryFingerprint(files);
+		ScanCache::iterator cached = _scanCache.find(path);
+
+		if (!hasSubdirs && cached != _scanCache.end() && cached->_value.fingerprint == fingerprint) {
+			cached->_value.seen = true;
+			_dirsUnchanged++;
+		} else {
+			// Run the detector on the dir
+			DetectionResults detectionResults = EngineMan.detectGames(files, (ADGF_WARNING | ADGF_UNSUPPORTED | ADGF_ADDON), true);
+
+			if (detectionResults.foundUnknownGames()) {
+				Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
+				g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
+			}
 
-		// Just add all detected games / game variants. If we get more than one,
-		// that either means the directory contains multiple games, or the detector
-		// could not fully determine which game variant it was seeing. In either
-		// case, let the user choose which entries he wants to keep.
-		//
-		// However, we only add games which are not already in the config file.
-		DetectedGames candidates = detectionResults.listRecognizedGames();
-		for (const auto &cand : candidates) {
-			const DetectedGame &result = cand;
-
-			Common::Path path = dir.getPath();
-			path.removeTrailingSeparators();
-
-			// Check for existing config entries for this path/engineid/gameid/lang/platform combination
-			if (_pathToTargets.contains(path)) {
-				Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
-				Common::String resultLanguageCode = Common::getLanguageCode(result.language);
-
-				bool duplicate = false;
-				const Common::StringArray &targets = _pathToTargets[path];
-				for (const auto &target : targets) {
-					// If the engineid, gameid, platform and language match -> skip it
-					Common::ConfigManager::Domain *dom = ConfMan.getDomain(target);
-					assert(dom);
-
-					if ((!dom->contains("engineid") || (*dom)["engineid"] == result.engineId) &&
-						(*dom)["gameid"] == result.gameId &&
-					    dom->getValOrDefault("platform") == resultPlatformCode &&
-						parseLanguage(dom->getValOrDefault("language")) == parseLanguage(resultLanguageCode)) {
-						duplicate = true;
-						break;
+			// Just add all detected games / game variants. If we get more than one,
+			// that either means the directory contains multiple games, or the detector
+			// could not fully determine which game variant it was seeing. In either
+			// case, let the user choose which entries he wants to keep.
+			//
+			// However, we only add games which are not already in the config file.
+			DetectedGames candidates = detectionResults.listRecognizedGames();
+			bool addedGames = false;
+			for (const auto &cand : candidates) {
+				const DetectedGame &result = cand;
+
+				// Check for existing config entries for this path/engineid/gameid/lang/platform combination
+				if (_pathToTargets.contains(path)) {
+					Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
+					Common::String resultLanguageCode = Common::getLanguageCode(result.language);
+
+					bool duplicate = false;
+					const Common::StringArray &targets = _pathToTargets[path];
+					for (const auto &target : targets) {
+						// If the engineid, gameid, platform and language match -> skip it
+						Common::ConfigManager::Domain *dom = ConfMan.getDomain(target);
+						assert(dom);
+
+						if ((!dom->contains("engineid") || (*dom)["engineid"] == result.engineId) &&
+							(*dom)["gameid"] == result.gameId &&
+						    dom->getValOrDefault("platform") == resultPlatformCode &&
+							parseLanguage(dom->getValOrDefault("language")) == parseLanguage(resultLanguageCode)) {
+							duplicate = true;
+							break;
+						}
+					}
+					if (duplicate) {
+						_oldGamesCount++;
+						continue;	// Skip duplicates
 					}
 				}
-				if (duplicate) {
-					_oldGamesCount++;
-					continue;	// Skip duplicates
-				}
+				_games.push_back(result);
+				_games.back().isSelected = true;
+				addedGames = true;
 			}
-			_games.push_back(result);
-
-			_list->append(result.description);
-		}
 
-		for (DetectedGame &game : _games) {
-			game.isSelected = true;
+			// Only list the new games, so the selection of the others is kept
+			if (addedGames)
+				updateGameList();
+
+			// Remember the directories without any games, known or unknown
+			if (!hasSubdirs && candidates.empty() && !detectionResults.foundUnknownGames()) {
+				ScanCacheEntry entry;
+				entry.fingerprint = fingerprint;
+				entry.seen = true;
+				_scanCache[path] = entry;
+			} else if (cached != _scanCache.end()) {
+				_scanCache.erase(cached);
+			}
 		}
 
-		updateGameList();
-
 		// Recurse into all subdirs
 		for (const auto &file : files) {
 			if (file.isDirectory()) {
@@ -277,6 +320,11 @@ void MassAddDialog::handleTickle() {
 	Common::U32String buf;
 
 	if (_scanStack.empty()) {
+		debug(1, "Mass add scanned %d directories in %u ms, skipped detection in %d unchanged ones",
+			_dirsScanned, g_system->getMillis() - _scanStartTime, _dirsUnchanged);
+
+		saveScanCache();
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -302,6 +350,97 @@ void MassAddDialog::handleTickle() {
 }
 
 
+uint32 MassAddDialog::getDirectoryFingerprint(const Common::FSList &files) {
+	// Combine the names so that the order of the listing does not matter.
+	// The file sizes are left out, as getting them means opening each file.
+	uint32 fingerprint = files.size();
+
+	for (const auto &file : files) {
+		uint32 hash = Common::hashit(file.getName().c_str());
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6B;
+		hash ^= hash >> 13;
+		fingerprint += hash;
+	}
+
+	return fingerprint;
+}
+
+Common::String MassAddDialog::getScanCacheSignature() {
+	// Directories without games have to be scanned again when the detectors
+	// change, so the cache is only valid for the same version and engines
+	uint32 entries = 0;
+	uint32 engines = 0;
+
+	const PluginList &plugins = EngineMan.getPlugins(PLUGIN_TYPE_ENGINE_DETECTION);
+	for (const auto &plugin : plugins) {
+		const MetaEngineDetection &metaEngine = plugin->get<MetaEngineDetection>();
+		engines = engines * 31 + Common::hashit(metaEngine.getName());
+		entries += metaEngine.getGameVariantCount();
+	}
+
+	return Common::String::format("%s %08x %u", gScummVMFullVersion, engines, entries);
+}
+
+void MassAddDialog::loadScanCache() {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::InSaveFile *loadFile = saveFileMan->openRawFile(SCAN_CACHE_FILENAME);
+	if (!loadFile) {
+		return;
+	}
+
+	if (loadFile->readLine() != getScanCacheSignature()) {
+		debug(1, "Ignoring " SCAN_CACHE_FILENAME " from a different version");
+		delete loadFile;
+		return;
+	}
+
+	while (!loadFile->eos() && !loadFile->err()) {
+		const Common::String line = loadFile->readLine();
+		if (line.size() < 10 || line[8] != ' ') {
+			continue;
+		}
+
+		ScanCacheEntry entry;
+		entry.fingerprint = strtoul(line.substr(0, 8).c_str(), nullptr, 16);
+		entry.seen = false;
+		_scanCache[Common::Path::fromConfig(line.substr(9))] = entry;
+	}
+
+	delete loadFile;
+	debug(1, "Read %u directories from " SCAN_CACHE_FILENAME, _scanCache.size());
+}
+
+void MassAddDialog::saveScanCache() {
+	// Forget the directories which are gone, but only if the whole tree
+	// was scanned
+	if (_scanStack.empty()) {
+		for (auto it = _scanCache.begin(); it != _scanCache.end(); ++it) {
+			if (!it->_value.seen && it->_key.isRelativeTo(_startPath))
+				_scanCache.erase(it);
+		}
+	}
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::WriteStream *saveFile = saveFileMan->openForSaving(SCAN_CACHE_FILENAME, false);
+	if (!saveFile) {
+		warning("Failed to open " SCAN_CACHE_FILENAME " for writing");
+		return;
+	}
+
+	saveFile->writeString(getScanCacheSignature());
+	saveFile->writeByte('\n');
+
+	for (const auto &entry : _scanCache) {
+		saveFile->writeString(Common::String::format("%08x ", entry._value.fingerprint));
+		saveFile->writeString(entry._key.toConfig());
+		saveFile->writeByte('\n');
+	}
+
+	saveFile->finalize();
+	delete saveFile;
+}
+
 } // End of namespace GUI
 
 #endif // DISABLE_MASS_ADD
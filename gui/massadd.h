@@ -54,6 +54,26 @@ private:
 
 	void updateGameList();
 
+	void loadScanCache();
+	void saveScanCache();
+	static uint32 getDirectoryFingerprint(const Common::FSList &files);
+	static Common::String getScanCacheSignature();
+
+	struct ScanCacheEntry {
+		uint32 fingerprint;
+		bool seen;
+	};
+
+	/**
+	 * Fingerprints of the file names of the directories without
+	 * subdirectories in which a mass add found no games, kept between runs.
+	 * These directories are only run through the detectors again when
+	 * their contents changed.
+	 */
+	typedef Common::HashMap<Common::Path, ScanCacheEntry, Common::Path::Hash, Common::Path::EqualTo> ScanCache;
+	ScanCache _scanCache;
+	Common::Path _startPath;
+
 	/**
 	 * Map each path occurring in the config file to the target(s) using that path.
 	 * Used to detect whether a potential new target is already present in the
@@ -63,8 +83,10 @@ private:
 		Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> _pathToTargets;
 
 	int _dirsScanned;
+	int _dirsUnchanged;
 	int _oldGamesCount;
 	int _dirTotal;
+	uint32 _scanStartTime;
 
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
@@ -29,6 +29,7 @@
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#include "graphics/blit.h"
 #include "graphics/surface.h"
 
 // Code here partially based off of ffmpeg ;)
@@ -282,6 +283,7 @@ void decodeVectorsTmpl(CinepakFrame &frame, const byte *clipTable, Common::Seeka
 CinepakDecoder::CinepakDecoder(int bitsPerPixel) : Codec(), _bitsPerPixel(bitsPerPixel), _ditherPalette(0) {
 	_curFrame.surface = 0;
 	_curFrame.strips = 0;
+	_ownSurface = 0;
 	_y = 0;
 	_colorMap = 0;
 	_ditherType = kDitherTypeUnknown;
@@ -309,9 +311,9 @@ CinepakDecoder::CinepakDecoder(int bitsPerPixel) : Codec(), _bitsPerPixel(bitsPe
 }
 
 CinepakDecoder::~CinepakDecoder() {
-	if (_curFrame.surface) {
-		_curFrame.surface->free();
-		delete _curFrame.surface;
+	if (_ownSurface) {
+		_ownSurface->free();
+		delete _ownSurface;
 	}
 
 	delete[] _curFrame.strips;
@@ -347,9 +349,17 @@ const Graphics::Surface *CinepakDecoder::decodeFrame(Common::SeekableReadStream
 			stream.seek(-2, SEEK_CUR);
 	}
 
+	if (_curFrame.surface == &_outputSurface && (_outputSurface.w != _curFrame.width || _outputSurface.h != _curFrame.height)) {
+		warning("Cinepak frame of %dx%d does not match the output surface of %dx%d", _curFrame.width, _curFrame.height, _outputSurface.w, _outputSurface.h);
+		_curFrame.surface = 0;
+	}
+
 	if (!_curFrame.surface) {
-		_curFrame.surface = new Graphics::Surface();
-		_curFrame.surface->create(_curFrame.width, _curFrame.height, _pixelFormat);
+		if (!_ownSurface) {
+			_ownSurface = new Graphics::Surface();
+			_ownSurface->create(_curFrame.width, _curFrame.height, _pixelFormat);
+		}
+		_curFrame.surface = _ownSurface;
 	}
 
 	_y = 0;
@@ -653,6 +663,49 @@ bool CinepakDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
 	return true;
 }
 
+bool CinepakDecoder::setOutputSurface(const Graphics::Surface *area) {
+	if (area && _curFrame.surface == &_outputSurface) {
+		if (area->getPixels() == _outputSurface.getPixels() && area->pitch == _outputSurface.pitch &&
+				area->w == _outputSurface.w && area->h == _outputSurface.h && area->format == _outputSurface.format)
+			return true;
+
+		// Go through the surface of the codec, as the areas may overlap
+		setOutputSurface(nullptr);
+	}
+
+	if (area) {
+		// The blocks are written in the format of the surface, but the
+		// paletted and dithered frames need their own surface
+		if (_bitsPerPixel == 8 || _ditherPalette.size() > 0)
+			return false;
+		if (area->format.bytesPerPixel != 2 && area->format.bytesPerPixel != 4)
+			return false;
+		if (_curFrame.surface && (area->w != _curFrame.surface->w || area->h != _curFrame.surface->h))
+			return false;
+
+		_outputSurface = *area;
+
+		// The next frame may only update parts of the current one
+		if (_curFrame.surface) {
+			Graphics::crossBlit((byte *)_outputSurface.getPixels(), (const byte *)_curFrame.surface->getPixels(),
+					_outputSurface.pitch, _curFrame.surface->pitch, _outputSurface.w, _outputSurface.h, _outputSurface.format, _curFrame.surface->format);
+		}
+
+		_curFrame.surface = &_outputSurface;
+	} else if (_curFrame.surface == &_outputSurface) {
+		if (!_ownSurface) {
+			_ownSurface = new Graphics::Surface();
+			_ownSurface->create(_outputSurface.w, _outputSurface.h, _pixelFormat);
+		}
+
+		Graphics::crossBlit((byte *)_ownSurface->getPixels(), (const byte *)_outputSurface.getPixels(),
+				_ownSurface->pitch, _outputSurface.pitch, _ownSurface->w, _ownSurface->h, _ownSurface->format, _outputSurface.format);
+		_curFrame.surface = _ownSurface;
+	}
+
+	return true;
+}
+
 bool CinepakDecoder::canDither(DitherType type) const {
 	return (type == kDitherTypeVFW || type == kDitherTypeQT) && _bitsPerPixel == 24;
 }
@@ -76,6 +76,7 @@ public:
 	const Graphics::Surface *decodeFrame(Common::SeekableReadStream &stream) override;
 	Graphics::PixelFormat getPixelFormat() const override { return _pixelFormat; }
 	bool setOutputPixelFormat(const Graphics::PixelFormat &format) override;
+	bool setOutputSurface(const Graphics::Surface *area) override;
 
 	bool containsPalette() const override { return _ditherPalette != 0; }
 	const byte *getPalette() override { _dirtyPalette = false; return _ditherPalette.data(); }
@@ -84,7 +85,11 @@ public:
 	void setDither(DitherType type, const byte *palette) override;
 
 private:
+	// The frame is decoded into _curFrame.surface, which is either the
+	// surface of the codec or the area given to setOutputSurface()
 	CinepakFrame _curFrame;
+	Graphics::Surface *_ownSurface;
+	Graphics::Surface _outputSurface;
 	int32 _y;
 	int _bitsPerPixel;
 	Graphics::PixelFormat _pixelFormat;
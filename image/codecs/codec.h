@@ -93,6 +93,24 @@ public:
 	 */
 	virtual bool setOutputPixelFormat(const Graphics::PixelFormat &format) { return format == getPixelFormat(); }
 
+	/**
+	 * Decode the following frames directly into a surface of the caller,
+	 * instead of a surface of the codec, so they do not have to be copied
+	 * there afterwards. decodeFrame() then returns a surface describing
+	 * that area. Passing nullptr goes back to the surface of the codec.
+	 *
+	 * Frames which only update parts of the previous one are decoded over
+	 * the area, so it must be left as is between frames. The previous frame
+	 * is copied into the area when it is set, and back into the codec when
+	 * it is replaced, so the area must stay valid until then.
+	 *
+	 * @param area  the pixels to decode into, with the size of the frames,
+	 *              usually a sub-area of a larger surface
+	 * @return true if the frames are decoded into @p area, false if the
+	 *         codec cannot do so, for instance because of its pixel format
+	 */
+	virtual bool setOutputSurface(const Graphics::Surface *area) { return area == nullptr; }
+
 	/**
 	 * Can this codec's frames contain a palette?
 	 */
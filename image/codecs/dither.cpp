@@ -206,8 +206,78 @@ void DitherCodec::setCodecAccuracy(CodecAccuracy accuracy) {
 	return _codec->setCodecAccuracy(accuracy);
 }
 
-byte *DitherCodec::createQuickTimeDitherTable(const byte *palette, uint colorCount) {
-	byte *buf = new byte[0x10000]();
+namespace {
+
+/**
+ * A small most-recently-used cache of QuickTime dither tables.
+ *
+ * Building a table is far more expensive than copying it, and the
+ * videos of a game usually share a handful of palettes, so the tables
+ * are kept around across decoder instances.
+ */
+class QuickTimeDitherTableCache {
+public:
+	QuickTimeDitherTableCache() {
+		for (uint i = 0; i < kSize; i++)
+			_entries[i].table = nullptr;
+	}
+
+	~QuickTimeDitherTableCache() {
+		for (uint i = 0; i < kSize; i++)
+			delete[] _entries[i].table;
+	}
+
+	bool lookup(const byte *palette, uint colorCount, byte *dst) {
+		for (uint i = 0; i < kSize && _entries[i].table; i++) {
+			if (_entries[i].colorCount != colorCount || memcmp(_entries[i].palette, palette, colorCount * 3) != 0)
+				continue;
+
+			memcpy(dst, _entries[i].table, kTableSize);
+
+			// Move the entry to the front
+			Entry entry = _entries[i];
+			for (; i > 0; i--)
+				_entries[i] = _entries[i - 1];
+			_entries[0] = entry;
+			return true;
+		}
+
+		return false;
+	}
+
+	void store(const byte *palette, uint colorCount, const byte *table) {
+		// Evict the least recently used entry
+		byte *buf = _entries[kSize - 1].table;
+		if (!buf)
+			buf = new byte[kTableSize];
+
+		for (uint i = kSize - 1; i > 0; i--)
+			_entries[i] = _entries[i - 1];
+
+		memcpy(_entries[0].palette, palette, colorCount * 3);
+		_entries[0].colorCount = colorCount;
+		_entries[0].table = buf;
+		memcpy(buf, table, kTableSize);
+	}
+
+	static const uint kTableSize = 0x10000;
+
+private:
+	static const uint kSize = 4;
+
+	struct Entry {
+		byte palette[256 * 3];
+		uint colorCount;
+		byte *table;
+	};
+
+	Entry _entries[kSize];
+};
+
+QuickTimeDitherTableCache *s_quickTimeDitherTableCache = nullptr;
+
+void generateQuickTimeDitherTable(byte *buf, const byte *palette, uint colorCount) {
+	memset(buf, 0, QuickTimeDitherTableCache::kTableSize);
 
 	Common::List<uint16> checkQueue;
 
@@ -324,9 +394,33 @@ byte *DitherCodec::createQuickTimeDitherTable(const byte *palette, uint colorCou
 			}
 		}
 	}
+}
+
+} // End of anonymous namespace
+
+byte *DitherCodec::createQuickTimeDitherTable(const byte *palette, uint colorCount) {
+	byte *buf = new byte[QuickTimeDitherTableCache::kTableSize];
+
+	// Palettes with more than 256 colors do not fit into the cache
+	if (colorCount > 256) {
+		generateQuickTimeDitherTable(buf, palette, colorCount);
+	} else {
+		if (!s_quickTimeDitherTableCache)
+			s_quickTimeDitherTableCache = new QuickTimeDitherTableCache();
+
+		if (!s_quickTimeDitherTableCache->lookup(palette, colorCount, buf)) {
+			generateQuickTimeDitherTable(buf, palette, colorCount);
+			s_quickTimeDitherTableCache->store(palette, colorCount, buf);
+		}
+	}
 
 	return buf;
 }
 
+void DitherCodec::freeQuickTimeDitherTables() {
+	delete s_quickTimeDitherTableCache;
+	s_quickTimeDitherTableCache = nullptr;
+}
+
 } // End of namespace Image
 
@@ -55,6 +55,12 @@ public:
 	 */
 	static byte *createQuickTimeDitherTable(const byte *palette, uint colorCount);
 
+	/**
+	 * Free the dither tables which createQuickTimeDitherTable() keeps for
+	 * the palettes used last.
+	 */
+	static void freeQuickTimeDitherTables();
+
 private:
 	DisposeAfterUse::Flag _disposeAfterUse;
 	Codec *_codec;
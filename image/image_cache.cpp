@@ -0,0 +1,90 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "image/image_cache.h"
+
+#include "common/debug.h"
+
+namespace Common {
+DECLARE_SINGLETON(Image::ImageCache);
+}
+
+namespace Image {
+
+ImageCache::ImageCache() :
+		_cache(16 * 1024 * 1024),
+		_hits(0),
+		_misses(0) {
+}
+
+Common::String ImageCache::makeKey(const Common::Path &path, const Graphics::PixelFormat &format) {
+	// The format goes first, as it cannot contain the path separator
+	return format.toString() + "|" + path.toString('/');
+}
+
+ImageCache::SurfacePtr ImageCache::get(const Common::Path &path, const Graphics::PixelFormat &format) {
+	const SurfacePtr *surface = _cache.get(makeKey(path, format));
+	if (!surface) {
+		_misses++;
+		return SurfacePtr();
+	}
+
+	_hits++;
+	return *surface;
+}
+
+bool ImageCache::isCacheable(const Graphics::Surface &surface) const {
+	return !surface.format.isCLUT8() && surface.getPixels() && (uint32)(surface.h * surface.pitch) <= _cache.getMemoryLimit();
+}
+
+ImageCache::SurfacePtr ImageCache::put(const Common::Path &path, const Graphics::PixelFormat &format, const Graphics::Surface &surface) {
+	if (!isCacheable(surface))
+		return SurfacePtr();
+
+	Graphics::Surface *copy = new Graphics::Surface();
+	copy->copyFrom(surface);
+	return put(path, format, copy);
+}
+
+ImageCache::SurfacePtr ImageCache::put(const Common::Path &path, const Graphics::PixelFormat &format, Graphics::Surface *surface) {
+	const SurfacePtr owned(surface, Graphics::SurfaceDeleter());
+	if (!surface || !isCacheable(*surface))
+		return owned;
+
+	// Surfaces evicted while still in use by their callers stay valid, as
+	// they are shared
+	const uint32 size = surface->h * surface->pitch;
+	const Common::String key = makeKey(path, format);
+	_cache.put(key, owned, size);
+
+	debug(5, "ImageCache: Added %s (%d bytes), %d of %d bytes in use", key.c_str(), size, _cache.getMemoryUsage(), _cache.getMemoryLimit());
+	return owned;
+}
+
+void ImageCache::clear() {
+	_cache.clear();
+}
+
+void ImageCache::setMemoryLimit(uint32 bytes) {
+	_cache.setMemoryLimit(bytes);
+}
+
+} // End of namespace Image
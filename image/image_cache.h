@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IMAGE_IMAGE_CACHE_H
+#define IMAGE_IMAGE_CACHE_H
+
+#include "common/hash-str.h"
+#include "common/lru-cache.h"
+#include "common/path.h"
+#include "common/ptr.h"
+#include "common/singleton.h"
+
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+
+namespace Image {
+
+/**
+ * @defgroup image_cache Decoded image cache
+ * @ingroup image
+ *
+ * @brief Process-wide cache of decoded images.
+ * @{
+ */
+
+/**
+ * A memory-bounded, least-recently-used cache of decoded images.
+ *
+ * Engines which load the same large images over and over, for example
+ * scene backgrounds when the player walks back and forth between rooms,
+ * can use it to skip the decoding on subsequent loads.
+ *
+ * Images are identified by their path inside the game data, together
+ * with the pixel format that was requested from the decoder. Callers
+ * which use the decoder's native format should pass a default-constructed
+ * PixelFormat. Only true color images are cached, since paletted images
+ * would also need their palette.
+ *
+ * Cached surfaces are shared and must not be modified. Callers which
+ * need to modify an image must copy it first.
+ *
+ * The cache is emptied whenever an engine is destroyed, since the paths
+ * are only unique within a game.
+ *
+ * Used in engines:
+ * - Wintermute
+ */
+class ImageCache : public Common::Singleton<ImageCache> {
+public:
+	typedef Common::SharedPtr<Graphics::Surface> SurfacePtr;
+
+	/**
+	 * Look up a decoded image.
+	 *
+	 * @param path    Path of the image file.
+	 * @param format  Pixel format requested from the decoder.
+	 * @return The cached surface, or an empty pointer if it is not cached.
+	 */
+	SurfacePtr get(const Common::Path &path, const Graphics::PixelFormat &format);
+
+	/**
+	 * Add a copy of a decoded image to the cache.
+	 *
+	 * Images which are paletted, or larger than the memory limit on
+	 * their own, are not cached. Least recently used images are evicted
+	 * to stay within the memory limit.
+	 *
+	 * @param path     Path of the image file.
+	 * @param format   Pixel format requested from the decoder.
+	 * @param surface  The decoded image.
+	 * @return The cached surface, or an empty pointer if it was not cached.
+	 */
+	SurfacePtr put(const Common::Path &path, const Graphics::PixelFormat &format, const Graphics::Surface &surface);
+
+	/**
+	 * Add a decoded image to the cache, without copying it.
+	 *
+	 * The cache takes over the surface, for example one handed over by
+	 * ImageDecoder::releaseSurface(). Images which cannot be cached are
+	 * still returned, but only the caller holds them then.
+	 *
+	 * @param path     Path of the image file.
+	 * @param format   Pixel format requested from the decoder.
+	 * @param surface  The decoded image, allocated with new and create().
+	 * @return The surface, shared with the cache if it was cached.
+	 */
+	SurfacePtr put(const Common::Path &path, const Graphics::PixelFormat &format, Graphics::Surface *surface);
+
+	/** Remove all images from the cache. */
+	void clear();
+
+	/** Set the maximum amount of pixel data kept in the cache, in bytes. */
+	void setMemoryLimit(uint32 bytes);
+
+	uint32 getMemoryLimit() const { return _cache.getMemoryLimit(); }
+	uint32 getMemoryUsage() const { return _cache.getMemoryUsage(); }
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	ImageCache();
+
+	static Common::String makeKey(const Common::Path &path, const Graphics::PixelFormat &format);
+	bool isCacheable(const Graphics::Surface &surface) const;
+
+	Common::LRUCache<Common::String, SurfacePtr, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> _cache;
+	uint32 _hits;
+	uint32 _misses;
+};
+
+/** @} */
+
+} // End of namespace Image
+
+#endif
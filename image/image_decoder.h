@@ -88,6 +88,18 @@ public:
 	 */
 	virtual const Graphics::Surface *getSurface() const = 0;
 
+	/**
+	 * Take over the decoded surface.
+	 *
+	 * The decoder no longer owns or returns the surface afterwards, but it
+	 * keeps the palette.
+	 *
+	 * @return The decoded surface, which the caller must free() and delete,
+	 *         or 0 if no surface is present or the decoder does not support
+	 *         handing it over.
+	 */
+	virtual Graphics::Surface *releaseSurface() { return 0; }
+
 	/**
 	 * Get the decoded palette.
 	 *
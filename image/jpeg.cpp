@@ -66,6 +66,15 @@ const Graphics::Surface *JPEGDecoder::getSurface() const {
 	return &_surface;
 }
 
+Graphics::Surface *JPEGDecoder::releaseSurface() {
+	if (!_surface.getPixels())
+		return 0;
+
+	Graphics::Surface *surface = new Graphics::Surface(_surface);
+	_surface = Graphics::Surface();
+	return surface;
+}
+
 void JPEGDecoder::destroy() {
 	_surface.free();
 }
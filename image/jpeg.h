@@ -56,6 +56,7 @@ public:
 	void destroy() override;
 	bool loadStream(Common::SeekableReadStream &str) override;
 	const Graphics::Surface *getSurface() const override;
+	Graphics::Surface *releaseSurface() override;
 	const Graphics::Palette &getPalette() const override { return _palette; }
 
 	// Codec API
@@ -7,6 +7,7 @@ MODULE_OBJS := \
 	cicn.o \
 	icocur.o \
 	iff.o \
+	image_cache.o \
 	jpeg.o \
 	neo.o \
 	pcx.o \
@@ -30,6 +30,7 @@
 
 #include "image/png.h"
 
+#include "graphics/blit.h"
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
@@ -52,6 +53,12 @@ PNGDecoder::~PNGDecoder() {
 	destroy();
 }
 
+Graphics::Surface *PNGDecoder::releaseSurface() {
+	Graphics::Surface *surface = _outputSurface;
+	_outputSurface = 0;
+	return surface;
+}
+
 void PNGDecoder::destroy() {
 	if (_outputSurface) {
 		_outputSurface->free();
@@ -152,6 +159,8 @@ bool PNGDecoder::loadStream(Common::SeekableReadStream &stream) {
 	png_uint_32 w, h;
 	uint32 rgbaPalette[256];
 	bool hasRgbaPalette = false;
+	// The format rows are decoded into, when they are converted while reading
+	Graphics::PixelFormat rowFormat;
 
 	png_get_IHDR(pngPtr, infoPtr, &w, &h, &bitDepth, &colorType, &interlaceType, NULL, NULL);
 	width = w;
@@ -220,7 +229,14 @@ bool PNGDecoder::loadStream(Common::SeekableReadStream &stream) {
 			png_set_expand(pngPtr);
 		}
 
-		_outputSurface->create(width, height, getByteOrderRgbaPixelFormat(isAlpha));
+		// Non-interlaced rows can be converted to the requested format one at a time
+		Graphics::PixelFormat decodeFormat = getByteOrderRgbaPixelFormat(isAlpha);
+		if (_outputPixelFormat.bytesPerPixel && _outputPixelFormat != decodeFormat && interlaceType == PNG_INTERLACE_NONE) {
+			rowFormat = decodeFormat;
+			decodeFormat = _outputPixelFormat;
+		}
+
+		_outputSurface->create(width, height, decodeFormat);
 		if (!_outputSurface->getPixels()) {
 			error("Could not allocate memory for output image.");
 		}
@@ -254,6 +270,17 @@ bool PNGDecoder::loadStream(Common::SeekableReadStream &stream) {
 				destRowP[xp] = rgbaPalette[rowPtr[xp]];
 		}
 
+		delete[] rowPtr;
+	} else if (rowFormat.bytesPerPixel) {
+		// Convert each row to the requested format as it is read
+		png_bytep rowPtr = new byte[width * rowFormat.bytesPerPixel];
+
+		for (int i = 0; i < height; i++) {
+			png_read_row(pngPtr, rowPtr, nullptr);
+			Graphics::crossBlit((byte *)_outputSurface->getBasePtr(0, i), rowPtr, _outputSurface->pitch, width * rowFormat.bytesPerPixel,
+			                    width, 1, _outputSurface->format, rowFormat);
+		}
+
 		delete[] rowPtr;
 	} else  if (interlaceType == PNG_INTERLACE_NONE) {
 		// PNGs without interlacing can simply be read row by row.
@@ -287,6 +314,10 @@ bool PNGDecoder::loadStream(Common::SeekableReadStream &stream) {
 	// Destroy libpng structures
 	png_destroy_read_struct(&pngPtr, &infoPtr, NULL);
 
+	// Convert whatever could not be converted while reading
+	if (_outputPixelFormat.bytesPerPixel && !_outputSurface->format.isCLUT8())
+		_outputSurface->convertToInPlace(_outputPixelFormat);
+
 	return true;
 #else
 	return false;
@@ -62,11 +62,28 @@ public:
 	bool loadStream(Common::SeekableReadStream &stream) override;
 	void destroy() override;
 	const Graphics::Surface *getSurface() const override { return _outputSurface; }
+	Graphics::Surface *releaseSurface() override;
 	const Graphics::Palette &getPalette() const override { return _palette; }
 	bool hasTransparentColor() const override { return _hasTransparentColor; }
 	uint32 getTransparentColor() const override { return _transparentColor; }
 	void setSkipSignature(bool skip) { _skipSignature = skip; }
 	void setKeepTransparencyPaletted(bool keep) { _keepTransparencyPaletted = keep; }
+
+	/**
+	 * Request the pixel format of decoded true color images.
+	 *
+	 * Rows are converted while they are decoded, which avoids converting
+	 * the whole image afterwards. Paletted images are still decoded to
+	 * CLUT8, unless they have per-entry alpha values.
+	 *
+	 * @return false if the format is not supported, true otherwise
+	 */
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format) {
+		if (format.bytesPerPixel < 2)
+			return false;
+		_outputPixelFormat = format;
+		return true;
+	}
 private:
 	Graphics::PixelFormat getByteOrderRgbaPixelFormat(bool isAlpha) const;
 
@@ -80,6 +97,9 @@ private:
 	bool _hasTransparentColor;
 	uint32 _transparentColor;
 
+	// Requested format for true color output, or 0 bytes per pixel for the native format
+	Graphics::PixelFormat _outputPixelFormat;
+
 	Graphics::Surface *_outputSurface;
 };
 
@@ -44,6 +44,15 @@ TGADecoder::~TGADecoder() {
 	destroy();
 }
 
+Graphics::Surface *TGADecoder::releaseSurface() {
+	if (!_surface.getPixels())
+		return 0;
+
+	Graphics::Surface *surface = new Graphics::Surface(_surface);
+	_surface = Graphics::Surface();
+	return surface;
+}
+
 void TGADecoder::destroy() {
 	_surface.free();
 	_colorMap.clear();
@@ -70,6 +70,7 @@ public:
 	virtual ~TGADecoder();
 	void destroy() override;
 	const Graphics::Surface *getSurface() const override { return &_surface; }
+	Graphics::Surface *releaseSurface() override;
 	const Graphics::Palette &getPalette() const override { return _colorMap; }
 	bool loadStream(Common::SeekableReadStream &stream) override;
 private:
@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "math/fft.h"
+#include "math/utils.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Math {
+
+// Swap the real and imaginary parts of both complex numbers
+static FORCEINLINE __m128 swapReIm(__m128 a) {
+	return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/**
+ * One split-radix pass over two complex numbers from each quarter of z at a
+ * time, computing exactly the same operations as the scalar TRANSFORM.
+ *
+ * With w = wre + i * wim, the scalar code computes a2 * conj(w) as (t1, t2)
+ * and a3 * w as (t5, t6), then combines their sum and difference with a0
+ * and a1.
+ */
+void FFT::passSSE2(Complex *z, const float *wre, unsigned int n) {
+	const unsigned int o1 = 2 * n;
+	const unsigned int o2 = 4 * n;
+	const unsigned int o3 = 6 * n;
+	const float *wim = wre + o1;
+
+	const __m128 negRe = _mm_castsi128_ps(_mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+	const __m128 negIm = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+
+	for (unsigned int i = 0; i < o1; i += 2) {
+		__m128 wr, wi;
+		if (i == 0) {
+			// The first element is TRANSFORM_ZERO, that is w = 1
+			wr = _mm_set_ps(wre[1], wre[1], 1.0f, 1.0f);
+			wi = _mm_set_ps(wim[-1], wim[-1], 0.0f, 0.0f);
+		} else {
+			// [wre[i], wre[i], wre[i + 1], wre[i + 1]]
+			const __m128 r = _mm_castpd_ps(_mm_load_sd((const double *)(wre + i)));
+			wr = _mm_unpacklo_ps(r, r);
+			// [wim[-i], wim[-i], wim[-i - 1], wim[-i - 1]]
+			const __m128 m = _mm_castpd_ps(_mm_load_sd((const double *)(wim - i - 1)));
+			wi = _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 1, 1));
+		}
+
+		float *p0 = &z[i].re;
+		float *p1 = &z[o1 + i].re;
+		float *p2 = &z[o2 + i].re;
+		float *p3 = &z[o3 + i].re;
+
+		const __m128 a0 = _mm_loadu_ps(p0);
+		const __m128 a1 = _mm_loadu_ps(p1);
+		const __m128 a2 = _mm_loadu_ps(p2);
+		const __m128 a3 = _mm_loadu_ps(p3);
+
+		// (t1, t2) = a2 * conj(w), (t5, t6) = a3 * w
+		const __m128 t12 = _mm_add_ps(_mm_mul_ps(a2, wr), _mm_xor_ps(_mm_mul_ps(swapReIm(a2), wi), negIm));
+		const __m128 t56 = _mm_add_ps(_mm_mul_ps(a3, wr), _mm_xor_ps(_mm_mul_ps(swapReIm(a3), wi), negRe));
+
+		// sum = (t5 + t1, t6 + t2), diff = (t5 - t1, t6 - t2) = (t3, -t4)
+		const __m128 sum = _mm_add_ps(t56, t12);
+		const __m128 diff = _mm_sub_ps(t56, t12);
+		// i * diff = (t4, t3)
+		const __m128 rot = _mm_xor_ps(swapReIm(diff), negRe);
+
+		_mm_storeu_ps(p0, _mm_add_ps(a0, sum));
+		_mm_storeu_ps(p2, _mm_sub_ps(a0, sum));
+		_mm_storeu_ps(p1, _mm_add_ps(a1, rot));
+		_mm_storeu_ps(p3, _mm_sub_ps(a1, rot));
+	}
+}
+
+} // End of namespace Math
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
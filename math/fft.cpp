@@ -26,20 +26,51 @@
 // Partly based on libdjbfft by D. J. Bernstein
 
 #include "math/fft.h"
-#include "math/cosinetables.h"
 #include "math/utils.h"
 #include "common/util.h"
 
+#if defined(SCUMMVM_SSE2) && !defined(__x86_64__) && !defined(_M_X64)
+#include "common/system.h"
+#endif
+
 namespace Math {
 
+static const float *createCosTable(int nPoints) {
+	// A pass only needs cos(2*pi*i/nPoints) for 0<=i<=nPoints/4, this is the
+	// first part of the table layout used by CosineTable::getTable()
+	float *table = new float[nPoints / 4 + 1];
+	const double radResolution = 2.0 * M_PI / nPoints;
+
+	for (int i = 0; i <= nPoints / 4; i++)
+		table[i] = cos(i * radResolution);
+
+	return table;
+}
+
+// The twiddle factors only depend on the size of the pass, so they are
+// created on first use and kept for the lifetime of the process
+template<int bits>
+static const float *getCosTable() {
+	static const float *const table = createCosTable(1 << bits);
+	return table;
+}
+
+static const float *(*const cosTableGetters[13])() = {
+	getCosTable<4>,  getCosTable<5>,  getCosTable<6>,  getCosTable<7>,
+	getCosTable<8>,  getCosTable<9>,  getCosTable<10>, getCosTable<11>,
+	getCosTable<12>, getCosTable<13>, getCosTable<14>, getCosTable<15>,
+	getCosTable<16>
+};
+
+static void pass(Complex *z, const float *wre, unsigned int n);
+static void pass_big(Complex *z, const float *wre, unsigned int n);
+
 FFT::FFT(int bits, int inverse) : _bits(bits), _inverse(inverse) {
 	assert((_bits >= 2) && (_bits <= 16));
 
 	int n = 1 << bits;
-	int nPoints;
 
 	_tmpBuf = new Complex[n];
-	_expTab = new Complex[n / 2];
 	_revTab = new uint16[n];
 
 	_splitRadix = 1;
@@ -48,22 +79,33 @@ FFT::FFT(int bits, int inverse) : _bits(bits), _inverse(inverse) {
 		_revTab[-splitRadixPermutation(i, n, _inverse) & (n - 1)] = i;
 
 	for (int i = 0; i < ARRAYSIZE(_cosTables); i++) {
-		if (i + 4 <= _bits) {
-			nPoints = 1 << (i + 4);
-			_cosTables[i] = new CosineTable(nPoints);
-		}
+		if (i + 4 <= _bits)
+			_cosTables[i] = cosTableGetters[i]();
 		else
 			_cosTables[i] = nullptr;
 	}
-}
 
-FFT::~FFT() {
-	for (int i = 0; i < ARRAYSIZE(_cosTables); i++) {
-		delete _cosTables[i];
+	_pass = pass;
+	_passBig = pass_big;
+
+#ifdef SCUMMVM_SSE2
+#if defined(__x86_64__) || defined(_M_X64)
+	// SSE2 is always available on x86_64
+	const bool hasSSE2 = true;
+#else
+	const bool hasSSE2 = g_system->hasFeature(OSystem::kFeatureCpuSSE2);
+#endif
+	if (hasSSE2) {
+		// The SSE2 pass loads all inputs before storing, so it also
+		// serves for the big passes
+		_pass = passSSE2;
+		_passBig = passSSE2;
 	}
+#endif
+}
 
+FFT::~FFT() {
 	delete[] _revTab;
-	delete[] _expTab;
 	delete[] _tmpBuf;
 }
 
@@ -220,7 +262,7 @@ void FFT::fft16(Complex *z) {
 	fft4(z + 12);
 
 	assert(_cosTables[0]);
-	const float * const cosTable = _cosTables[0]->getTable();
+	const float * const cosTable = _cosTables[0];
 
 	TRANSFORM_ZERO(z[0], z[4], z[8], z[12]);
 	TRANSFORM(z[2], z[6], z[10], z[14], sqrthalf, sqrthalf);
@@ -245,9 +287,9 @@ void FFT::fft(int n, int logn, Complex *z) {
 		fft((n / 4), logn - 2, z + (n / 4) * 3);
 		assert(_cosTables[logn - 4]);
 		if (n > 1024)
-			pass_big(z, _cosTables[logn - 4]->getTable(), (n / 4) / 2);
+			_passBig(z, _cosTables[logn - 4], (n / 4) / 2);
 		else
-			pass(z, _cosTables[logn - 4]->getTable(), (n / 4) / 2);
+			_pass(z, _cosTables[logn - 4], (n / 4) / 2);
 	}
 }
 
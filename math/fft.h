@@ -41,7 +41,6 @@ namespace Math {
  * @{
  */
 
-class CosineTable;
 struct Complex;
 
 /**
@@ -68,19 +67,28 @@ public:
 	void calc(Complex *z);
 
 private:
+	typedef void (*PassFunc)(Complex *z, const float *wre, unsigned int n);
+
 	int _bits;
 	int _inverse;
 
 	uint16 *_revTab;
 
-	Complex *_expTab;
 	Complex *_tmpBuf;
 
 	int _splitRadix;
 
 	static int splitRadixPermutation(int i, int n, int inverse);
 
-	CosineTable *_cosTables[13];
+	// Twiddle factors of each pass, shared by all instances
+	const float *_cosTables[13];
+
+	PassFunc _pass;
+	PassFunc _passBig;
+
+#ifdef SCUMMVM_SSE2
+	static void passSSE2(Complex *z, const float *wre, unsigned int n);
+#endif
 
 	void fft4(Complex *z);
 	void fft8(Complex *z);
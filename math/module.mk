@@ -24,5 +24,10 @@ MODULE_OBJS := \
 	vector3d.o \
 	vector4d.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	fft-sse2.o
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
@@ -0,0 +1,93 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer.h"
+#include "backends/mixer/null/null-mixer.h"
+
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "helper.h"
+#include "../system/null_osystem.h"
+
+// The mixer needs OSystem for its mutex
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class MixerTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		Common::install_null_g_system();
+	}
+
+	void tearDown() {
+		Common::uninstall_null_g_system();
+	}
+
+	void test_render_to_wav() {
+		// The null mixer mixes 2048 frames per callback at 22050 Hz
+		static const uint32 kCallbackFrames = 2048;
+
+		NullMixerManager manager;
+		manager.init();
+		Audio::Mixer *mixer = manager.getMixer();
+		TS_ASSERT_EQUALS(mixer->getOutputRate(), 22050u);
+
+		// stopRendering() deletes the stream, but not its buffer, which
+		// does not move when the header is completed
+		Common::MemoryWriteStreamDynamic *wav = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		manager.startRendering(wav);
+		TS_ASSERT(manager.isRendering());
+
+		int16 *expected;
+		Audio::SoundHandle handle;
+		mixer->playStream(Audio::Mixer::kMusicSoundType, &handle, createSineStream<int16>(22050, 1, &expected, true, true));
+
+		// Only whole callbacks are mixed
+		manager.renderUntil(500);
+		TS_ASSERT_EQUALS(wav->size(), 44 + 5 * kCallbackFrames * 4);
+
+		// update() does not mix while rendering
+		manager.update(1);
+		TS_ASSERT_EQUALS(wav->size(), 44 + 5 * kCallbackFrames * 4);
+
+		// Silence is written while audio is suspended
+		manager.renderUntil(1000);
+		manager.suspendAudio();
+		manager.renderUntil(1500);
+		manager.resumeAudio();
+
+		const uint32 dataSize = 16 * kCallbackFrames * 4;
+		byte *data = wav->getData();
+		TS_ASSERT_EQUALS(wav->size(), 44 + dataSize);
+
+		const Audio::MixerImpl::Profile profile = manager.stopRendering();
+		TS_ASSERT(!manager.isRendering());
+
+		TS_ASSERT_EQUALS(READ_BE_UINT32(data), MKTAG('R', 'I', 'F', 'F'));
+		TS_ASSERT_EQUALS(READ_LE_UINT32(data + 4), 36 + dataSize);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(data + 22), 2);
+		TS_ASSERT_EQUALS(READ_LE_UINT32(data + 24), 22050u);
+		TS_ASSERT_EQUALS(READ_LE_UINT32(data + 40), dataSize);
+
+		// The sine is mixed at full volume, then silence follows
+		bool matches = true;
+		for (uint32 i = 0; i < 10 * kCallbackFrames * 2; i++)
+			matches &= READ_LE_INT16(data + 44 + i * 2) == expected[i];
+		TS_ASSERT(matches);
+
+		bool silent = true;
+		for (uint32 i = 10 * kCallbackFrames * 2; i < dataSize / 2; i++)
+			silent &= READ_LE_INT16(data + 44 + i * 2) == 0;
+		TS_ASSERT(silent);
+
+		TS_ASSERT_EQUALS(profile.callbacks, 10u);
+		TS_ASSERT_EQUALS(profile.frames, 10u * kCallbackFrames);
+		TS_ASSERT_LESS_THAN_EQUALS(profile.typeTime[Audio::Mixer::kMusicSoundType], profile.mixTime);
+		TS_ASSERT_LESS_THAN_EQUALS(profile.maxCallbackTime, profile.mixTime);
+		TS_ASSERT_EQUALS(profile.typeTime[Audio::Mixer::kSFXSoundType], 0u);
+
+		free(data);
+		delete[] expected;
+	}
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#ifdef USE_MT32EMU
+
+#include "common/crc.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "audio/softsynth/mt32/BReverbModel.h"
+
+#include "../system/null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class MT32TestSuite : public CxxTest::TestSuite {
+	// The MT-32 runs at 32000 Hz
+	static const uint kSampleRate = 32000;
+	static const uint kRenderSamples = kSampleRate * 2;
+
+	/**
+	 * Feed a stereo test signal through a reverb model, in blocks of
+	 * varying size, and return the CRC32 of the interleaved output.
+	 *
+	 * The signal consists of noise bursts separated by silence, so both
+	 * the reverb tails and the input path are covered.
+	 */
+	uint32 renderReverb(MT32Emu::ReverbMode mode, bool mt32Compatible, MT32Emu::Bit8u time, MT32Emu::Bit8u level, int iterations = 1) {
+		MT32Emu::BReverbModel *reverb = MT32Emu::BReverbModel::createBReverbModel(mode, mt32Compatible, MT32Emu::RendererType_BIT16S);
+		reverb->open();
+		reverb->setParameters(time, level);
+
+		static const uint kBlockSizes[] = { 1, 7, 64, 256, 333 };
+		MT32Emu::IntSample inLeft[333], inRight[333], outLeft[333], outRight[333];
+		uint32 seed = 0x12345678;
+		Common::CRC32 crc32;
+		uint32 crc = crc32.getInitRemainder();
+
+		for (int iter = 0; iter < iterations; iter++) {
+			uint pos = 0;
+			uint block = 0;
+			while (pos < kRenderSamples) {
+				const uint size = MIN<uint>(kBlockSizes[block++ % ARRAYSIZE(kBlockSizes)], kRenderSamples - pos);
+
+				for (uint i = 0; i < size; i++) {
+					if ((pos + i) % 8000 < 2000) {
+						seed = seed * 1103515245 + 12345;
+						inLeft[i] = (MT32Emu::IntSample)(seed >> 16);
+						inRight[i] = (MT32Emu::IntSample)(seed >> 8);
+					} else {
+						inLeft[i] = inRight[i] = 0;
+					}
+				}
+
+				reverb->process(inLeft, inRight, outLeft, outRight, size);
+
+				for (uint i = 0; i < size; i++) {
+					crc = crc32.processByte(outLeft[i] & 0xFF, crc);
+					crc = crc32.processByte((outLeft[i] >> 8) & 0xFF, crc);
+					crc = crc32.processByte(outRight[i] & 0xFF, crc);
+					crc = crc32.processByte((outRight[i] >> 8) & 0xFF, crc);
+				}
+				pos += size;
+			}
+		}
+
+		delete reverb;
+		return crc32.finalize(crc);
+	}
+
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+#endif
+	}
+
+	void tearDown() {
+#if BENCHMARK_TIME
+		Common::uninstall_null_g_system();
+#endif
+	}
+
+	void test_reverb_golden_output() {
+		// Output of the upstream munt code, as CRC32 of the interleaved
+		// stereo samples. The ScummVM-local changes must not alter it.
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_ROOM, true, 5, 3), 0xA76791DEU);
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_HALL, true, 7, 7), 0x12957C45U);
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_PLATE, true, 2, 6), 0xFB70C7B4U);
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_TAP_DELAY, true, 7, 4), 0x951C7707U);
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_ROOM, false, 3, 5), 0x1746BDB5U);
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_PLATE, false, 6, 2), 0x353871E4U);
+		TS_ASSERT_EQUALS(renderReverb(MT32Emu::REVERB_MODE_TAP_DELAY, false, 1, 1), 0x5363A774U);
+	}
+
+	void test_reverb_speed() {
+#if BENCHMARK_TIME
+#ifdef SLOW_TESTS
+		const int iters = 500;
+#else
+		const int iters = 50;
+#endif
+		static const MT32Emu::ReverbMode kModes[] = {
+			MT32Emu::REVERB_MODE_ROOM, MT32Emu::REVERB_MODE_HALL,
+			MT32Emu::REVERB_MODE_PLATE, MT32Emu::REVERB_MODE_TAP_DELAY
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(kModes); i++) {
+			const uint32 start = g_system->getMillis();
+			renderReverb(kModes[i], true, 5, 5, iters);
+			const uint32 time = g_system->getMillis() - start;
+
+			const double seconds = (double)kRenderSamples * iters / kSampleRate;
+			debug("MT-32 reverb mode %d: %.0fx realtime", kModes[i], time ? seconds * 1000 / time : 0.0);
+		}
+#endif
+	}
+};
+
+#endif
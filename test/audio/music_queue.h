@@ -0,0 +1,263 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/music_queue.h"
+#include "audio/decoders/wave.h"
+
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "../system/null_osystem.h"
+
+// The queue needs OSystem for its mutexes
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+/**
+ * A track of known samples, which can spend some time setting up on the
+ * first read, like the decoder of a compressed music file.
+ */
+class MusicQueueTestTrack : public Audio::AudioStream {
+public:
+	MusicQueueTestTrack(int rate, bool stereo, int frames, int16 base, uint32 setupMs = 0) :
+			_rate(rate), _stereo(stereo), _samples(frames * (stereo ? 2 : 1)), _base(base), _setupMs(setupMs), _pos(0) {
+	}
+
+	static int16 sample(int16 base, int pos) {
+		return base + pos % 1000;
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		if (_setupMs) {
+			const uint32 start = g_system->getMillis();
+			while (g_system->getMillis() - start < _setupMs) {
+			}
+			_setupMs = 0;
+		}
+
+		const int samples = MIN(numSamples, _samples - _pos);
+		for (int i = 0; i < samples; i++)
+			buffer[i] = sample(_base, _pos++);
+		return samples;
+	}
+
+	bool isStereo() const override { return _stereo; }
+	int getRate() const override { return _rate; }
+	bool endOfData() const override { return _pos >= _samples; }
+
+private:
+	const int _rate;
+	const bool _stereo;
+	const int _samples;
+	const int16 _base;
+	uint32 _setupMs;
+	int _pos;
+};
+
+class MusicQueueTestSuite : public CxxTest::TestSuite {
+	// Read a stream until it ends, in reads of varying size, optionally
+	// topping up the queue between them like the timer proc would
+	static int readAll(Audio::MusicQueueStream *queue, int16 *buffer, int bufferSize, bool prefetch) {
+		int total = 0;
+		for (int i = 0; !queue->endOfData() && total < bufferSize; i++) {
+			const int read = queue->readBuffer(buffer + total, MIN(bufferSize - total, 2 * (100 + i * 37 % 900)));
+			if (read <= 0)
+				break;
+			total += read;
+
+			if (prefetch)
+				queue->prefetch();
+		}
+		return total;
+	}
+
+	static Common::SeekableReadStream *makeWAVFile(int rate, int frames, int16 base) {
+		const uint32 dataSize = frames * 2;
+		byte *wav = (byte *)malloc(44 + dataSize);
+
+		memcpy(wav, "RIFF", 4);
+		WRITE_LE_UINT32(wav + 4, 36 + dataSize);
+		memcpy(wav + 8, "WAVEfmt ", 8);
+		WRITE_LE_UINT32(wav + 16, 16);
+		WRITE_LE_UINT16(wav + 20, 1);
+		WRITE_LE_UINT16(wav + 22, 1);
+		WRITE_LE_UINT32(wav + 24, rate);
+		WRITE_LE_UINT32(wav + 28, rate * 2);
+		WRITE_LE_UINT16(wav + 32, 2);
+		WRITE_LE_UINT16(wav + 34, 16);
+		memcpy(wav + 36, "data", 4);
+		WRITE_LE_UINT32(wav + 40, dataSize);
+
+		for (int i = 0; i < frames; i++)
+			WRITE_LE_UINT16(wav + 44 + i * 2, MusicQueueTestTrack::sample(base, i));
+
+		return new Common::MemoryReadStream(wav, 44 + dataSize, DisposeAfterUse::YES);
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+	}
+
+	void tearDown() {
+		Audio::RenderAheadManager::destroy();
+		Common::uninstall_null_g_system();
+	}
+
+	void test_gapless() {
+		static const int kFrames[] = { 11025, 300, 7000 };
+		static const int kTotal = 2 * (11025 + 300 + 7000);
+
+		int16 *expected = new int16[kTotal];
+		int16 *buffer = new int16[kTotal + 64];
+
+		int pos = 0;
+		for (int track = 0; track < 3; track++) {
+			for (int i = 0; i < 2 * kFrames[track]; i++)
+				expected[pos++] = MusicQueueTestTrack::sample(track * 1000, i);
+		}
+
+		for (int prefetch = 0; prefetch < 2; prefetch++) {
+			Audio::MusicQueueStream queue(11025, true);
+			TS_ASSERT(queue.endOfData());
+
+			for (int track = 0; track < 3; track++)
+				queue.queueTrack(new MusicQueueTestTrack(11025, true, kFrames[track], track * 1000));
+			TS_ASSERT_EQUALS(queue.numQueuedTracks(), 3u);
+			TS_ASSERT(!queue.endOfData());
+
+			if (prefetch)
+				queue.prefetch();
+
+			memset(buffer, 0, kTotal * sizeof(int16));
+			TS_ASSERT_EQUALS(readAll(&queue, buffer, kTotal + 64, prefetch), kTotal);
+			TS_ASSERT_EQUALS(memcmp(buffer, expected, kTotal * sizeof(int16)), 0);
+
+			TS_ASSERT(queue.endOfData());
+			TS_ASSERT(!queue.endOfStream());
+			queue.finish();
+			TS_ASSERT(queue.endOfStream());
+
+			// Without the timer proc, the mixer has to render everything
+			TS_ASSERT_EQUALS(queue.getUnderruns() == 0, prefetch == 1);
+		}
+
+		delete[] buffer;
+		delete[] expected;
+	}
+
+	void test_crossfade() {
+		// 100 ms at 10 kHz is 1000 frames
+		static const int kFrames = 5000;
+		static const int kFade = 1000;
+		static const int kTotal = 2 * kFrames - kFade;
+
+		int16 *expected = new int16[kTotal];
+		int16 *buffer = new int16[kTotal + 64];
+
+		for (int i = 0; i < kTotal; i++) {
+			const int64 fadeIn = CLIP(i - (kFrames - kFade), 0, kFade);
+			const int64 a = i < kFrames ? MusicQueueTestTrack::sample(-8000, i) : 0;
+			const int64 b = i >= kFrames - kFade ? MusicQueueTestTrack::sample(8000, i - (kFrames - kFade)) : 0;
+
+			if (fadeIn == 0)
+				expected[i] = a;
+			else if (fadeIn == kFade)
+				expected[i] = b;
+			else
+				expected[i] = (int16)(((kFade - fadeIn) * a + fadeIn * b) / kFade);
+		}
+
+		for (int prefetch = 0; prefetch < 2; prefetch++) {
+			Audio::MusicQueueStream queue(10000, false);
+			queue.queueTrack(new MusicQueueTestTrack(10000, false, kFrames, -8000));
+			queue.queueTrack(new MusicQueueTestTrack(10000, false, kFrames, 8000), 100);
+			queue.finish();
+
+			TS_ASSERT_EQUALS(readAll(&queue, buffer, kTotal + 64, prefetch), kTotal);
+			TS_ASSERT_EQUALS(memcmp(buffer, expected, kTotal * sizeof(int16)), 0);
+			TS_ASSERT(queue.endOfStream());
+		}
+
+		delete[] buffer;
+		delete[] expected;
+	}
+
+	void test_decode_from_file() {
+		static const int kFrames = 4000;
+		int16 buffer[6 * kFrames];
+
+		Audio::MusicQueueStream queue(22050, false);
+		queue.queueTrack(makeWAVFile(22050, kFrames, 0), Audio::makeWAVStream);
+		// Tracks with a different format are converted
+		queue.queueTrack(makeWAVFile(11025, kFrames, 1000), Audio::makeWAVStream);
+		queue.queueTrack(new MusicQueueTestTrack(22050, true, kFrames, 1000));
+		queue.queueTrack(makeWAVFile(22050, kFrames, 2000), Audio::makeWAVStream);
+		queue.finish();
+
+		queue.prefetch();
+		const int total = readAll(&queue, buffer, 6 * kFrames, true);
+		TS_ASSERT_EQUALS(total, 5 * kFrames);
+		TS_ASSERT(queue.endOfStream());
+
+		for (int i = 0; i < kFrames; i++) {
+			TS_ASSERT_EQUALS(buffer[i], MusicQueueTestTrack::sample(0, i));
+			TS_ASSERT_EQUALS(buffer[total - kFrames + i], MusicQueueTestTrack::sample(2000, i));
+		}
+	}
+
+	void test_transition_speed() {
+		// Eight tracks of two seconds, each spending 20 ms to set up its
+		// decoder, played in mixer callbacks of 1024 frames. With a
+		// QueuingAudioStream the setup happens in the callback at each
+		// transition, with the music queue it happens in the timer proc.
+		static const int kTracks = 8;
+		static const int kRate = 22050;
+		static const int kCallbackSamples = 2 * 1024;
+
+		int16 *buffer = new int16[kCallbackSamples];
+		uint32 checksum[2] = { 0, 0 };
+		uint32 maxCallbackTime[2] = { 0, 0 };
+
+		Audio::QueuingAudioStream *queuing = Audio::makeQueuingAudioStream(kRate, true);
+		Audio::MusicQueueStream *music = new Audio::MusicQueueStream(kRate, true);
+
+		for (int track = 0; track < kTracks; track++) {
+			queuing->queueAudioStream(new MusicQueueTestTrack(kRate, true, 2 * kRate, track * 1000, 20));
+			music->queueTrack(new MusicQueueTestTrack(kRate, true, 2 * kRate, track * 1000, 20));
+		}
+		queuing->finish();
+		music->finish();
+
+		// The music queue is filled before it starts playing
+		music->prefetch();
+
+		for (int useQueue = 0; useQueue < 2; useQueue++) {
+			Audio::AudioStream *stream = useQueue ? (Audio::AudioStream *)music : queuing;
+
+			while (!stream->endOfStream()) {
+				const uint32 start = g_system->getMillis();
+				const int read = stream->readBuffer(buffer, kCallbackSamples);
+				maxCallbackTime[useQueue] = MAX(maxCallbackTime[useQueue], g_system->getMillis() - start);
+
+				for (int i = 0; i < read; i++)
+					checksum[useQueue] = checksum[useQueue] * 31 + buffer[i];
+
+				// Stands in for the timer proc running between callbacks
+				if (useQueue)
+					music->prefetch();
+			}
+		}
+
+		// Both play the same samples
+		TS_ASSERT_EQUALS(checksum[0], checksum[1]);
+		TS_ASSERT_EQUALS(music->getUnderruns(), 0u);
+
+		debug("Track transitions: longest callback %u ms with QueuingAudioStream, %u ms with MusicQueueStream, lowest buffer fill %u ms",
+		      maxCallbackTime[0], maxCallbackTime[1], music->getMinBufferedTime());
+
+		delete music;
+		delete queuing;
+		delete[] buffer;
+	}
+};
+
+#endif
@@ -0,0 +1,414 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/crc.h"
+#include "common/func.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+#include "audio/chip_capture.h"
+#include "audio/fmopl.h"
+#include "audio/softsynth/opl/dbopl.h"
+#include "audio/softsynth/opl/nuked.h"
+
+#include "../system/null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+/**
+ * A short OPL3 register script: melodic voices in 2-op and 4-op mode with
+ * vibrato, tremolo and feedback, followed by the rhythm section. Each entry
+ * is a register write, or a number of samples to render when reg is 0.
+ */
+struct OPLScriptEntry {
+	uint16 reg;
+	uint16 value;
+};
+
+static const OPLScriptEntry kOPLScript[] = {
+	{ 0x105, 0x01 }, { 0x104, 0x01 }, { 0x001, 0x20 }, { 0x0BD, 0xC0 },
+	// Channel 0: 4-op voice with channel 3, vibrato and tremolo
+	{ 0x020, 0xE1 }, { 0x023, 0x21 }, { 0x028, 0x31 }, { 0x02B, 0x01 },
+	{ 0x040, 0x1A }, { 0x043, 0x00 }, { 0x048, 0x20 }, { 0x04B, 0x02 },
+	{ 0x060, 0xF2 }, { 0x063, 0xF2 }, { 0x068, 0xA4 }, { 0x06B, 0xD3 },
+	{ 0x080, 0x24 }, { 0x083, 0x36 }, { 0x088, 0x15 }, { 0x08B, 0x27 },
+	{ 0x0E0, 0x01 }, { 0x0E3, 0x02 }, { 0x0E8, 0x00 }, { 0x0EB, 0x05 },
+	{ 0x0C0, 0x3E }, { 0x0C3, 0x31 },
+	{ 0x0A0, 0x98 }, { 0x0B0, 0x31 },
+	{ 0, 2000 },
+	// Channel 10 on the second register set: 2-op with feedback
+	{ 0x121, 0x02 }, { 0x124, 0x01 }, { 0x141, 0x10 }, { 0x144, 0x00 },
+	{ 0x161, 0xF4 }, { 0x164, 0xF4 }, { 0x181, 0x45 }, { 0x184, 0x56 },
+	{ 0x1E1, 0x03 }, { 0x1E4, 0x06 }, { 0x1C1, 0x1D },
+	{ 0x1A1, 0x57 }, { 0x1B1, 0x2E },
+	{ 0, 3000 },
+	{ 0x0A0, 0x20 }, { 0x0B0, 0x32 },
+	{ 0, 2500 },
+	{ 0x0B0, 0x12 }, { 0x1B1, 0x0E },
+	{ 0, 1500 },
+	// Rhythm section
+	{ 0x030, 0x01 }, { 0x033, 0x01 }, { 0x031, 0x01 }, { 0x034, 0x01 },
+	{ 0x032, 0x01 }, { 0x035, 0x01 },
+	{ 0x050, 0x00 }, { 0x053, 0x00 }, { 0x051, 0x03 }, { 0x054, 0x00 },
+	{ 0x052, 0x00 }, { 0x055, 0x05 },
+	{ 0x070, 0xF8 }, { 0x073, 0xF6 }, { 0x071, 0xF7 }, { 0x074, 0xF7 },
+	{ 0x072, 0xF9 }, { 0x075, 0xF5 },
+	{ 0x090, 0x77 }, { 0x093, 0x66 }, { 0x091, 0x55 }, { 0x094, 0x68 },
+	{ 0x092, 0x67 }, { 0x095, 0x58 },
+	{ 0x0C6, 0x30 }, { 0x0C7, 0x30 }, { 0x0C8, 0x30 },
+	{ 0x0A6, 0x57 }, { 0x0B6, 0x09 }, { 0x0A7, 0x03 }, { 0x0B7, 0x0A },
+	{ 0x0A8, 0x57 }, { 0x0B8, 0x09 },
+	{ 0x0BD, 0xFF },
+	{ 0, 1000 },
+	{ 0x0BD, 0xE0 },
+	{ 0, 800 },
+	{ 0x0BD, 0xF5 },
+	{ 0, 1200 },
+	{ 0x0BD, 0xC0 }, { 0x1B1, 0x0E },
+	{ 0, 4000 }
+};
+
+/**
+ * An OPL which remembers the writes it receives, and whose timer is
+ * driven by the test.
+ */
+class RecordingOPL : public OPL::OPL {
+public:
+	bool init() override { return true; }
+	void reset() override { _writes.push_back(0xFFFFFFFF); }
+	void write(int a, int v) override { _writes.push_back(0x10000000 | (a << 8) | v); }
+	void writeReg(int r, int v) override { _writes.push_back(0x20000000 | (r << 8) | v); }
+	void setCallbackFrequency(int timerFrequency) override { _frequency = timerFrequency; }
+
+	void tick() {
+		if (_callback && _callback->isValid())
+			(*_callback)();
+	}
+
+	Common::Array<uint32> _writes;
+	int _frequency = 0;
+
+protected:
+	void startCallbacks(int timerFrequency) override { _frequency = timerFrequency; }
+	void stopCallbacks() override { _frequency = 0; }
+};
+
+/**
+ * A write stream appending to an array, which outlives the stream.
+ */
+class ArrayWriteStream : public Common::WriteStream {
+public:
+	ArrayWriteStream(Common::Array<byte> &data) : _data(data) {}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) override {
+		for (uint32 i = 0; i < dataSize; i++)
+			_data.push_back(((const byte *)dataPtr)[i]);
+		return dataSize;
+	}
+
+	int64 pos() const override { return _data.size(); }
+
+private:
+	Common::Array<byte> &_data;
+};
+
+class OPLTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+#endif
+	}
+
+	void tearDown() {
+#if BENCHMARK_TIME
+		Common::uninstall_null_g_system();
+#endif
+	}
+
+#ifndef DISABLE_NUKED_OPL
+	void test_nuked_golden_output() {
+		// Output of the reference implementation for kOPLScript, as CRC32
+		// of the interleaved stereo samples
+		int peak = 0;
+		TS_ASSERT_EQUALS(renderNuked(44100, 1, &peak), 0x977ADA67U);
+		TS_ASSERT_LESS_THAN(1000, peak);
+		TS_ASSERT_EQUALS(renderNuked(49716, 1), 0xE140DBE1U);
+		TS_ASSERT_EQUALS(renderNuked(22050, 1), 0x4B7D4E91U);
+	}
+
+	void test_nuked_speed() {
+#if BENCHMARK_TIME
+#ifdef SLOW_TESTS
+		const int iters = 20;
+#else
+		const int iters = 1;
+#endif
+		uint32 start = g_system->getMillis();
+		renderNuked(44100, iters);
+		uint32 nukedTime = g_system->getMillis() - start;
+
+		uint32 dosboxTime = 0;
+#ifndef DISABLE_DOSBOX_OPL
+		start = g_system->getMillis();
+		renderDOSBox(44100, iters);
+		dosboxTime = g_system->getMillis() - start;
+#endif
+
+		const double samples = (double)scriptLength() * iters;
+		debug("OPL at 44100 Hz: Nuked %.0f samples/s, DOSBox %.0f samples/s",
+		      nukedTime ? samples * 1000 / nukedTime : 0.0,
+		      dosboxTime ? samples * 1000 / dosboxTime : 0.0);
+#endif
+	}
+#endif
+
+	void test_capture_round_trip() {
+		Common::Array<byte> data;
+		Common::Array<uint32> expected;
+		uint ticks = 0;
+
+		recordScript(data, expected, ticks);
+
+		Common::MemoryReadStream stream(data.data(), data.size());
+		Audio::ChipCapturePlayer player(stream);
+		TS_ASSERT(player.isValid());
+		TS_ASSERT_EQUALS(player.getChip(), Audio::kCaptureChipOPL);
+		TS_ASSERT_EQUALS(player.getType(), OPL::Config::kOpl3);
+
+		// Replaying onto another OPL gives the same writes and timing
+		RecordingOPL replay;
+		int frequency = 0;
+		uint replayedTicks = 0;
+		uint n;
+		while ((n = player.playTicks(replay, frequency)) != 0)
+			replayedTicks += n;
+
+		TS_ASSERT_EQUALS(frequency, 250);
+		TS_ASSERT_EQUALS(replayedTicks, ticks);
+		TS_ASSERT(replay._writes == expected);
+	}
+
+	void test_capture_invalid() {
+		const byte data[] = { 'C', 'H', 'P', 'X', 2, 0, 0 };
+		Common::MemoryReadStream stream(data, sizeof(data));
+		Audio::ChipCapturePlayer player(stream);
+		TS_ASSERT(!player.isValid());
+
+		Audio::CaptureEvent event;
+		TS_ASSERT(!player.readEvent(event));
+	}
+
+#ifndef DISABLE_NUKED_OPL
+	void test_capture_replay_nuked() {
+		Common::Array<byte> data;
+		Common::Array<uint32> expected;
+		uint ticks = 0;
+
+		recordScript(data, expected, ticks);
+
+#if BENCHMARK_TIME
+		uint32 start = g_system->getMillis();
+#endif
+		uint32 samples = 0;
+		const uint32 checksum = replayNuked(data, 44100, samples);
+		TS_ASSERT_EQUALS(samples, ticks * 44100 / 250);
+
+		// Replaying is deterministic
+		uint32 samples2 = 0;
+		TS_ASSERT_EQUALS(replayNuked(data, 44100, samples2), checksum);
+
+#if BENCHMARK_TIME
+		uint32 time = g_system->getMillis() - start;
+		debug("OPL capture replay on Nuked: %d ticks, %.1fx realtime, checksum %08x", ticks,
+		      time ? 2.0 * samples / 44.1 / time : 0.0, checksum);
+#endif
+	}
+#endif
+
+private:
+	void onTimer() {
+		_engineTicks++;
+	}
+
+	/**
+	 * Record kOPLScript through a CaptureOPL, with the sample counts
+	 * turned into timer callbacks at 250 Hz.
+	 */
+	void recordScript(Common::Array<byte> &data, Common::Array<uint32> &writes, uint &ticks) {
+		RecordingOPL *opl = new RecordingOPL();
+		OPL::CaptureOPL *capture = new OPL::CaptureOPL(opl, new ArrayWriteStream(data), Audio::kCaptureChipOPL, OPL::Config::kOpl3);
+
+		_engineTicks = 0;
+		capture->start(new Common::Functor0Mem<void, OPLTestSuite>(this, &OPLTestSuite::onTimer), 250);
+		TS_ASSERT_EQUALS(opl->_frequency, 250);
+
+		capture->reset();
+		for (uint i = 0; i < ARRAYSIZE(kOPLScript); i++) {
+			if (kOPLScript[i].reg) {
+				// Use both ways of writing
+				if (i & 1) {
+					capture->writeReg(kOPLScript[i].reg, kOPLScript[i].value);
+				} else {
+					capture->write(0x388 + ((kOPLScript[i].reg >> 7) & 2), kOPLScript[i].reg & 0xFF);
+					capture->write(0x389 + ((kOPLScript[i].reg >> 7) & 2), kOPLScript[i].value);
+				}
+				continue;
+			}
+
+			const uint n = MAX<uint>(kOPLScript[i].value * 250 / 44100, 1);
+			for (uint j = 0; j < n; j++)
+				opl->tick();
+			ticks += n;
+		}
+
+		TS_ASSERT_EQUALS(_engineTicks, ticks);
+		writes = opl->_writes;
+
+		delete capture;
+	}
+
+#ifndef DISABLE_NUKED_OPL
+	static uint32 replayNuked(const Common::Array<byte> &data, uint32 rate, uint32 &samples) {
+		Common::MemoryReadStream stream(data.data(), data.size());
+		Audio::ChipCapturePlayer player(stream);
+
+		OPL::NUKED::opl3_chip *chip = new OPL::NUKED::opl3_chip();
+		OPL::NUKED::OPL3_Reset(chip, rate);
+
+		Common::CRC32 crc;
+		uint32 sum = crc.getInitRemainder();
+		uint32 address = 0;
+		int frequency = OPL::OPL::kDefaultCallbackFrequency;
+		uint32 samplesDue = 0;
+
+		Audio::CaptureEvent event;
+		while (player.readEvent(event)) {
+			switch (event.type) {
+			case Audio::kCaptureWrite:
+				if (event.param & 1)
+					OPL::NUKED::OPL3_WriteRegBuffered(chip, address, event.value);
+				else
+					address = event.value | ((event.param << 7) & 0x100);
+				break;
+			case Audio::kCaptureWriteReg:
+				OPL::NUKED::OPL3_WriteRegBuffered(chip, event.param, event.value);
+				break;
+			case Audio::kCaptureFrequency:
+				frequency = event.param;
+				break;
+			case Audio::kCaptureReset:
+				OPL::NUKED::OPL3_Reset(chip, rate);
+				break;
+			case Audio::kCaptureTicks:
+				for (uint i = 0; i < event.param; i++) {
+					// Spread the remainder of rate / frequency over the ticks
+					samplesDue += rate;
+					const uint32 n = samplesDue / frequency;
+					samplesDue %= frequency;
+
+					for (uint32 j = 0; j < n; j += 256) {
+						int16 buf[2 * 256];
+						const uint32 count = MIN<uint32>(n - j, 256);
+						OPL::NUKED::OPL3_GenerateStream(chip, buf, count);
+						for (uint k = 0; k < 2 * count; k++) {
+							sum = crc.processByte(buf[k] & 0xFF, sum);
+							sum = crc.processByte((buf[k] >> 8) & 0xFF, sum);
+						}
+					}
+					samples += n;
+				}
+				break;
+			}
+		}
+
+		delete chip;
+		return crc.finalize(sum);
+	}
+#endif
+
+	uint _engineTicks;
+
+	static uint scriptLength() {
+		uint length = 0;
+		for (uint i = 0; i < ARRAYSIZE(kOPLScript); i++)
+			if (!kOPLScript[i].reg)
+				length += kOPLScript[i].value;
+		return length;
+	}
+
+#ifndef DISABLE_NUKED_OPL
+	static uint32 renderNuked(uint32 rate, int iters, int *peak = nullptr) {
+		OPL::NUKED::opl3_chip *chip = new OPL::NUKED::opl3_chip();
+		Common::CRC32 crc;
+		uint32 sum = 0;
+
+		for (int i = 0; i < iters; i++) {
+			OPL::NUKED::OPL3_Reset(chip, rate);
+			sum = crc.getInitRemainder();
+
+			for (uint j = 0; j < ARRAYSIZE(kOPLScript); j++) {
+				if (kOPLScript[j].reg) {
+					OPL::NUKED::OPL3_WriteRegBuffered(chip, kOPLScript[j].reg, kOPLScript[j].value);
+					continue;
+				}
+
+				// Render in uneven pieces, like the mixer does
+				uint remaining = kOPLScript[j].value;
+				while (remaining) {
+					int16 buf[2 * 333];
+					const uint n = MIN<uint>(remaining, 333);
+					OPL::NUKED::OPL3_GenerateStream(chip, buf, n);
+					for (uint k = 0; k < 2 * n; k++) {
+						if (peak)
+							*peak = MAX<int>(*peak, ABS<int>(buf[k]));
+						sum = crc.processByte(buf[k] & 0xFF, sum);
+						sum = crc.processByte((buf[k] >> 8) & 0xFF, sum);
+					}
+					remaining -= n;
+				}
+			}
+		}
+
+		delete chip;
+		return crc.finalize(sum);
+	}
+#endif
+
+#ifndef DISABLE_DOSBOX_OPL
+	static void renderDOSBox(uint32 rate, int iters) {
+		OPL::DOSBox::DBOPL::InitTables();
+		OPL::DOSBox::DBOPL::Chip *chip = new OPL::DOSBox::DBOPL::Chip();
+
+		for (int i = 0; i < iters; i++) {
+			chip->Setup(rate);
+
+			for (uint j = 0; j < ARRAYSIZE(kOPLScript); j++) {
+				if (kOPLScript[j].reg) {
+					chip->WriteReg(kOPLScript[j].reg, kOPLScript[j].value);
+					continue;
+				}
+
+				uint remaining = kOPLScript[j].value;
+				while (remaining) {
+					int32 buf[2 * 333];
+					const uint n = MIN<uint>(remaining, 333);
+					chip->GenerateBlock3(n, buf);
+					remaining -= n;
+				}
+			}
+		}
+
+		delete chip;
+	}
+#endif
+};
@@ -0,0 +1,124 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/render_ahead.h"
+
+#include "common/mutex.h"
+#include "common/system.h"
+
+#include "../system/null_osystem.h"
+
+// The streams need OSystem for their mutexes
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class RenderAheadTestSuite : public CxxTest::TestSuite {
+	// An emulated chip counting up, whose timer callback locks the mixer
+	// like those of Player_AD and SciMusic do
+	class CountingChip : public Audio::AudioStream {
+	public:
+		CountingChip(Common::Mutex &mixerMutex) :
+				mixer(nullptr), mixerSamples(0), _mixerMutex(mixerMutex), _next(0), _depth(0), _maxDepth(0) {}
+
+		int readBuffer(int16 *buffer, const int numSamples) override {
+			_depth++;
+			_maxDepth = MAX(_maxDepth, _depth);
+
+			{
+				Common::StackLock lock(_mixerMutex);
+
+				// The mixer callback runs meanwhile on another thread
+				if (mixer) {
+					Audio::AudioStream *stream = mixer;
+					mixer = nullptr;
+					mixerSamples = stream->readBuffer(mixerBuffer, ARRAYSIZE(mixerBuffer));
+				}
+			}
+
+			for (int i = 0; i < numSamples; i++)
+				buffer[i] = _next++;
+
+			_depth--;
+			return numSamples;
+		}
+
+		bool isStereo() const override { return false; }
+		int getRate() const override { return 22050; }
+		bool endOfData() const override { return false; }
+
+		int getMaxDepth() const { return _maxDepth; }
+
+		Audio::AudioStream *mixer;
+		int16 mixerBuffer[64];
+		int mixerSamples;
+
+	private:
+		Common::Mutex &_mixerMutex;
+		int16 _next;
+		int _depth;
+		int _maxDepth;
+	};
+
+	static bool isCounting(const int16 *buffer, int numSamples, int16 first) {
+		for (int i = 0; i < numSamples; i++) {
+			if (buffer[i] != (int16)(first + i))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+	}
+
+	void tearDown() {
+		Audio::RenderAheadManager::destroy();
+		Common::uninstall_null_g_system();
+	}
+
+	void test_prefetch() {
+		Common::Mutex mixerMutex;
+		CountingChip chip(mixerMutex);
+		Audio::RenderAheadStream stream(&chip, 50);
+
+		stream.prefetch();
+
+		int16 buffer[1000];
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 1000), 1000);
+		TS_ASSERT(isCounting(buffer, 1000, 0));
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 0u);
+
+		// The mixer renders what is missing itself
+		TS_ASSERT_EQUALS(stream.readBuffer(buffer, 1000), 1000);
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 1u);
+		TS_ASSERT(isCounting(buffer, 1000, 1000));
+	}
+
+	void test_mixer_callback_during_render() {
+		Common::Mutex mixerMutex;
+		CountingChip chip(mixerMutex);
+		Audio::RenderAheadStream stream(&chip, 50);
+
+		// The buffer is empty while the timer proc renders the chip, and
+		// the mixer callback arrives while the chip callback locks the
+		// mixer. It must neither wait for the timer proc nor render the
+		// chip at the same time.
+		chip.mixer = &stream;
+		stream.prefetch();
+
+		TS_ASSERT_EQUALS(chip.getMaxDepth(), 1);
+		TS_ASSERT_EQUALS(chip.mixerSamples, 64);
+		TS_ASSERT_EQUALS(stream.getUnderruns(), 1u);
+
+		bool silent = true;
+		for (int i = 0; i < 64; i++)
+			silent &= chip.mixerBuffer[i] == 0;
+		TS_ASSERT(silent);
+
+		// No samples are lost, the silence only delays them
+		int16 buffer[256];
+		stream.readBuffer(buffer, 256);
+		TS_ASSERT(isCounting(buffer, 256, 0));
+	}
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/sound_cache.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/adpcm.h"
+
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "helper.h"
+#include "../system/null_osystem.h"
+
+// The cache needs OSystem for its mutex
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class SoundCacheTestSuite : public CxxTest::TestSuite {
+	// Read a stream completely and return the number of samples
+	static int readAll(Audio::AudioStream *stream, int16 *buffer, int bufferSize) {
+		int total = 0;
+		while (!stream->endOfData() && total < bufferSize) {
+			const int read = stream->readBuffer(buffer + total, bufferSize - total);
+			if (read <= 0)
+				break;
+			total += read;
+		}
+		return total;
+	}
+
+	static Audio::SeekableAudioStream *makeADPCMSound(const byte *data, uint32 size) {
+		return Audio::makeADPCMStream(new Common::MemoryReadStream(data, size), DisposeAfterUse::YES, size, Audio::kADPCMDVI, 22050, 1);
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+	}
+
+	void tearDown() {
+		Audio::SoundCache::destroy();
+		Common::uninstall_null_g_system();
+	}
+
+	void test_get_put() {
+		Audio::SoundCache &cache = Audio::SoundCache::instance();
+
+		int16 *expected;
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(11025, 1, &expected, true, true);
+
+		TS_ASSERT(!cache.get("sfx/step.ogg"));
+		Audio::SeekableAudioStream *cached = cache.put("sfx/step.ogg", 0, stream);
+		TS_ASSERT(cached);
+		TS_ASSERT_DIFFERS(cached, stream);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 1u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 11025u * 2u * 2u);
+
+		// Another sound in the same archive
+		TS_ASSERT(!cache.get("sfx/step.ogg", 1024));
+
+		Audio::SeekableAudioStream *hit = cache.get("SFX/STEP.OGG");
+		TS_ASSERT(hit);
+		TS_ASSERT(hit->isStereo());
+		TS_ASSERT_EQUALS(hit->getRate(), 11025);
+		TS_ASSERT_EQUALS(hit->getLength().totalNumberOfFrames(), 11025);
+
+		int16 *buffer = new int16[11025 * 2 + 16];
+		TS_ASSERT_EQUALS(readAll(cached, buffer, 11025 * 2 + 16), 11025 * 2);
+		TS_ASSERT_EQUALS(memcmp(buffer, expected, 11025 * 2 * sizeof(int16)), 0);
+
+		memset(buffer, 0, 11025 * 2 * sizeof(int16));
+		TS_ASSERT_EQUALS(readAll(hit, buffer, 11025 * 2 + 16), 11025 * 2);
+		TS_ASSERT_EQUALS(memcmp(buffer, expected, 11025 * 2 * sizeof(int16)), 0);
+		TS_ASSERT(hit->endOfData());
+
+		// Seek to frame 100, which is sample 200 in stereo
+		TS_ASSERT(hit->seek(Audio::Timestamp(0, 100, 11025)));
+		TS_ASSERT_EQUALS(hit->readBuffer(buffer, 4), 4);
+		TS_ASSERT_EQUALS(memcmp(buffer, expected + 200, 4 * sizeof(int16)), 0);
+		TS_ASSERT(!hit->seek(Audio::Timestamp(0, 20000, 11025)));
+
+		TS_ASSERT_EQUALS(cache.getHits(), 1u);
+		TS_ASSERT_EQUALS(cache.getMisses(), 2u);
+
+		delete[] buffer;
+		delete[] expected;
+		delete cached;
+		delete hit;
+	}
+
+	void test_too_long() {
+		Audio::SoundCache &cache = Audio::SoundCache::instance();
+		cache.setSoundLimit(11025 * 2);
+
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(11025, 2, nullptr, true, false);
+		TS_ASSERT_EQUALS(cache.put("music.ogg", 0, stream), stream);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+		TS_ASSERT(!cache.get("music.ogg"));
+
+		// The stream was not read
+		TS_ASSERT_EQUALS(stream->getLength().totalNumberOfFrames(), 22050);
+		TS_ASSERT(!stream->endOfData());
+		delete stream;
+
+		// A limit of 0 disables the cache
+		cache.setMemoryLimit(0);
+		stream = createSineStream<int16>(11025, 1, nullptr, true, false);
+		TS_ASSERT_EQUALS(cache.put("click.ogg", 0, stream), stream);
+		delete stream;
+	}
+
+	void test_eviction() {
+		Audio::SoundCache &cache = Audio::SoundCache::instance();
+		cache.setMemoryLimit(2 * 11025 * 2);
+
+		Audio::SeekableAudioStream *first = cache.put("a.ogg", 0, createSineStream<int16>(11025, 1, nullptr, true, false));
+		delete cache.put("b.ogg", 0, createSineStream<int16>(11025, 1, nullptr, true, false));
+		delete cache.get("a.ogg");
+
+		// b.ogg is now the least recently used sound
+		delete cache.put("c.ogg", 0, createSineStream<int16>(11025, 1, nullptr, true, false));
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 2u);
+		TS_ASSERT(!cache.get("b.ogg"));
+
+		// Streams handed out before keep playing after eviction
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+		int16 buffer[16];
+		TS_ASSERT_EQUALS(first->readBuffer(buffer, 16), 16);
+		TS_ASSERT_EQUALS(first->getLength().totalNumberOfFrames(), 11025);
+		delete first;
+	}
+
+	void test_stream_outlives_cache() {
+		// The mixer may destroy its streams after the engine destroyed the cache
+		Audio::SeekableAudioStream *stream = Audio::SoundCache::instance().put("a.ogg", 0, createSineStream<int16>(11025, 1, nullptr, true, false));
+		Audio::SeekableAudioStream *hit = Audio::SoundCache::instance().get("a.ogg");
+		TS_ASSERT(hit);
+		Audio::SoundCache::destroy();
+
+		int16 buffer[16];
+		TS_ASSERT_EQUALS(hit->readBuffer(buffer, 16), 16);
+		delete hit;
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, 16), 16);
+		delete stream;
+	}
+
+	void test_sfx_scene_speed() {
+		// A scene playing 8 ADPCM sound effects of half a second in random
+		// order, 400 times, with and without the cache
+		static const int kSounds = 8;
+		static const int kPlays = 400;
+		static const uint32 kSoundSize = 22050 / 2 / 2;
+
+		byte *data = new byte[kSounds * kSoundSize];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kSounds * kSoundSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 24;
+		}
+
+		Audio::SoundCache &cache = Audio::SoundCache::instance();
+		int16 *buffer = new int16[22050];
+		uint32 checksum[2] = { 0, 0 };
+		uint32 time[2];
+
+		for (int useCache = 0; useCache < 2; useCache++) {
+			const uint32 start = g_system->getMillis();
+			seed = 1;
+
+			for (int i = 0; i < kPlays; i++) {
+				seed = seed * 1103515245 + 12345;
+				const int sound = (seed >> 16) % kSounds;
+				const Common::Path path(Common::String::format("sfx%d.wav", sound));
+
+				Audio::SeekableAudioStream *stream = useCache ? cache.get(path) : nullptr;
+				if (!stream) {
+					stream = makeADPCMSound(data + sound * kSoundSize, kSoundSize);
+					if (useCache)
+						stream = cache.put(path, 0, stream);
+				}
+
+				const int samples = readAll(stream, buffer, 22050);
+				checksum[useCache] += samples + buffer[samples / 2];
+				delete stream;
+			}
+
+			time[useCache] = g_system->getMillis() - start;
+		}
+
+		// The cached sounds must play exactly like the decoded ones
+		TS_ASSERT_EQUALS(checksum[0], checksum[1]);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), (uint32)kSounds);
+		TS_ASSERT_EQUALS(cache.getHits(), (uint32)(kPlays - kSounds));
+
+		debug("SFX scene: %u ms decoding every time, %u ms with the sound cache", time[0], time[1]);
+
+		delete[] buffer;
+		delete[] data;
+	}
+};
+
+#endif
@@ -0,0 +1,230 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/saves/default/async-saves.h"
+#include "backends/saves/default/default-saves.h"
+
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+#include "common/system.h"
+
+#include "../system/null_osystem.h"
+
+// The save file manager needs OSystem for the file system and its mutexes
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class DefaultSaveFileManagerTestSuite : public CxxTest::TestSuite {
+	static const uint32 kSaveSize = 4 * 1024 * 1024;
+
+	DefaultSaveFileManager *_saveFileMan;
+	Common::FSNode _savePath;
+	byte *_data;
+
+	// Engine state which compresses about as well as real saves do
+	static void fillSaveData(byte *data, uint32 size, uint32 seed) {
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (seed >> 16) & 0x0F ? (byte)(i >> 6) : (byte)(seed >> 24);
+		}
+	}
+
+	bool loadMatches(const Common::String &name, const byte *data, uint32 size) {
+		Common::InSaveFile *file = _saveFileMan->openForLoading(name);
+		if (!file)
+			return false;
+
+		byte *buffer = new byte[size + 1];
+		const bool matches = file->read(buffer, size + 1) == size && memcmp(buffer, data, size) == 0;
+		delete[] buffer;
+		delete file;
+		return matches;
+	}
+
+	// Return how many milliseconds the caller spent writing the save
+	uint32 save(const Common::String &name, const byte *data, uint32 size) {
+		const uint32 start = g_system->getMillis();
+		Common::OutSaveFile *file = _saveFileMan->openForSaving(name);
+		TS_ASSERT(file);
+		if (!file)
+			return 0;
+
+		file->write(data, size);
+		file->finalize();
+		TS_ASSERT(!file->err());
+		delete file;
+		return g_system->getMillis() - start;
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+
+		_savePath = Common::FSNode(Common::Path("saves-test"));
+		if (!_savePath.exists())
+			_savePath.createDirectory();
+		ConfMan.setPath("savepath", _savePath.getPath(), Common::ConfigManager::kTransientDomain);
+
+		_saveFileMan = new DefaultSaveFileManager();
+		_data = new byte[kSaveSize];
+		fillSaveData(_data, kSaveSize, 1);
+	}
+
+	void tearDown() {
+		Common::StringArray files = _saveFileMan->listSavefiles("test.*");
+		files.push_back(_saveFileMan->listSavefiles("scummvm-*.lz4dict"));
+		for (uint i = 0; i < files.size(); i++)
+			_saveFileMan->removeSavefile(files[i]);
+
+		delete _saveFileMan;
+		delete[] _data;
+		ConfMan.removeKey("savepath", Common::ConfigManager::kTransientDomain);
+		ConfMan.removeKey("save_compression", Common::ConfigManager::kTransientDomain);
+		Common::uninstall_null_g_system();
+
+		// The directory is empty by now
+		remove(_savePath.getPath().toString(Common::Path::kNativeSeparator).c_str());
+	}
+
+	void test_background_save() {
+		_saveFileMan->setBackgroundSaving(true);
+		save("test.000", _data, kSaveSize);
+		_saveFileMan->setBackgroundSaving(false);
+
+		// Only the timer proc compresses the file, which the tests do not have
+		TS_ASSERT(_saveFileMan->hasPendingSaves());
+		TS_ASSERT(_saveFileMan->exists("test.000"));
+		TS_ASSERT(!_savePath.getChild("test.000").exists());
+
+		// Loading waits for the file
+		TS_ASSERT(loadMatches("test.000", _data, kSaveSize));
+		TS_ASSERT(!_saveFileMan->hasPendingSaves());
+		TS_ASSERT(!_savePath.getChild("test.000.tmp").exists());
+		TS_ASSERT(_saveFileMan->waitForPendingSaves());
+	}
+
+	void test_timer_proc_does_no_file_io() {
+		_saveFileMan->setBackgroundSaving(true);
+		save("test.000", _data, kSaveSize);
+		_saveFileMan->setBackgroundSaving(false);
+
+		// The timer proc only compresses the file in memory, as it also
+		// drives the music
+		AsyncSaveWriter::instance().compress(kSaveSize);
+		TS_ASSERT(!_saveFileMan->hasPendingSaves());
+		TS_ASSERT(!_savePath.getChild("test.000").exists());
+		TS_ASSERT(!_savePath.getChild("test.000.tmp").exists());
+
+		// The game thread writes it
+		TS_ASSERT(_saveFileMan->waitForPendingSaves());
+		TS_ASSERT(_savePath.getChild("test.000").exists());
+		TS_ASSERT(loadMatches("test.000", _data, kSaveSize));
+	}
+
+	void test_failed_save_keeps_previous() {
+		save("test.001", _data, 1000);
+
+		// The temporary file cannot be created where a directory is
+		Common::FSNode tempNode = _savePath.getChild("test.001.tmp");
+		TS_ASSERT(tempNode.createDirectory());
+
+		_saveFileMan->setBackgroundSaving(true);
+		save("test.001", _data + 1000, 1000);
+		_saveFileMan->setBackgroundSaving(false);
+
+		TS_ASSERT(!_saveFileMan->waitForPendingSaves());
+		TS_ASSERT_EQUALS(_saveFileMan->getError().getCode(), Common::kCreatingFileFailed);
+		TS_ASSERT(loadMatches("test.001", _data, 1000));
+
+		remove(tempNode.getPath().toString(Common::Path::kNativeSeparator).c_str());
+	}
+
+	void test_autosave_stall() {
+		// Time the game spends in an autosave, with the save written as
+		// before and in the background
+		const uint32 stall = save("test.002", _data, kSaveSize);
+
+		_saveFileMan->setBackgroundSaving(true);
+		const uint32 backgroundStall = save("test.003", _data, kSaveSize);
+		_saveFileMan->setBackgroundSaving(false);
+
+		const uint32 start = g_system->getMillis();
+		TS_ASSERT(_saveFileMan->waitForPendingSaves());
+		const uint32 backgroundTime = g_system->getMillis() - start;
+
+		TS_ASSERT(loadMatches("test.002", _data, kSaveSize));
+		TS_ASSERT(loadMatches("test.003", _data, kSaveSize));
+
+		debug("Autosave of %u KB: game stalled %u ms writing it directly, %u ms writing it in the background, which took %u ms",
+		      kSaveSize / 1024, stall, backgroundStall, backgroundTime);
+	}
+
+	void test_lz4_compression() {
+		const uint32 gzipSaveTime = save("test.004", _data, kSaveSize);
+		uint32 start = g_system->getMillis();
+		TS_ASSERT(loadMatches("test.004", _data, kSaveSize));
+		const uint32 gzipLoadTime = g_system->getMillis() - start;
+
+		ConfMan.set("save_compression", "lz4", Common::ConfigManager::kTransientDomain);
+		const uint32 lz4SaveTime = save("test.005", _data, kSaveSize);
+		start = g_system->getMillis();
+		TS_ASSERT(loadMatches("test.005", _data, kSaveSize));
+		const uint32 lz4LoadTime = g_system->getMillis() - start;
+
+		// Written in the background too
+		_saveFileMan->setBackgroundSaving(true);
+		save("test.006", _data, kSaveSize);
+		_saveFileMan->setBackgroundSaving(false);
+		TS_ASSERT(loadMatches("test.006", _data, kSaveSize));
+
+		Common::ScopedPtr<Common::InSaveFile> gzipFile(_saveFileMan->openRawFile("test.004"));
+		Common::ScopedPtr<Common::InSaveFile> lz4File(_saveFileMan->openRawFile("test.005"));
+		TS_ASSERT(gzipFile && lz4File);
+		if (!gzipFile || !lz4File)
+			return;
+		TS_ASSERT_LESS_THAN(lz4File->size(), kSaveSize / 2);
+
+		debug("Save of %u KB: gzip wrote %u KB in %u ms and loaded it in %u ms, LZ4 wrote %u KB in %u ms and loaded it in %u ms",
+		      kSaveSize / 1024, (uint32)gzipFile->size() / 1024, gzipSaveTime, gzipLoadTime,
+		      (uint32)lz4File->size() / 1024, lz4SaveTime, lz4LoadTime);
+	}
+
+	void test_compression_dictionary() {
+		// A save of a small game, which barely changed since the new game
+		// state used as the dictionary
+		const uint32 size = 48 * 1024;
+		byte *dict = new byte[size];
+		fillSaveData(dict, size, 5);
+		memcpy(_data, dict, size);
+		for (uint32 i = 0; i < size; i += 1024)
+			_data[i] ^= 0x55;
+
+		ConfMan.set("save_compression", "lz4", Common::ConfigManager::kTransientDomain);
+		save("test.007", _data, size);
+		_saveFileMan->setCompressionDictionary(dict, size);
+		save("test.008", _data, size);
+		_saveFileMan->setCompressionDictionary(nullptr, 0);
+		TS_ASSERT(loadMatches("test.007", _data, size));
+		TS_ASSERT(loadMatches("test.008", _data, size));
+
+		// The dictionary is stored with the saves
+		const Common::StringArray dictFiles = _saveFileMan->listSavefiles("scummvm-*.lz4dict");
+		TS_ASSERT_EQUALS(dictFiles.size(), 1u);
+		if (dictFiles.size() == 1) {
+			Common::ScopedPtr<Common::InSaveFile> dictFile(_saveFileMan->openRawFile(dictFiles[0]));
+			TS_ASSERT(dictFile && dictFile->size() == size);
+		}
+
+		Common::ScopedPtr<Common::InSaveFile> plainFile(_saveFileMan->openRawFile("test.007"));
+		Common::ScopedPtr<Common::InSaveFile> dictSaveFile(_saveFileMan->openRawFile("test.008"));
+		TS_ASSERT(plainFile && dictSaveFile);
+		if (plainFile && dictSaveFile) {
+			TS_ASSERT_LESS_THAN(dictSaveFile->size() * 4, plainFile->size());
+			debug("Save of %u KB: LZ4 wrote %u bytes without a dictionary, %u bytes with one",
+			      size / 1024, (uint32)plainFile->size(), (uint32)dictSaveFile->size());
+		}
+
+		delete[] dict;
+	}
+};
+
+#endif
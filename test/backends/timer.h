@@ -0,0 +1,198 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/timer/default/default-timer.h"
+
+#include "common/system.h"
+
+#include "../system/null_osystem.h"
+
+// The timer manager needs OSystem for its mutex
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class TimerManagerTestSuite : public CxxTest::TestSuite {
+	// Lets the tests decide when the handler sees which time
+	class FakeClockTimerManager : public DefaultTimerManager {
+	public:
+		FakeClockTimerManager() : curTime(0) {}
+
+		uint64 curTime;
+
+	protected:
+		uint64 getMicros(bool skipRecord) override { return curTime; }
+	};
+
+	FakeClockTimerManager *_timerManager;
+
+	static Common::String *_calls;
+	static uint32 _ticks;
+
+	static void procA(void *refCon) { *_calls += 'A'; }
+	static void procB(void *refCon) { *_calls += 'B'; }
+	static void procC(void *refCon) { *_calls += 'C'; }
+	static void tickProc(void *refCon) { _ticks++; }
+
+	static void removingProc(void *refCon) {
+		*_calls += 'R';
+		((DefaultTimerManager *)refCon)->removeTimerProc(removingProc);
+	}
+
+	static uint32 nextRandom(uint32 &seed, uint32 max) {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 8) % max;
+	}
+
+	// Run a MIDI tempo timer for ten minutes, with the handler invoked
+	// either by a 10 ms poll or at the deadlines by a thread which wakes up
+	// a bit late, and return its timing
+	DefaultTimerManager::TimerStats runTempoTimer(bool poll, uint32 interval, uint32 &ticks) {
+		const uint64 duration = 10 * 60 * 1000000ULL;
+		uint32 seed = 1;
+
+		_ticks = 0;
+		_timerManager->installTimerProc(tickProc, interval, nullptr, "tempo");
+		while (true) {
+			uint64 curTime;
+			if (poll) {
+				// The poll is late too when the system is busy
+				curTime = _timerManager->curTime + 10000 + nextRandom(seed, 3000);
+			} else {
+				uint64 deadline;
+				TS_ASSERT(_timerManager->getNextDeadline(deadline));
+				curTime = deadline + nextRandom(seed, 150);
+			}
+			if (curTime > duration)
+				break;
+
+			_timerManager->curTime = curTime;
+			_timerManager->handler();
+		}
+
+		// Make the calls which were due by the end
+		_timerManager->curTime = duration;
+		_timerManager->handler();
+
+		DefaultTimerManager::TimerStats stats;
+		TS_ASSERT(_timerManager->getTimerStats("tempo", stats));
+		_timerManager->removeTimerProc(tickProc);
+		ticks = _ticks;
+		return stats;
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+		_timerManager = new FakeClockTimerManager();
+		_calls = new Common::String();
+	}
+
+	void tearDown() {
+		delete _timerManager;
+		delete _calls;
+		Common::uninstall_null_g_system();
+	}
+
+	void test_call_order() {
+		_timerManager->installTimerProc(procA, 3000, nullptr, "A");
+		_timerManager->installTimerProc(procB, 2000, nullptr, "B");
+		_timerManager->installTimerProc(procC, 3000, nullptr, "C");
+
+		_timerManager->curTime = 1999;
+		_timerManager->handler();
+		TS_ASSERT_EQUALS(*_calls, "");
+
+		// The missed calls are made in the order of their deadlines, and in
+		// the order the procs were queued for the same deadline
+		_timerManager->curTime = 6000;
+		_timerManager->handler();
+		TS_ASSERT_EQUALS(*_calls, "BACBACB");
+
+		uint64 deadline;
+		TS_ASSERT(_timerManager->getNextDeadline(deadline));
+		TS_ASSERT_EQUALS(deadline, 8000u);
+	}
+
+	void test_remove() {
+		_timerManager->installTimerProc(procA, 1000, nullptr, "A");
+		_timerManager->installTimerProc(removingProc, 1500, _timerManager, "R");
+		_timerManager->installTimerProc(procB, 2000, nullptr, "B");
+
+		// A is queued again after B, which is due at the same time
+		_timerManager->curTime = 2000;
+		_timerManager->handler();
+		TS_ASSERT_EQUALS(*_calls, "ARBA");
+
+		_timerManager->removeTimerProc(procA);
+		_timerManager->curTime = 4000;
+		_timerManager->handler();
+		TS_ASSERT_EQUALS(*_calls, "ARBAB");
+
+		DefaultTimerManager::TimerStats stats;
+		TS_ASSERT(!_timerManager->getTimerStats("A", stats));
+		TS_ASSERT(!_timerManager->getTimerStats("R", stats));
+		TS_ASSERT(_timerManager->getTimerStats("B", stats));
+
+		_timerManager->removeTimerProc(procB);
+		uint64 deadline;
+		TS_ASSERT(!_timerManager->getNextDeadline(deadline));
+	}
+
+	void test_catch_up() {
+		_timerManager->installTimerProc(tickProc, 10000, nullptr, "tick");
+		_ticks = 0;
+
+		// A short stall is caught up with
+		_timerManager->curTime = 500000;
+		_timerManager->handler();
+		TS_ASSERT_EQUALS(_ticks, 50u);
+
+		DefaultTimerManager::TimerStats stats;
+		TS_ASSERT(_timerManager->getTimerStats("tick", stats));
+		TS_ASSERT_EQUALS(stats.calls, 50u);
+		TS_ASSERT_EQUALS(stats.skipped, 0u);
+		TS_ASSERT_EQUALS(stats.maxLateness, 490000u);
+		TS_ASSERT_EQUALS(stats.meanLateness, 245000u);
+
+		// After a long one the missed calls are skipped, and the calls stay
+		// on the same schedule
+		_timerManager->resetTimerStats();
+		_timerManager->curTime = 5500000;
+		_timerManager->handler();
+		TS_ASSERT(_timerManager->getTimerStats("tick", stats));
+		TS_ASSERT_EQUALS(stats.calls, 1u);
+		TS_ASSERT_EQUALS(stats.skipped, 499u);
+
+		uint64 deadline;
+		TS_ASSERT(_timerManager->getNextDeadline(deadline));
+		TS_ASSERT_EQUALS(deadline, 5510000u);
+
+		_timerManager->removeTimerProc(tickProc);
+	}
+
+	void test_tempo_accuracy() {
+		// A MIDI sequence at 120 beats per minute and 120 ticks per beat
+		const uint32 interval = 4167;
+		const uint32 expectedTicks = 10 * 60 * 1000000 / interval;
+
+		uint32 pollTicks, deadlineTicks;
+		const DefaultTimerManager::TimerStats pollStats = runTempoTimer(true, interval, pollTicks);
+		_timerManager->curTime = 0;
+		const DefaultTimerManager::TimerStats deadlineStats = runTempoTimer(false, interval, deadlineTicks);
+
+		// The tempo does not drift either way, only the jitter differs
+		TS_ASSERT_EQUALS(pollTicks, expectedTicks);
+		TS_ASSERT_EQUALS(deadlineTicks, expectedTicks);
+		TS_ASSERT_EQUALS(pollStats.skipped, 0u);
+		TS_ASSERT_LESS_THAN(deadlineStats.maxLateness, 150u);
+		TS_ASSERT_LESS_THAN(deadlineStats.meanLateness * 20, pollStats.meanLateness);
+
+		debug("Tempo timer over 10 minutes, %u ticks expected: polled every 10 ms, %u ticks, lateness %u us mean, %u us max; "
+		      "at the deadlines, %u ticks, lateness %u us mean, %u us max\n",
+		      expectedTicks, pollTicks, pollStats.meanLateness, pollStats.maxLateness,
+		      deadlineTicks, deadlineStats.meanLateness, deadlineStats.maxLateness);
+	}
+};
+
+Common::String *TimerManagerTestSuite::_calls = nullptr;
+uint32 TimerManagerTestSuite::_ticks = 0;
+
+#endif
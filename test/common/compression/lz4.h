@@ -0,0 +1,195 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/compression/deflate.h"
+#include "common/compression/lz4.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+
+class LZ4TestSuite : public CxxTest::TestSuite {
+	// Data which compresses about as well as engine state does
+	static void fillData(byte *data, uint32 size, uint32 seed) {
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (seed >> 16) & 0x0F ? (byte)(i >> 6) : (byte)(seed >> 24);
+		}
+	}
+
+	static Common::MemoryWriteStreamDynamic *compress(const byte *data, uint32 size, const byte *dict = nullptr, uint32 dictSize = 0) {
+		Common::MemoryWriteStreamDynamic *compressed = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *stream = Common::wrapLZ4WriteStream(compressed, dict, dictSize);
+		// Write in uneven pieces to cross the block boundaries
+		for (uint32 pos = 0; pos < size; pos += 1000)
+			stream->write(data + pos, MIN<uint32>(1000, size - pos));
+		stream->finalize();
+		TS_ASSERT(!stream->err());
+		TS_ASSERT_EQUALS(stream->pos(), size);
+
+		// Keep the memory stream when deleting its wrapper
+		Common::MemoryWriteStreamDynamic *result = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		result->write(compressed->getData(), compressed->size());
+		delete stream;
+		return result;
+	}
+
+	static bool decompressMatches(Common::MemoryWriteStreamDynamic *compressed, const byte *data, uint32 size) {
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed->getData(), compressed->size())));
+		if (!stream || stream->size() != size)
+			return false;
+
+		byte *buffer = new byte[size + 1];
+		const bool matches = stream->read(buffer, size + 1) == size && stream->eos() && !stream->err() &&
+			memcmp(buffer, data, size) == 0;
+		delete[] buffer;
+		return matches;
+	}
+
+public:
+	void test_reference_frame() {
+		// Written by the reference implementation: linked 64 KB blocks and a
+		// content checksum
+		static const byte frame[] = {
+			0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x23, 0x00, 0x00, 0x00, 0xff, 0x03, 0x48, 0x65, 0x6c,
+			0x6c, 0x6f, 0x20, 0x4c, 0x5a, 0x34, 0x20, 0x53, 0x63, 0x75, 0x6d, 0x6d, 0x56, 0x4d, 0x20, 0x12,
+			0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe4, 0x50, 0x6d, 0x6d, 0x56, 0x4d, 0x20, 0x00, 0x00,
+			0x00, 0x00, 0x8d, 0x8f, 0xf0, 0x71
+		};
+		static const char pattern[] = "Hello LZ4 ScummVM ";
+
+		Common::MemoryReadStream memory(frame, sizeof(frame));
+		TS_ASSERT(Common::isLZ4Stream(memory));
+		TS_ASSERT_EQUALS(memory.pos(), 0);
+		TS_ASSERT_EQUALS(Common::getLZ4DictionaryId(memory), 0u);
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapLZ4ReadStream(&memory, DisposeAfterUse::NO));
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		char buffer[2000];
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 1800u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		bool matches = true;
+		for (uint i = 0; i < 1800; i++)
+			matches &= buffer[i] == pattern[i % 18];
+		TS_ASSERT(matches);
+
+		// Without a trailer, the size is found by decompressing everything
+		TS_ASSERT(stream->seek(-5, SEEK_END));
+		TS_ASSERT_EQUALS(stream->pos(), 1795);
+		TS_ASSERT_EQUALS(stream->size(), 1800);
+	}
+
+	void test_round_trip() {
+		static const uint32 sizes[] = { 0, 1, 13, 65535, 65536, 65537, 300000 };
+		const uint32 maxSize = 300000;
+
+		byte *data = new byte[maxSize];
+		for (uint i = 0; i < ARRAYSIZE(sizes); i++) {
+			fillData(data, sizes[i], i);
+			Common::ScopedPtr<Common::MemoryWriteStreamDynamic> compressed(compress(data, sizes[i]));
+			TS_ASSERT(decompressMatches(compressed.get(), data, sizes[i]));
+			if (sizes[i] > 1000)
+				TS_ASSERT_LESS_THAN(compressed->size(), sizes[i] / 2);
+		}
+
+		// Random data is stored in uncompressed blocks
+		uint32 seed = 1;
+		for (uint32 i = 0; i < maxSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 24;
+		}
+		Common::ScopedPtr<Common::MemoryWriteStreamDynamic> compressed(compress(data, maxSize));
+		TS_ASSERT(decompressMatches(compressed.get(), data, maxSize));
+		TS_ASSERT_LESS_THAN(compressed->size(), maxSize + 100);
+
+		delete[] data;
+	}
+
+	void test_seek() {
+		const uint32 size = 200000;
+		byte *data = new byte[size];
+		fillData(data, size, 7);
+		Common::ScopedPtr<Common::MemoryWriteStreamDynamic> compressed(compress(data, size));
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapLZ4ReadStream(
+			new Common::MemoryReadStream(compressed->getData(), compressed->size())));
+		TS_ASSERT(stream);
+		if (!stream) {
+			delete[] data;
+			return;
+		}
+
+		// The size is read from the trailer, like the header of a save is
+		TS_ASSERT_EQUALS(stream->size(), size);
+		TS_ASSERT(stream->seek(-4, SEEK_END));
+		TS_ASSERT_EQUALS(stream->readUint32LE(), READ_LE_UINT32(data + size - 4));
+
+		TS_ASSERT(stream->seek(100000));
+		TS_ASSERT_EQUALS(stream->readUint32LE(), READ_LE_UINT32(data + 100000));
+		TS_ASSERT(stream->seek(-50000, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->pos(), 50004);
+		TS_ASSERT_EQUALS(stream->readUint32LE(), READ_LE_UINT32(data + 50004));
+		TS_ASSERT(!stream->seek(size + 1));
+		TS_ASSERT(!stream->err());
+
+		delete[] data;
+	}
+
+	void test_corrupt_data() {
+		const uint32 size = 100000;
+		byte *data = new byte[size];
+		fillData(data, size, 3);
+		Common::ScopedPtr<Common::MemoryWriteStreamDynamic> compressed(compress(data, size));
+
+		// Flip a bit in the first block
+		compressed->getData()[100] ^= 0x10;
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapLZ4ReadStream(
+			new Common::MemoryReadStream(compressed->getData(), compressed->size())));
+		TS_ASSERT(stream);
+		if (stream) {
+			byte *buffer = new byte[size];
+			stream->read(buffer, size);
+			stream->readByte();
+			TS_ASSERT(stream->err());
+			delete[] buffer;
+		}
+
+		delete[] data;
+	}
+
+	void test_dictionary() {
+		const uint32 size = 100000;
+		byte *dict = new byte[size];
+		byte *data = new byte[size];
+		fillData(dict, size, 11);
+		memcpy(data, dict, size);
+		// A near-identical save
+		for (uint32 i = 0; i < size; i += 4096)
+			data[i] ^= 0x55;
+
+		Common::ScopedPtr<Common::MemoryWriteStreamDynamic> plain(compress(data + size - 60000, 60000));
+		Common::ScopedPtr<Common::MemoryWriteStreamDynamic> compressed(compress(data + size - 60000, 60000, dict, size));
+		TS_ASSERT_LESS_THAN(compressed->size() * 4, plain->size());
+
+		Common::MemoryReadStream memory(compressed->getData(), compressed->size());
+		const uint32 id = Common::getLZ4DictionaryId(memory);
+		TS_ASSERT_DIFFERS(id, 0u);
+
+		// The frame cannot be read without its dictionary
+		if (!Common::hasLZ4Dictionary(id)) {
+			Common::SeekableReadStream *stream = Common::wrapLZ4ReadStream(&memory, DisposeAfterUse::NO);
+			TS_ASSERT(!stream);
+			delete stream;
+		}
+
+		TS_ASSERT_EQUALS(Common::registerLZ4Dictionary(dict, size), id);
+		TS_ASSERT(Common::hasLZ4Dictionary(id));
+		TS_ASSERT(decompressMatches(compressed.get(), data + size - 60000, 60000));
+
+		delete[] dict;
+		delete[] data;
+	}
+};
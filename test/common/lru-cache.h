@@ -0,0 +1,52 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/lru-cache.h"
+
+class LRUCacheTestSuite : public CxxTest::TestSuite {
+public:
+	void test_get_put() {
+		Common::LRUCache<int, int> cache(100);
+		TS_ASSERT(!cache.get(1));
+
+		cache.put(1, 10, 30);
+		cache.put(2, 20, 30);
+		TS_ASSERT_EQUALS(cache.size(), 2u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 60u);
+		TS_ASSERT(cache.get(1));
+		TS_ASSERT_EQUALS(*cache.get(1), 10);
+
+		// Replacing a value releases the size of the old one
+		cache.put(1, 11, 40);
+		TS_ASSERT_EQUALS(cache.size(), 2u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 70u);
+		TS_ASSERT_EQUALS(*cache.get(1), 11);
+
+		cache.erase(2);
+		TS_ASSERT(!cache.get(2));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 40u);
+
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.size(), 0u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+	}
+
+	void test_eviction() {
+		Common::LRUCache<int, int> cache(100);
+		cache.put(1, 10, 40);
+		cache.put(2, 20, 40);
+		cache.get(1);
+
+		// 2 is now the least recently used value
+		cache.put(3, 30, 40);
+		TS_ASSERT(cache.get(1));
+		TS_ASSERT(!cache.get(2));
+		TS_ASSERT(cache.get(3));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 80u);
+
+		// 1 was used before 3
+		cache.setMemoryLimit(50);
+		TS_ASSERT(!cache.get(1));
+		TS_ASSERT(cache.get(3));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 40u);
+	}
+};
@@ -0,0 +1,270 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/metaengine.h"
+#include "engines/saveindex.h"
+
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#include "../system/null_osystem.h"
+
+// The index is stored by the save file manager of OSystem
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class SaveStateIndexTestSuite : public CxxTest::TestSuite {
+	static const int kGridSize = 500;
+
+	Common::SaveFileManager *_saveFileMan;
+	Common::FSNode _savePath;
+
+	static Common::String getSaveName(int slot) {
+		return Common::String::format("test.%03d", slot);
+	}
+
+	void writeSave(const Common::String &name, uint32 seed, uint32 size) {
+		Common::ScopedPtr<Common::OutSaveFile> file(_saveFileMan->openForSaving(name));
+		TS_ASSERT(file);
+		if (!file)
+			return;
+
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			file->writeByte((seed >> 16) & 0x0F ? (byte)(i >> 6) : (byte)(seed >> 24));
+		}
+
+		file->finalize();
+		TS_ASSERT(!file->err());
+	}
+
+	static ExtendedSavegameHeader makeHeader(const Common::String &description) {
+		ExtendedSavegameHeader header;
+		header.description = description;
+		header.date = 20261019;
+		header.time = 1234;
+		header.playtime = 56789;
+		header.isAutosave = false;
+		header.thumbnail = nullptr;
+		return header;
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+
+		_savePath = Common::FSNode(Common::Path("saves-test"));
+		if (!_savePath.exists())
+			_savePath.createDirectory();
+		ConfMan.setPath("savepath", _savePath.getPath(), Common::ConfigManager::kTransientDomain);
+
+		_saveFileMan = g_system->getSavefileManager();
+	}
+
+	void tearDown() {
+		Common::StringArray files = _saveFileMan->listSavefiles("test.*");
+		for (uint i = 0; i < files.size(); i++)
+			_saveFileMan->removeSavefile(files[i]);
+
+		const Common::String indexFilename = SaveStateIndex::getFilename("test");
+		if (_saveFileMan->exists(indexFilename))
+			_saveFileMan->removeSavefile(indexFilename);
+
+		ConfMan.removeKey("savepath", Common::ConfigManager::kTransientDomain);
+		Common::uninstall_null_g_system();
+	}
+
+	void test_filename_outside_save_patterns() {
+		const Common::String indexFilename = SaveStateIndex::getFilename("test");
+		TS_ASSERT(!indexFilename.matchString("test.*", true));
+		TS_ASSERT(!indexFilename.matchString("test*", true));
+	}
+
+	void test_round_trip() {
+		writeSave(getSaveName(1), 1, 4096);
+
+		SaveStateIndex::Fingerprint fingerprint;
+		TS_ASSERT(SaveStateIndex::getFingerprint(getSaveName(1), fingerprint));
+
+		Graphics::Surface thumbnail;
+		thumbnail.create(16, 12, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		thumbnail.fillRect(Common::Rect(16, 12), 0xF800);
+
+		ExtendedSavegameHeader header = makeHeader("Round trip");
+		header.thumbnail = &thumbnail;
+
+		{
+			SaveStateIndex index("test");
+			TS_ASSERT(index.beginUpdate());
+			TS_ASSERT_EQUALS(SaveStateIndex::getUpdating("test"), &index);
+			index.update(getSaveName(1), fingerprint, header);
+			index.endUpdate();
+			TS_ASSERT(!SaveStateIndex::getUpdating("test"));
+		}
+		thumbnail.free();
+
+		SaveStateIndex index("test");
+		ExtendedSavegameHeader found;
+		TS_ASSERT(index.find(getSaveName(1), fingerprint, found));
+		TS_ASSERT_EQUALS(found.description, "Round trip");
+		TS_ASSERT_EQUALS(found.date, 20261019u);
+		TS_ASSERT_EQUALS(found.time, 1234);
+		TS_ASSERT_EQUALS(found.playtime, 56789u);
+		TS_ASSERT(!found.isAutosave);
+		TS_ASSERT(!found.thumbnail);
+
+		// The thumbnail is only read when it is asked for
+		Common::SharedPtr<SaveStateThumbnailLoader> loader = index.getThumbnailLoader(getSaveName(1), fingerprint);
+		TS_ASSERT(loader);
+		if (loader) {
+			Graphics::Surface *loaded = loader->loadThumbnail();
+			TS_ASSERT(loaded);
+			if (loaded) {
+				TS_ASSERT_EQUALS(loaded->w, 16);
+				TS_ASSERT_EQUALS(loaded->h, 12);
+				loaded->free();
+				delete loaded;
+			}
+		}
+	}
+
+	void test_changed_save_is_stale() {
+		writeSave(getSaveName(1), 1, 4096);
+
+		SaveStateIndex::Fingerprint fingerprint;
+		TS_ASSERT(SaveStateIndex::getFingerprint(getSaveName(1), fingerprint));
+
+		{
+			SaveStateIndex index("test");
+			TS_ASSERT(index.beginUpdate());
+			index.update(getSaveName(1), fingerprint, makeHeader("Before"));
+			index.endUpdate();
+		}
+
+		// Overwriting the slot changes the checksum at the end of the file,
+		// even though the size of the save stays the same
+		writeSave(getSaveName(1), 2, 4096);
+
+		SaveStateIndex::Fingerprint changed;
+		TS_ASSERT(SaveStateIndex::getFingerprint(getSaveName(1), changed));
+		TS_ASSERT(!(changed == fingerprint));
+
+		SaveStateIndex index("test");
+		ExtendedSavegameHeader found;
+		TS_ASSERT(!index.find(getSaveName(1), changed, found));
+		TS_ASSERT(!index.getThumbnailLoader(getSaveName(1), changed));
+	}
+
+	void test_other_version_is_ignored() {
+		writeSave(getSaveName(1), 1, 4096);
+
+		SaveStateIndex::Fingerprint fingerprint;
+		TS_ASSERT(SaveStateIndex::getFingerprint(getSaveName(1), fingerprint));
+
+		{
+			SaveStateIndex index("test");
+			TS_ASSERT(index.beginUpdate());
+			index.update(getSaveName(1), fingerprint, makeHeader("Versioned"));
+			index.endUpdate();
+		}
+
+		// Patch the version byte following the tag
+		const Common::String indexFilename = SaveStateIndex::getFilename("test");
+		Common::ScopedPtr<Common::InSaveFile> in(_saveFileMan->openRawFile(indexFilename));
+		TS_ASSERT(in);
+		if (!in)
+			return;
+
+		Common::Array<byte> data(in->size());
+		in->read(data.data(), data.size());
+		in.reset();
+		data[4]++;
+
+		Common::ScopedPtr<Common::OutSaveFile> out(_saveFileMan->openForSaving(indexFilename, false));
+		out->write(data.data(), data.size());
+		out->finalize();
+		out.reset();
+
+		SaveStateIndex index("test");
+		ExtendedSavegameHeader found;
+		TS_ASSERT(!index.find(getSaveName(1), fingerprint, found));
+	}
+
+	void test_empty_index_is_removed() {
+		writeSave(getSaveName(1), 1, 4096);
+
+		SaveStateIndex::Fingerprint fingerprint;
+		TS_ASSERT(SaveStateIndex::getFingerprint(getSaveName(1), fingerprint));
+
+		const Common::String indexFilename = SaveStateIndex::getFilename("test");
+		{
+			SaveStateIndex index("test");
+			TS_ASSERT(index.beginUpdate());
+			index.update(getSaveName(1), fingerprint, makeHeader("Deleted"));
+			index.endUpdate();
+		}
+		TS_ASSERT(_saveFileMan->exists(indexFilename));
+
+		// The save file is gone, so the next listing does not query it
+		_saveFileMan->removeSavefile(getSaveName(1));
+
+		SaveStateIndex index("test");
+		TS_ASSERT(index.beginUpdate());
+		index.endUpdate();
+		TS_ASSERT(!_saveFileMan->exists(indexFilename));
+	}
+
+	void test_grid_benchmark() {
+		for (int slot = 0; slot < kGridSize; slot++)
+			writeSave(getSaveName(slot), slot, 16 * 1024);
+
+		// The first listing reads each save file to its header at the end
+		uint32 start = g_system->getMillis();
+		{
+			SaveStateIndex index("test");
+			TS_ASSERT(index.beginUpdate());
+
+			byte buffer[1024];
+			for (int slot = 0; slot < kGridSize; slot++) {
+				Common::ScopedPtr<Common::InSaveFile> file(_saveFileMan->openForLoading(getSaveName(slot)));
+				while (!file->eos())
+					file->read(buffer, sizeof(buffer));
+
+				SaveStateIndex::Fingerprint fingerprint;
+				TS_ASSERT(SaveStateIndex::getFingerprint(getSaveName(slot), fingerprint));
+				index.update(getSaveName(slot), fingerprint, makeHeader(getSaveName(slot)));
+			}
+
+			index.endUpdate();
+		}
+		const uint32 uncachedTime = g_system->getMillis() - start;
+
+		// The next ones only check the fingerprints of the save files
+		start = g_system->getMillis();
+		int found = 0;
+		{
+			SaveStateIndex index("test");
+			TS_ASSERT(index.beginUpdate());
+
+			for (int slot = 0; slot < kGridSize; slot++) {
+				SaveStateIndex::Fingerprint fingerprint;
+				ExtendedSavegameHeader header;
+				if (SaveStateIndex::getFingerprint(getSaveName(slot), fingerprint) &&
+						index.find(getSaveName(slot), fingerprint, header) &&
+						header.description == getSaveName(slot))
+					found++;
+			}
+
+			index.endUpdate();
+		}
+		const uint32 cachedTime = g_system->getMillis() - start;
+
+		TS_ASSERT_EQUALS(found, kGridSize);
+		debug("Listing %d saves: %u ms without index, %u ms with index", kGridSize, uncachedTime, cachedTime);
+	}
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/blit.h"
+#include "graphics/pixelformat.h"
+
+#include "../system/null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class BlitMapTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+#endif
+		for (uint i = 0; i < 256; i++)
+			_map[i] = 0x01000000 * (i ^ 0x5A) + 0x00010101 * i;
+
+		for (uint i = 0; i < sizeof(_src); i++)
+			_src[i] = (byte)(i * 7 + (i >> 5));
+	}
+
+	void tearDown() {
+#if BENCHMARK_TIME
+		Common::uninstall_null_g_system();
+#endif
+	}
+
+	template<typename DstColor>
+	void checkBlitMap(Graphics::FastBlitMapFunc func, uint w, uint h) {
+		const uint srcPitch = kSrcPitch;
+		const uint dstPitch = kSrcPitch * sizeof(DstColor) + 8;
+		DstColor *dst = new DstColor[dstPitch * h / sizeof(DstColor)]();
+
+		func((byte *)dst, _src, dstPitch, srcPitch, w, h, _map);
+
+		for (uint y = 0; y < h; y++) {
+			const DstColor *row = (const DstColor *)((const byte *)dst + y * dstPitch);
+			for (uint x = 0; x < w; x++)
+				TS_ASSERT_EQUALS(row[x], (DstColor)_map[_src[y * srcPitch + x]]);
+
+			// Pixels past the width must not be touched
+			if (w < kSrcPitch)
+				TS_ASSERT_EQUALS(row[w], (DstColor)0);
+		}
+
+		delete[] dst;
+	}
+
+	void test_generic() {
+		for (uint w = 1; w <= 19; w++) {
+			checkBlitMap<uint16>(Graphics::getFastBlitMapFunc(2), w, 3);
+			checkBlitMap<uint32>(Graphics::getFastBlitMapFunc(4), w, 3);
+		}
+
+		TS_ASSERT(Graphics::getFastBlitMapFunc(1) == nullptr);
+		TS_ASSERT(Graphics::getFastBlitMapFunc(3) == nullptr);
+	}
+
+	void test_sse2() {
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() < 2)
+			return;
+
+		for (uint w = 1; w <= 19; w++) {
+			checkBlitMap<uint16>(Graphics::fastBlitMapSSE2_16, w, 3);
+			checkBlitMap<uint32>(Graphics::fastBlitMapSSE2_32, w, 3);
+		}
+#endif
+	}
+
+	void test_crossBlitMap_in_place() {
+		// Converting in place must still work, as it cannot use the fast path
+		const uint w = 13, h = 5;
+		uint32 buf[w * h];
+		byte *bytes = (byte *)buf;
+		for (uint y = 0; y < h; y++)
+			for (uint x = 0; x < w; x++)
+				bytes[y * w + x] = _src[y * kSrcPitch + x];
+
+		Graphics::crossBlitMap(bytes, bytes, w * 4, w, w, h, 4, _map);
+
+		for (uint y = 0; y < h; y++)
+			for (uint x = 0; x < w; x++)
+				TS_ASSERT_EQUALS(buf[y * w + x], _map[_src[y * kSrcPitch + x]]);
+	}
+
+	void test_blit_map_speed() {
+#if BENCHMARK_TIME
+		const uint w = 640, h = 480;
+#ifdef SLOW_TESTS
+		const int iters = 500;
+#else
+		const int iters = 1;
+#endif
+		byte *src = new byte[w * h];
+		uint32 *dst = new uint32[w * h];
+		for (uint i = 0; i < w * h; i++)
+			src[i] = (byte)(i * 13);
+
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < iters; i++)
+			Graphics::crossBlitMap((byte *)dst, src, w * 4, w, w, h, 4, _map);
+		uint32 time = g_system->getMillis() - start;
+
+		debug("crossBlitMap 8bpp -> 32bpp: %d iters of %dx%d in %d ms (%.1f Mpixel/s)", iters, w, h, time,
+		      time ? (double)w * h * iters / (time * 1000.0) : 0.0);
+
+		delete[] src;
+		delete[] dst;
+#endif
+	}
+
+private:
+	static const uint kSrcPitch = 24;
+
+	uint32 _map[256];
+	byte _src[kSrcPitch * 8];
+};
@@ -0,0 +1,302 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/system.h"
+
+#include "graphics/blit.h"
+#include "graphics/surface.h"
+
+#include "image/codecs/cinepak.h"
+
+#include "../system/null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+/**
+ * Synthetic Cinepak stream: a key frame of V1 blocks, followed by frames
+ * which only update some of the blocks, so that decoding them depends on
+ * the previous frame.
+ */
+class SyntheticCinepak {
+public:
+	SyntheticCinepak(uint16 width, uint16 height, uint frameCount) {
+		for (uint f = 0; f < frameCount; f++)
+			_frames.push_back(encodeFrame(width, height, f));
+	}
+
+	Common::SeekableReadStream *createFrameStream(uint f) const {
+		return new Common::MemoryReadStream(_frames[f].data(), _frames[f].size());
+	}
+
+	uint size() const { return _frames.size(); }
+
+private:
+	class Writer {
+	public:
+		Writer(Common::Array<byte> &data) : _data(data), _flagPos(0), _bits(0) {}
+
+		void writeByte(byte b) { _data.push_back(b); }
+		void writeUint16BE(uint16 v) { writeByte(v >> 8); writeByte(v & 0xFF); }
+		void writeUint24BE(uint32 v) { writeByte(v >> 16); writeUint16BE(v & 0xFFFF); }
+
+		// The decoder reads a new flag word when it needs a bit and has
+		// used all those of the previous one
+		void writeFlag(bool set) {
+			if (!(_bits % 32)) {
+				_flagPos = _data.size();
+				for (uint i = 0; i < 4; i++)
+					writeByte(0);
+			}
+
+			if (set)
+				_data[_flagPos + (_bits % 32) / 8] |= 0x80 >> (_bits % 8);
+			_bits++;
+		}
+
+		uint pos() const { return _data.size(); }
+
+	private:
+		Common::Array<byte> &_data;
+		uint _flagPos;
+		uint _bits;
+	};
+
+	static Common::Array<byte> encodeFrame(uint16 width, uint16 height, uint f) {
+		Common::Array<byte> data;
+		Writer out(data);
+
+		const bool keyFrame = !f;
+
+		// Frame header, with the length patched below
+		out.writeByte(keyFrame ? 1 : 0);
+		out.writeUint24BE(0);
+		out.writeUint16BE(width);
+		out.writeUint16BE(height);
+		out.writeUint16BE(1);
+
+		// A single strip
+		const uint stripPos = out.pos();
+		out.writeUint16BE(keyFrame ? 0x1000 : 0x1100);
+		out.writeUint16BE(0);
+		out.writeUint16BE(0);
+		out.writeUint16BE(0);
+		out.writeUint16BE(height);
+		out.writeUint16BE(width);
+
+		// V1 codebook of 256 colors, changing between frames
+		out.writeByte(0x22);
+		out.writeUint24BE(4 + 256 * 6);
+		for (uint i = 0; i < 256; i++) {
+			for (uint y = 0; y < 4; y++)
+				out.writeByte((byte)(i + y * 16 + f * 8));
+			out.writeByte((byte)(i * 3 + f));
+			out.writeByte((byte)(i * 5 - f));
+		}
+
+		// Vectors, all V1 for the key frame, and a quarter of the blocks
+		// for the other ones
+		const uint vectorsPos = out.pos();
+		out.writeByte(keyFrame ? 0x32 : 0x31);
+		out.writeUint24BE(0);
+
+		Writer vectors(data);
+		uint block = 0;
+		for (uint y = 0; y < height; y += 4) {
+			for (uint x = 0; x < width; x += 4, block++) {
+				if (!keyFrame) {
+					const bool update = ((block * 2654435761U + f * 40503U) >> 7) % 4 == 0;
+					vectors.writeFlag(update);
+					if (!update)
+						continue;
+
+					// V1 block
+					vectors.writeFlag(false);
+				}
+
+				vectors.writeByte((byte)(block + f));
+			}
+		}
+
+		const uint vectorsSize = out.pos() - vectorsPos;
+		data[vectorsPos + 1] = (vectorsSize >> 16) & 0xFF;
+		data[vectorsPos + 2] = (vectorsSize >> 8) & 0xFF;
+		data[vectorsPos + 3] = vectorsSize & 0xFF;
+
+		const uint stripSize = out.pos() - stripPos;
+		data[stripPos + 2] = stripSize >> 8;
+		data[stripPos + 3] = stripSize & 0xFF;
+
+		data[1] = (data.size() >> 16) & 0xFF;
+		data[2] = (data.size() >> 8) & 0xFF;
+		data[3] = data.size() & 0xFF;
+
+		return data;
+	}
+
+	Common::Array<Common::Array<byte> > _frames;
+};
+
+class CinepakTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+#endif
+	}
+
+	void tearDown() {
+#if BENCHMARK_TIME
+		Common::uninstall_null_g_system();
+#endif
+	}
+
+	void test_decode_into_surface() {
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		SyntheticCinepak video(64, 48, 6);
+
+		Image::CinepakDecoder reference;
+		TS_ASSERT(reference.setOutputPixelFormat(format));
+
+		// Decode into the middle of a larger surface, whose border must be
+		// left untouched
+		Graphics::Surface screen;
+		screen.create(80, 64, format);
+		screen.fillRect(Common::Rect(80, 64), 0x1234);
+		Graphics::Surface area = screen.getSubArea(Common::Rect(8, 8, 72, 56));
+
+		Image::CinepakDecoder decoder;
+		TS_ASSERT(decoder.setOutputPixelFormat(format));
+		TS_ASSERT(decoder.setOutputSurface(&area));
+
+		for (uint f = 0; f < video.size(); f++) {
+			// Go back to the surface of the codec for a frame on the way
+			if (f == 4)
+				TS_ASSERT(decoder.setOutputSurface(nullptr));
+			if (f == 5)
+				TS_ASSERT(decoder.setOutputSurface(&area));
+
+			Common::ScopedPtr<Common::SeekableReadStream> referenceStream(video.createFrameStream(f));
+			const Graphics::Surface *expected = reference.decodeFrame(*referenceStream);
+
+			Common::ScopedPtr<Common::SeekableReadStream> stream(video.createFrameStream(f));
+			const Graphics::Surface *frame = decoder.decodeFrame(*stream);
+
+			TS_ASSERT(expected && frame);
+			if (!expected || !frame)
+				break;
+
+			TS_ASSERT_EQUALS(frame->getPixels() == area.getPixels(), f != 4);
+			TS_ASSERT(samePixels(*frame, *expected));
+		}
+
+		// The border
+		TS_ASSERT_EQUALS(*(const uint16 *)screen.getBasePtr(7, 8), 0x1234);
+		TS_ASSERT_EQUALS(*(const uint16 *)screen.getBasePtr(72, 55), 0x1234);
+		TS_ASSERT_EQUALS(*(const uint16 *)screen.getBasePtr(8, 7), 0x1234);
+		TS_ASSERT_EQUALS(*(const uint16 *)screen.getBasePtr(71, 56), 0x1234);
+
+		screen.free();
+	}
+
+	void test_decode_into_other_format() {
+		SyntheticCinepak video(64, 48, 3);
+
+		// The blocks are written in the format of the surface
+		Image::CinepakDecoder reference;
+		TS_ASSERT(reference.setOutputPixelFormat(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)));
+
+		Graphics::Surface target;
+		target.create(64, 48, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+		Image::CinepakDecoder decoder;
+		TS_ASSERT(decoder.setOutputPixelFormat(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)));
+		TS_ASSERT(decoder.setOutputSurface(&target));
+
+		for (uint f = 0; f < video.size(); f++) {
+			Common::ScopedPtr<Common::SeekableReadStream> referenceStream(video.createFrameStream(f));
+			const Graphics::Surface *expected = reference.decodeFrame(*referenceStream);
+
+			Common::ScopedPtr<Common::SeekableReadStream> stream(video.createFrameStream(f));
+			const Graphics::Surface *frame = decoder.decodeFrame(*stream);
+
+			TS_ASSERT(expected && frame);
+			if (expected && frame)
+				TS_ASSERT(samePixels(*frame, *expected));
+		}
+
+		// Paletted surfaces are not supported
+		Graphics::Surface paletted;
+		paletted.create(64, 48, Graphics::PixelFormat::createFormatCLUT8());
+		TS_ASSERT(!decoder.setOutputSurface(&paletted));
+		paletted.free();
+
+		target.free();
+	}
+
+	void test_decode_into_speed() {
+#if BENCHMARK_TIME
+#ifdef SLOW_TESTS
+		SyntheticCinepak video(640, 480, 60);
+#else
+		SyntheticCinepak video(320, 240, 10);
+#endif
+		const Graphics::PixelFormat videoFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat screenFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		const uint kPasses = 20;
+
+		Graphics::Surface screen;
+		screen.create(640, 480, screenFormat);
+		Graphics::Surface area = screen.getSubArea(Common::Rect(0, 0, 320, 240));
+
+		// Decoding into the codec, and converting the frame to the screen
+		uint32 start = g_system->getMillis();
+		for (uint pass = 0; pass < kPasses; pass++) {
+			Image::CinepakDecoder decoder;
+			decoder.setOutputPixelFormat(videoFormat);
+			for (uint f = 0; f < video.size(); f++) {
+				Common::ScopedPtr<Common::SeekableReadStream> stream(video.createFrameStream(f));
+				const Graphics::Surface *frame = decoder.decodeFrame(*stream);
+				Graphics::crossBlit((byte *)area.getPixels(), (const byte *)frame->getPixels(), area.pitch, frame->pitch,
+				                    frame->w, frame->h, area.format, frame->format);
+			}
+		}
+		const uint32 copyTime = g_system->getMillis() - start;
+
+		// Decoding straight into the screen
+		start = g_system->getMillis();
+		for (uint pass = 0; pass < kPasses; pass++) {
+			Image::CinepakDecoder decoder;
+			decoder.setOutputPixelFormat(videoFormat);
+			decoder.setOutputSurface(&area);
+			for (uint f = 0; f < video.size(); f++) {
+				Common::ScopedPtr<Common::SeekableReadStream> stream(video.createFrameStream(f));
+				decoder.decodeFrame(*stream);
+			}
+		}
+		const uint32 directTime = g_system->getMillis() - start;
+
+		debug("Cinepak: %u frames decoded and converted in %u ms, decoded into the screen in %u ms",
+		      kPasses * video.size(), copyTime, directTime);
+
+		screen.free();
+#endif
+	}
+
+private:
+	static bool samePixels(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h || a.format != b.format)
+			return false;
+
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,173 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "image/image_cache.h"
+#include "image/png.h"
+#include "graphics/surface.h"
+
+#include "../system/null_osystem.h"
+
+class ImageCacheTestSuite : public CxxTest::TestSuite {
+public:
+	void tearDown() {
+		Image::ImageCache::destroy();
+	}
+
+	void fillSurface(Graphics::Surface &surface, uint32 color) {
+		surface.create(16, 16, Graphics::PixelFormat::createFormatRGBA32());
+		surface.fillRect(Common::Rect(surface.w, surface.h), color);
+	}
+
+	void test_get_put() {
+		Image::ImageCache &cache = Image::ImageCache::instance();
+		const Graphics::PixelFormat native;
+
+		Graphics::Surface surface;
+		fillSurface(surface, 0x11223344);
+
+		TS_ASSERT(!cache.get("room/bg.png", native));
+		Image::ImageCache::SurfacePtr stored = cache.put("room/bg.png", native, surface);
+		TS_ASSERT(stored);
+		surface.free();
+
+		Image::ImageCache::SurfacePtr found = cache.get("ROOM/BG.PNG", native);
+		TS_ASSERT(found);
+		TS_ASSERT_EQUALS(found->getPixel(3, 4), 0x11223344u);
+
+		// A different requested format is a different entry
+		TS_ASSERT(!cache.get("room/bg.png", Graphics::PixelFormat::createFormatRGBA32()));
+
+		TS_ASSERT_EQUALS(cache.getHits(), 1u);
+		TS_ASSERT_EQUALS(cache.getMisses(), 2u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 16u * 16u * 4u);
+	}
+
+	void test_paletted_not_cached() {
+		Image::ImageCache &cache = Image::ImageCache::instance();
+
+		Graphics::Surface surface;
+		surface.create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+		TS_ASSERT(!cache.put("cursor.bmp", Graphics::PixelFormat(), surface));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+		surface.free();
+	}
+
+	void test_eviction() {
+		Image::ImageCache &cache = Image::ImageCache::instance();
+		const Graphics::PixelFormat native;
+		cache.setMemoryLimit(2 * 16 * 16 * 4);
+
+		Graphics::Surface surface;
+		fillSurface(surface, 0);
+
+		Image::ImageCache::SurfacePtr first = cache.put("a.png", native, surface);
+		cache.put("b.png", native, surface);
+		TS_ASSERT(cache.get("a.png", native));
+
+		// b.png is now the least recently used image
+		cache.put("c.png", native, surface);
+		TS_ASSERT(cache.get("a.png", native));
+		TS_ASSERT(!cache.get("b.png", native));
+		TS_ASSERT(cache.get("c.png", native));
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 2u * 16u * 16u * 4u);
+
+		// Surfaces handed out before stay valid after eviction
+		cache.clear();
+		TS_ASSERT_EQUALS(first->w, 16);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+
+		surface.free();
+	}
+
+	void test_put_takes_ownership() {
+		Image::ImageCache &cache = Image::ImageCache::instance();
+		const Graphics::PixelFormat native;
+
+		Graphics::Surface *surface = new Graphics::Surface();
+		fillSurface(*surface, 0x55667788);
+
+		Image::ImageCache::SurfacePtr stored = cache.put("room/bg.png", native, surface);
+		TS_ASSERT_EQUALS(stored.get(), surface);
+		TS_ASSERT_EQUALS(cache.get("room/bg.png", native).get(), surface);
+
+		// Paletted images are handed back without being cached
+		Graphics::Surface *paletted = new Graphics::Surface();
+		paletted->create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+		stored = cache.put("cursor.bmp", native, paletted);
+		TS_ASSERT_EQUALS(stored.get(), paletted);
+		TS_ASSERT(!cache.get("cursor.bmp", native));
+	}
+
+#if defined(USE_PNG) && NULL_OSYSTEM_IS_AVAILABLE
+	// Walking back and forth between the rooms of a Wintermute game, whose
+	// backgrounds are loaded like BaseImage::loadFile() does
+	void test_scene_change_benchmark() {
+		Common::install_null_g_system();
+
+		const Graphics::PixelFormat format = Graphics::PixelFormat::createFormatRGBA32();
+		const uint kRooms = 4, kVisits = 24;
+
+		Common::Array<Common::Array<byte> > backgrounds;
+		for (uint room = 0; room < kRooms; room++) {
+			Graphics::Surface surface;
+			surface.create(800, 600, format);
+			for (int y = 0; y < surface.h; y++) {
+				for (int x = 0; x < surface.w; x++)
+					surface.setPixel(x, y, format.ARGBToColor(255, x + room * 40, y, (x ^ y) & 0xFF));
+			}
+
+			Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+			TS_ASSERT(Image::writePNG(out, surface));
+			backgrounds.push_back(Common::Array<byte>(out.getData(), out.size()));
+			free(out.getData());
+			surface.free();
+		}
+
+		Image::ImageCache &cache = Image::ImageCache::instance();
+		cache.setMemoryLimit(kRooms * 800 * 600 * 4);
+
+		uint32 times[3];
+		for (uint mode = 0; mode < 3; mode++) {
+			cache.clear();
+
+			const uint32 start = g_system->getMillis();
+			for (uint visit = 0; visit < kVisits; visit++) {
+				const uint room = visit % kRooms;
+				const Common::Path path(Common::String::format("scenes/room%u/background.png", room));
+
+				// Without the cache, every scene change decodes the background
+				Image::ImageCache::SurfacePtr background;
+				if (mode)
+					background = cache.get(path, format);
+				if (background)
+					continue;
+
+				Image::PNGDecoder decoder;
+				decoder.setOutputPixelFormat(format);
+				Common::MemoryReadStream stream(backgrounds[room].data(), backgrounds[room].size());
+				TS_ASSERT(decoder.loadStream(stream));
+
+				if (mode == 1) {
+					background = cache.put(path, format, *decoder.getSurface());
+				} else if (mode == 2) {
+					const Graphics::Surface *decoded = decoder.getSurface();
+					background = cache.put(path, format, decoder.releaseSurface());
+					TS_ASSERT_EQUALS(background.get(), decoded);
+					TS_ASSERT(!decoder.getSurface());
+				}
+			}
+			times[mode] = g_system->getMillis() - start;
+		}
+
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), kRooms * 800u * 600u * 4u);
+		debug("%u scene changes between %u rooms: %u ms without cache, %u ms copying into the cache, %u ms handing over to the cache",
+		      kVisits, kRooms, times[0], times[1], times[2]);
+
+		Image::ImageCache::destroy();
+		Common::uninstall_null_g_system();
+	}
+#endif
+};
@@ -0,0 +1,278 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "math/dct.h"
+#include "math/fft.h"
+#include "math/mdct.h"
+#include "math/rdft.h"
+#include "math/utils.h"
+
+#include "../system/null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+/**
+ * Checks the transforms against straightforward double precision
+ * implementations of their definitions, and benchmarks them at the sizes
+ * used by the WMA, QDM2 and Bink audio decoders.
+ */
+class FFTTestSuite : public CxxTest::TestSuite {
+	// Minimum signal-to-noise ratio of the transforms, in dB
+	static const int kMinPSNR = 100;
+
+	static void fillRandom(float *data, int size, uint32 seed) {
+		for (int i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (int)(seed >> 16) / 32768.0f - 1.0f;
+		}
+	}
+
+	static double psnr(const float *output, const double *expected, int size) {
+		double peak = 0.0, error = 0.0;
+		for (int i = 0; i < size; i++) {
+			peak = MAX(peak, ABS(expected[i]));
+			error += (output[i] - expected[i]) * (output[i] - expected[i]);
+		}
+
+		if (error == 0.0)
+			return 1000.0;
+		return 10.0 * log10(peak * peak * size / error);
+	}
+
+	// Unpack the packed real spectrum used by RDFT into complex bins 0..n/2
+	static void unpackSpectrum(const float *data, int n, int k, double &re, double &im) {
+		if (k == 0) {
+			re = data[0];
+			im = 0.0;
+		} else if (k == n / 2) {
+			re = data[1];
+			im = 0.0;
+		} else {
+			re = data[2 * k];
+			im = data[2 * k + 1];
+		}
+	}
+
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+#endif
+	}
+
+	void tearDown() {
+#if BENCHMARK_TIME
+		Common::uninstall_null_g_system();
+#endif
+	}
+
+	void test_fft() {
+		for (int bits = 2; bits <= 10; bits++) {
+			const int n = 1 << bits;
+			for (int inverse = 0; inverse < 2; inverse++) {
+				float *data = new float[2 * n];
+				double *expected = new double[2 * n];
+				fillRandom(data, 2 * n, bits);
+
+				const double sign = inverse ? 1.0 : -1.0;
+				for (int k = 0; k < n; k++) {
+					double re = 0.0, im = 0.0;
+					for (int i = 0; i < n; i++) {
+						const double a = sign * 2 * M_PI * ((i * k) % n) / n;
+						re += data[2 * i] * cos(a) - data[2 * i + 1] * sin(a);
+						im += data[2 * i] * sin(a) + data[2 * i + 1] * cos(a);
+					}
+					expected[2 * k] = re;
+					expected[2 * k + 1] = im;
+				}
+
+				Math::FFT fft(bits, inverse);
+				fft.permute((Math::Complex *)data);
+				fft.calc((Math::Complex *)data);
+
+				TSM_ASSERT_LESS_THAN(Common::String::format("FFT bits %d inverse %d", bits, inverse).c_str(), kMinPSNR, psnr(data, expected, 2 * n));
+
+				delete[] expected;
+				delete[] data;
+			}
+		}
+	}
+
+	void test_rdft() {
+		for (int bits = 4; bits <= 10; bits++) {
+			const int n = 1 << bits;
+			float *data = new float[n];
+			double *expected = new double[n];
+
+			for (int type = Math::RDFT::DFT_R2C; type <= Math::RDFT::DFT_C2R; type++) {
+				fillRandom(data, n, bits * 4 + type);
+
+				if (type == Math::RDFT::DFT_R2C || type == Math::RDFT::IDFT_R2C) {
+					// Real to packed complex; IDFT_R2C is the conjugate
+					const double sign = type == Math::RDFT::DFT_R2C ? 1.0 : -1.0;
+					for (int k = 0; k <= n / 2; k++) {
+						double re = 0.0, im = 0.0;
+						for (int i = 0; i < n; i++) {
+							const double a = 2 * M_PI * ((i * k) % n) / n;
+							re += data[i] * cos(a);
+							im -= sign * data[i] * sin(a);
+						}
+
+						if (k == 0)
+							expected[0] = re;
+						else if (k == n / 2)
+							expected[1] = re;
+						else {
+							expected[2 * k] = re;
+							expected[2 * k + 1] = im;
+						}
+					}
+				} else {
+					// Packed complex to real, at half scale
+					const double sign = type == Math::RDFT::IDFT_C2R ? 1.0 : -1.0;
+					for (int i = 0; i < n; i++) {
+						double value = 0.0;
+						for (int k = 0; k <= n / 2; k++) {
+							double re, im;
+							unpackSpectrum(data, n, k, re, im);
+
+							const double a = sign * 2 * M_PI * ((i * k) % n) / n;
+							const double bin = re * cos(a) - im * sin(a);
+							value += (k == 0 || k == n / 2) ? bin : 2 * bin;
+						}
+						expected[i] = value / 2;
+					}
+				}
+
+				Math::RDFT rdft(bits, (Math::RDFT::TransformType)type);
+				rdft.calc(data);
+
+				TSM_ASSERT_LESS_THAN(Common::String::format("RDFT bits %d type %d", bits, type).c_str(), kMinPSNR, psnr(data, expected, n));
+			}
+
+			delete[] expected;
+			delete[] data;
+		}
+	}
+
+	void test_imdct() {
+		for (int bits = 4; bits <= 11; bits++) {
+			const int n = 1 << bits;
+			float *input = new float[n / 2];
+			float *output = new float[n];
+			double *expected = new double[n];
+			fillRandom(input, n / 2, bits);
+
+			for (int i = 0; i < n; i++) {
+				double value = 0.0;
+				for (int k = 0; k < n / 2; k++)
+					value -= input[k] * cos(2 * M_PI / n * (i + 0.5 + n / 4) * (k + 0.5));
+				expected[i] = value;
+			}
+
+			Math::MDCT mdct(bits, true, 1.0);
+			mdct.calcIMDCT(output, input);
+
+			TSM_ASSERT_LESS_THAN(Common::String::format("IMDCT bits %d", bits).c_str(), kMinPSNR, psnr(output, expected, n));
+
+			delete[] expected;
+			delete[] output;
+			delete[] input;
+		}
+	}
+
+	void test_dct_iii() {
+		for (int bits = 4; bits <= 10; bits++) {
+			const int n = 1 << bits;
+			float *data = new float[n];
+			double *expected = new double[n];
+			fillRandom(data, n, bits);
+
+			for (int i = 0; i < n; i++) {
+				double value = data[0] / 2;
+				for (int k = 1; k < n; k++)
+					value += data[k] * cos(M_PI / n * (i + 0.5) * k);
+				expected[i] = value * 2 / n;
+			}
+
+			Math::DCT dct(bits, Math::DCT::DCT_III);
+			dct.calc(data);
+
+			TSM_ASSERT_LESS_THAN(Common::String::format("DCT-III bits %d", bits).c_str(), kMinPSNR, psnr(data, expected, n));
+
+			delete[] expected;
+			delete[] data;
+		}
+	}
+
+	void test_transform_speed() {
+#if BENCHMARK_TIME
+#ifdef SLOW_TESTS
+		const int iters = 20000;
+#else
+		const int iters = 2000;
+#endif
+		float *input = new float[4096];
+		float *data = new float[8192];
+		fillRandom(input, 4096, 1);
+
+		// WMA: IMDCT of 2048 point frames
+		{
+			Math::MDCT mdct(12, true, 1.0);
+			const uint32 start = g_system->getMillis();
+			for (int i = 0; i < iters; i++)
+				mdct.calcIMDCT(data, input);
+			debug("IMDCT 4096: %u ms for %d frames", g_system->getMillis() - start, iters);
+		}
+
+		// QDM2: inverse RDFT
+		{
+			Math::RDFT rdft(9, Math::RDFT::IDFT_C2R);
+			const uint32 start = g_system->getMillis();
+			for (int i = 0; i < iters * 4; i++) {
+				memcpy(data, input, 512 * sizeof(float));
+				rdft.calc(data);
+			}
+			debug("IDFT_C2R 512: %u ms for %d frames", g_system->getMillis() - start, iters * 4);
+		}
+
+		// Bink audio: RDFT and DCT-III of 2048 point frames
+		{
+			Math::RDFT rdft(11, Math::RDFT::DFT_C2R);
+			Math::DCT dct(11, Math::DCT::DCT_III);
+			uint32 start = g_system->getMillis();
+			for (int i = 0; i < iters; i++) {
+				memcpy(data, input, 2048 * sizeof(float));
+				rdft.calc(data);
+			}
+			const uint32 rdftTime = g_system->getMillis() - start;
+
+			start = g_system->getMillis();
+			for (int i = 0; i < iters; i++) {
+				memcpy(data, input, 2048 * sizeof(float));
+				dct.calc(data);
+			}
+			debug("DFT_C2R 2048: %u ms, DCT-III 2048: %u ms for %d frames", rdftTime, g_system->getMillis() - start, iters);
+		}
+
+		// Setting up the transforms of a WMA stream
+		{
+			const uint32 start = g_system->getMillis();
+			for (int i = 0; i < iters / 10; i++) {
+				for (int bits = 12; bits >= 8; bits--)
+					delete new Math::MDCT(bits, true, 1.0);
+			}
+			debug("WMA MDCT setup: %u ms for %d streams", g_system->getMillis() - start, iters / 10);
+		}
+
+		delete[] data;
+		delete[] input;
+#endif
+	}
+};
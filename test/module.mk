@@ -9,26 +9,37 @@ TESTS        := $(srcdir)/test/common/*.h \
 	$(srcdir)/test/common/compression/*.h \
 	$(srcdir)/test/common/formats/*.h \
 	$(srcdir)/test/audio/*.h \
+	$(srcdir)/test/backends/*.h \
 	$(srcdir)/test/math/*.h \
-	$(srcdir)/test/image/*.h
+	$(srcdir)/test/image/*.h \
+	$(srcdir)/test/video/*.h \
+	$(srcdir)/test/engines/*.h
 TEST_LIBS    :=
 
 ifdef POSIX
 TEST_LIBS += test/system/null_osystem.o \
+	backends/saves/default/async-saves.o \
+	engines/saveindex.o \
+	backends/timer/default/default-timer.o \
 	backends/fs/posix/posix-fs-factory.o \
 	backends/fs/posix/posix-fs.o \
 	backends/fs/posix/posix-iostream.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
+	backends/mixer/null/null-mixer.o \
 	backends/modular-backend.o
 endif
 
 ifdef WIN32
 TEST_LIBS += test/system/null_osystem.o \
+	backends/saves/default/async-saves.o \
+	engines/saveindex.o \
+	backends/timer/default/default-timer.o \
 	backends/fs/windows/windows-fs-factory.o \
 	backends/fs/windows/windows-fs.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
+	backends/mixer/null/null-mixer.o \
 	backends/modular-backend.o \
 	backends/platform/sdl/win32/win32_wrapper.o
 endif
@@ -38,7 +49,11 @@ TESTS += $(srcdir)/test/graphics/tinygl*.h
 endif
 
 # libcommon needs libformats and libformats needs libcommon: so libcommon is put twice
-TEST_LIBS +=	audio/libaudio.a math/libmath.a common/libcommon.a common/formats/libformats.a common/compression/libcompression.a common/libcommon.a image/libimage.a graphics/libgraphics.a
+TEST_LIBS +=	video/libvideo.a audio/libaudio.a math/libmath.a common/libcommon.a common/formats/libformats.a common/compression/libcompression.a common/libcommon.a image/libimage.a graphics/libgraphics.a
+
+ifdef USE_MT32EMU
+	TEST_LIBS += audio/softsynth/mt32/libmt32.a
+endif
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -8,6 +8,7 @@
 #undef USE_CLOUD
 #endif
 #include "../backends/saves/savefile.cpp"
+#include "../backends/saves/default/default-saves.cpp"
 
 //#define DISPLAY_ERROR_MESSAGES
 
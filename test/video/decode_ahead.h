@@ -0,0 +1,299 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/queue.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "video/decode_ahead.h"
+#include "video/mpegps_decoder.h"
+
+#include "../system/null_osystem.h"
+
+// The stages need OSystem for their mutexes and ConfMan for the config key
+#if NULL_OSYSTEM_IS_AVAILABLE
+
+class DecodeAheadTestSuite : public CxxTest::TestSuite {
+	/**
+	 * A stage converting synthetic YUV420 frames into a bounded queue of
+	 * surfaces, like the Theora decoder does.
+	 */
+	class SyntheticStage : public Video::DecodeAheadStage {
+	public:
+		SyntheticStage(uint16 width, uint16 height, uint frameCount, uint queueSize) :
+				_width(width), _height(height), _frameCount(frameCount), _queueSize(queueSize), _decoded(0) {
+			_yuv.resize(width * height * 3 / 2);
+			for (uint i = 0; i < _yuv.size(); i++)
+				_yuv[i] = (byte)((i * 2654435761U) >> 13);
+		}
+
+		~SyntheticStage() override {
+			stopDecodeAhead();
+
+			while (!_queue.empty())
+				freeFrame(_queue.pop().surface);
+		}
+
+		/** Take the next frame, decoding it if the queue is empty. */
+		Graphics::Surface *nextFrame(uint &index) {
+			Common::StackLock lock(_mutex);
+
+			if (_queue.empty()) {
+				if (!decodeFrame())
+					return nullptr;
+				if (isDecodingAhead())
+					addStall();
+			}
+
+			index = _queue.front().index;
+			return _queue.pop().surface;
+		}
+
+		uint queued() const {
+			Common::StackLock lock(_mutex);
+			return _queue.size();
+		}
+
+		static void freeFrame(Graphics::Surface *surface) {
+			surface->free();
+			delete surface;
+		}
+
+	protected:
+		bool decodeAhead() override {
+			if ((uint)_queue.size() >= _queueSize)
+				return false;
+			return decodeFrame();
+		}
+
+	private:
+		struct Frame {
+			Graphics::Surface *surface;
+			uint index;
+		};
+
+		bool decodeFrame() {
+			if (_decoded >= _frameCount)
+				return false;
+
+			Frame frame;
+			frame.index = _decoded++;
+			frame.surface = new Graphics::Surface();
+			frame.surface->create(_width, _height, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+			const byte *y = _yuv.data();
+			const byte *u = y + _width * _height;
+			const byte *v = u + _width * _height / 4;
+			YUVToRGBMan.convert420(frame.surface, Graphics::YUVToRGBManager::kScaleITU, y, u, v, _width, _height, _width, _width / 2);
+
+			_queue.push(frame);
+			return true;
+		}
+
+		uint16 _width, _height;
+		uint _frameCount;
+		uint _queueSize;
+		uint _decoded;
+		Common::Array<byte> _yuv;
+		Common::Queue<Frame> _queue;
+	};
+
+	/**
+	 * An MPEG elementary stream: a sequence header followed by filler, which
+	 * the demuxer cuts into packets of 1 KB. The last one is shorter.
+	 */
+	static Common::SeekableReadStream *createMPEGStream(uint packets) {
+		const uint32 size = packets * 1024 - 100;
+		byte *data = (byte *)malloc(size);
+		for (uint32 i = 0; i < size; i++)
+			data[i] = (byte)(i * 7);
+
+		WRITE_BE_UINT32(data, 0x1B3);
+		data[4] = 320 >> 4;
+		data[5] = ((320 & 0xF) << 4) | (240 >> 8);
+		data[6] = 240 & 0xFF;
+
+		return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+	}
+
+	static uint playMPEG(uint packets, uint32 &stalls) {
+		Video::MPEGPSDecoder decoder;
+		decoder.setPrebufferedPackets(8);
+		if (!decoder.loadStream(createMPEGStream(packets)))
+			return 0;
+
+		// Without MPEG-2 support, each packet counts as a frame
+		uint frames = 0;
+		while (!decoder.endOfVideo() && frames <= packets * 2) {
+			decoder.decodeNextFrame();
+			frames++;
+		}
+
+		stalls = decoder.getDemuxStalls();
+		return frames;
+	}
+
+	static void setDecodeAhead(bool enable) {
+		ConfMan.setBool("video_decode_ahead", enable, Common::ConfigManager::kTransientDomain);
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+	}
+
+	void tearDown() {
+		ConfMan.removeKey("video_decode_ahead", Common::ConfigManager::kTransientDomain);
+		Video::DecodeAheadManager::destroy();
+		Common::uninstall_null_g_system();
+	}
+
+	void test_disabled_by_default() {
+		SyntheticStage stage(64, 48, 4, 2);
+		TS_ASSERT(!stage.startDecodeAhead());
+		TS_ASSERT(!stage.isDecodingAhead());
+
+		// The decoder does all the work itself, which is not a stall
+		uint index;
+		SyntheticStage::freeFrame(stage.nextFrame(index));
+		TS_ASSERT_EQUALS(stage.getStalls(), 0u);
+	}
+
+	void test_prefetch_is_bounded() {
+		setDecodeAhead(true);
+
+		SyntheticStage stage(64, 48, 10, 3);
+		TS_ASSERT(stage.startDecodeAhead());
+		TS_ASSERT(stage.isDecodingAhead());
+
+		stage.prefetch();
+		TS_ASSERT_EQUALS(stage.queued(), 3u);
+		TS_ASSERT_EQUALS(stage.getPrefetchedSteps(), 3u);
+
+		// The queue is full, so nothing more is decoded
+		stage.prefetch();
+		TS_ASSERT_EQUALS(stage.getPrefetchedSteps(), 3u);
+
+		// The frames come in order, and only the one after the queued ones
+		// is decoded by the consumer
+		for (uint f = 0; f < 4; f++) {
+			uint index = 0;
+			Graphics::Surface *frame = stage.nextFrame(index);
+			TS_ASSERT(frame);
+			if (!frame)
+				return;
+			TS_ASSERT_EQUALS(index, f);
+			SyntheticStage::freeFrame(frame);
+		}
+		TS_ASSERT_EQUALS(stage.getStalls(), 1u);
+
+		// The remaining frames, and nothing more
+		stage.prefetch();
+		TS_ASSERT_EQUALS(stage.queued(), 3u);
+		stage.prefetch();
+		for (uint f = 4; f < 10; f++) {
+			uint index = 0;
+			Graphics::Surface *frame = stage.nextFrame(index);
+			TS_ASSERT(frame);
+			if (!frame)
+				return;
+			TS_ASSERT_EQUALS(index, f);
+			SyntheticStage::freeFrame(frame);
+
+			if (f == 6)
+				stage.prefetch();
+		}
+
+		// Running out of frames is not a stall
+		uint index;
+		TS_ASSERT(!stage.nextFrame(index));
+		TS_ASSERT_EQUALS(stage.getStalls(), 1u);
+	}
+
+	void test_stop_and_restart() {
+		setDecodeAhead(true);
+
+		SyntheticStage stage(64, 48, 4, 2);
+		TS_ASSERT(stage.startDecodeAhead());
+		stage.stopDecodeAhead();
+		TS_ASSERT(!stage.isDecodingAhead());
+
+		// The config is checked again after stopping
+		setDecodeAhead(false);
+		TS_ASSERT(!stage.startDecodeAhead());
+		setDecodeAhead(true);
+		TS_ASSERT(!stage.startDecodeAhead());
+		stage.stopDecodeAhead();
+		TS_ASSERT(stage.startDecodeAhead());
+	}
+
+	void test_mpegps_demux_ahead() {
+		const uint kPackets = 40;
+
+		uint32 stalls = 0;
+		const uint frames = playMPEG(kPackets, stalls);
+		TS_ASSERT_LESS_THAN_EQUALS(kPackets, frames);
+		TS_ASSERT_EQUALS(stalls, 0u);
+
+		// The same packets come out when the demuxer works ahead, and the
+		// decoder does not have to wait for the stream while the queues
+		// are topped up
+		setDecodeAhead(true);
+		TS_ASSERT_EQUALS(playMPEG(kPackets, stalls), frames);
+		TS_ASSERT_EQUALS(stalls, 0u);
+	}
+
+	void test_decode_ahead_benchmark() {
+#ifdef SLOW_TESTS
+		const uint kFrames = 240;
+#else
+		const uint kFrames = 30;
+#endif
+		setDecodeAhead(true);
+
+		// Each frame is decoded when the decoder needs it
+		uint32 start = g_system->getMillis();
+		{
+			SyntheticStage stage(640, 480, kFrames, 3);
+			uint index;
+			while (Graphics::Surface *frame = stage.nextFrame(index))
+				SyntheticStage::freeFrame(frame);
+		}
+		const uint32 inlineTime = g_system->getMillis() - start;
+
+		// The timer proc tops up the queue while the engine waits for the
+		// next frame, so only the time spent in nextFrame() is counted
+		uint32 consumerTime = 0;
+		uint32 stalls = 0;
+		{
+			SyntheticStage stage(640, 480, kFrames, 3);
+			TS_ASSERT(stage.startDecodeAhead());
+			stage.prefetch();
+
+			for (;;) {
+				start = g_system->getMillis();
+				uint index;
+				Graphics::Surface *frame = stage.nextFrame(index);
+				consumerTime += g_system->getMillis() - start;
+
+				if (!frame)
+					break;
+				SyntheticStage::freeFrame(frame);
+
+				stage.prefetch();
+			}
+
+			stalls = stage.getStalls();
+		}
+
+		TS_ASSERT_EQUALS(stalls, 0u);
+		debug("Decode-ahead: %u frames of 640x480 decoded at %u fps, the decoder spent %u ms on them, %u ms with decode-ahead",
+		      kFrames, inlineTime ? kFrames * 1000 / inlineTime : 0, inlineTime, consumerTime);
+	}
+};
+
+#endif
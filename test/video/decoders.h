@@ -0,0 +1,465 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/algorithm.h"
+#include "common/array.h"
+#include "common/crc.h"
+#include "common/memstream.h"
+#include "common/compression/deflate.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/surface.h"
+
+#include "video/dxa_decoder.h"
+#include "video/flic_decoder.h"
+
+#include "../system/null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+/**
+ * Generate the contents of frame @p f of a synthetic video: flat areas, a
+ * gradient and noise, so that both repeated and literal data are encoded.
+ */
+static void generateFrame(Common::Array<byte> &frame, uint16 width, uint16 height, uint16 f) {
+	frame.resize(width * height);
+	for (uint y = 0; y < height; y++) {
+		for (uint x = 0; x < width; x++) {
+			byte color;
+			if (x < width / 3u)
+				color = (byte)((y / 8 + f) * 16);
+			else if (x < width * 2u / 3)
+				color = (byte)(x + y + f);
+			else
+				color = (byte)((x * 2654435761U + y * 40503U + f * 97U) >> 13);
+			frame[y * width + x] = color;
+		}
+	}
+}
+
+/**
+ * Synthetic FLC stream: a palette and a raw frame, followed by frames
+ * compressed with byte runs. The expected frame contents are kept
+ * alongside, so decoded frames can be checked pixel by pixel.
+ */
+class SyntheticFlic {
+public:
+	SyntheticFlic(uint16 width, uint16 height, uint16 frameCount) :
+			_width(width), _height(height), _frameOffset2(0) {
+		Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::NO);
+
+		// File header, patched once all frames have been written
+		for (uint i = 0; i < 128; i++)
+			stream.writeByte(0);
+
+		for (uint16 f = 0; f < frameCount; f++) {
+			Common::Array<byte> frame;
+			generateFrame(frame, width, height, f);
+			writeFrame(stream, frame, f == 0);
+			_frames.push_back(frame);
+		}
+
+		_data = stream.getData();
+		_size = stream.size();
+
+		byte *data = _data;
+		WRITE_LE_UINT32(data, _size);
+		WRITE_LE_UINT16(data + 4, 0xAF12);
+		WRITE_LE_UINT16(data + 6, frameCount);
+		WRITE_LE_UINT16(data + 8, width);
+		WRITE_LE_UINT16(data + 10, height);
+		WRITE_LE_UINT16(data + 12, 8);       // color depth
+		WRITE_LE_UINT32(data + 16, 1000 / 15); // frame delay
+		WRITE_LE_UINT32(data + 80, 128);     // offset of frame 1
+		WRITE_LE_UINT32(data + 84, _frameOffset2);
+	}
+
+	~SyntheticFlic() {
+		free(_data);
+	}
+
+	Common::SeekableReadStream *createReadStream() const {
+		return new Common::MemoryReadStream(_data, _size);
+	}
+
+	uint32 size() const { return _size; }
+	const Common::Array<byte> &getFrame(uint frame) const { return _frames[frame]; }
+
+private:
+	void writeFrame(Common::WriteStream &stream, const Common::Array<byte> &frame, bool first) {
+		Common::MemoryWriteStreamDynamic chunks(DisposeAfterUse::YES);
+		uint16 chunkCount;
+
+		if (first) {
+			// FLI_SETPAL with all 256 colors
+			chunks.writeUint32LE(6 + 4 + 256 * 3);
+			chunks.writeUint16LE(4);
+			chunks.writeUint16LE(1);
+			chunks.writeUint16LE(0);
+			for (uint i = 0; i < 256; i++) {
+				chunks.writeByte(i);
+				chunks.writeByte(255 - i);
+				chunks.writeByte(i ^ 0x55);
+			}
+
+			// FLI_COPY
+			chunks.writeUint32LE(6 + frame.size());
+			chunks.writeUint16LE(16);
+			chunks.write(frame.data(), frame.size());
+			chunkCount = 2;
+		} else {
+			// FLI_BRUN
+			Common::Array<byte> rle;
+			for (uint y = 0; y < _height; y++)
+				encodeByteRun(rle, frame.data() + y * _width);
+
+			chunks.writeUint32LE(6 + rle.size());
+			chunks.writeUint16LE(15);
+			chunks.write(rle.data(), rle.size());
+			chunkCount = 1;
+		}
+
+		if (_frames.size() == 1)
+			_frameOffset2 = stream.pos();
+
+		stream.writeUint32LE(16 + chunks.size());
+		stream.writeUint16LE(0xF1FA);
+		stream.writeUint16LE(chunkCount);
+		stream.writeUint16LE(0); // keep the header frame delay
+		stream.writeUint16LE(0);
+		stream.writeUint16LE(0);
+		stream.writeUint16LE(0);
+		stream.write(chunks.getData(), chunks.size());
+	}
+
+	void encodeByteRun(Common::Array<byte> &out, const byte *row) const {
+		out.push_back(0); // packet count, unused by the decoder
+
+		uint x = 0;
+		while (x < _width) {
+			uint run = 1;
+			while (x + run < _width && run < 127 && row[x + run] == row[x])
+				run++;
+
+			if (run >= 3) {
+				out.push_back((byte)run);
+				out.push_back(row[x]);
+				x += run;
+				continue;
+			}
+
+			// Literal run up to the next repeat of three pixels
+			uint literal = 0;
+			while (x + literal < _width && literal < 127) {
+				const byte *p = row + x + literal;
+				if (x + literal + 2 < _width && p[0] == p[1] && p[1] == p[2])
+					break;
+				literal++;
+			}
+
+			out.push_back((byte)-(int8)literal);
+			for (uint i = 0; i < literal; i++)
+				out.push_back(row[x + i]);
+			x += literal;
+		}
+	}
+
+	uint16 _width, _height;
+	uint32 _frameOffset2;
+	byte *_data;
+	uint32 _size;
+	Common::Array<Common::Array<byte> > _frames;
+};
+
+#ifdef USE_ZLIB
+/**
+ * Synthetic DXA stream: a zlib compressed first frame with a palette,
+ * followed by zlib compressed XOR deltas against the previous frame.
+ */
+class SyntheticDxa {
+public:
+	SyntheticDxa(uint16 width, uint16 height, uint16 frameCount) {
+		Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::NO);
+
+		stream.writeUint32BE(MKTAG('D','E','X','A'));
+		stream.writeByte(0);                 // flags
+		stream.writeUint16BE(frameCount);
+		stream.writeSint32BE(1000 / 15);     // frame delay
+		stream.writeUint16BE(width);
+		stream.writeUint16BE(height);
+		stream.writeUint32BE(MKTAG('N','U','L','L')); // no sound
+
+		for (uint16 f = 0; f < frameCount; f++) {
+			Common::Array<byte> frame;
+			generateFrame(frame, width, height, f);
+
+			if (f == 0) {
+				stream.writeUint32BE(MKTAG('C','M','A','P'));
+				for (uint i = 0; i < 256; i++) {
+					stream.writeByte(i);
+					stream.writeByte(255 - i);
+					stream.writeByte(i ^ 0x55);
+				}
+			} else {
+				stream.writeUint32BE(MKTAG('N','U','L','L'));
+			}
+
+			Common::Array<byte> data = frame;
+			if (f > 0) {
+				const Common::Array<byte> &previous = _frames.back();
+				for (uint i = 0; i < data.size(); i++)
+					data[i] ^= previous[i];
+			}
+
+			Common::Array<byte> compressed;
+			compressZlib(compressed, data);
+
+			stream.writeUint32BE(MKTAG('F','R','A','M'));
+			stream.writeByte(f == 0 ? 2 : 3);
+			stream.writeUint32BE(compressed.size());
+			stream.write(compressed.data(), compressed.size());
+
+			_frames.push_back(frame);
+		}
+
+		_data = stream.getData();
+		_size = stream.size();
+	}
+
+	~SyntheticDxa() {
+		free(_data);
+	}
+
+	Common::SeekableReadStream *createReadStream() const {
+		return new Common::MemoryReadStream(_data, _size);
+	}
+
+	uint32 size() const { return _size; }
+	const Common::Array<byte> &getFrame(uint frame) const { return _frames[frame]; }
+
+private:
+	/**
+	 * Compress @p data into a zlib stream. The deflate data is taken from a
+	 * gzip stream, which only differs in its header and trailer.
+	 */
+	static void compressZlib(Common::Array<byte> &out, const Common::Array<byte> &data) {
+		// The compressor takes ownership of the memory stream, but not of its data
+		Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(gzip);
+		compressor->write(data.data(), data.size());
+		compressor->finalize();
+		byte *gzipData = gzip->getData();
+		const uint32 gzipSize = gzip->size();
+		delete compressor;
+
+		// Skip the 10 byte gzip header and the 8 byte trailer
+		out.resize(2 + gzipSize - 18 + 4);
+		out[0] = 0x78;
+		out[1] = 0x9C;
+		memcpy(out.data() + 2, gzipData + 10, gzipSize - 18);
+		free(gzipData);
+
+		uint32 a = 1, b = 0;
+		for (uint i = 0; i < data.size(); i++) {
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		WRITE_BE_UINT32(out.data() + out.size() - 4, (b << 16) | a);
+	}
+
+	byte *_data;
+	uint32 _size;
+	Common::Array<Common::Array<byte> > _frames;
+};
+#endif
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+#endif
+	}
+
+	void tearDown() {
+#if BENCHMARK_TIME
+		Common::uninstall_null_g_system();
+#endif
+	}
+
+	void test_flic_frames() {
+		SyntheticFlic flic(64, 48, 8);
+
+		Video::FlicDecoder decoder;
+		TS_ASSERT(decoder.loadStream(flic.createReadStream()));
+		TS_ASSERT_EQUALS(decoder.getFrameCount(), 8);
+		TS_ASSERT_EQUALS(decoder.getWidth(), 64);
+		TS_ASSERT_EQUALS(decoder.getHeight(), 48);
+
+		for (uint f = 0; f < 8; f++) {
+			const Graphics::Surface *surface = decoder.decodeNextFrame();
+			TS_ASSERT(surface);
+			if (!surface)
+				return;
+
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), (int)f);
+			TS_ASSERT_EQUALS(frameChecksum(*surface), checksum(flic.getFrame(f)));
+		}
+
+		TS_ASSERT(decoder.endOfVideo());
+	}
+
+	void test_flic_rewind() {
+		SyntheticFlic flic(64, 48, 4);
+
+		Video::FlicDecoder decoder;
+		TS_ASSERT(decoder.loadStream(flic.createReadStream()));
+
+		Common::Array<uint32> first, second;
+		decodeAll(decoder, first);
+		TS_ASSERT(decoder.rewind());
+		decodeAll(decoder, second);
+
+		TS_ASSERT_EQUALS(first.size(), 4U);
+		TS_ASSERT(first == second);
+	}
+
+	void test_flic_speed() {
+#ifdef SLOW_TESTS
+		SyntheticFlic flic(640, 480, 300);
+#else
+		SyntheticFlic flic(320, 200, 10);
+#endif
+		Video::FlicDecoder decoder;
+		TS_ASSERT(decoder.loadStream(flic.createReadStream()));
+		benchmark(decoder, "FLIC", flic.size());
+	}
+
+#ifdef USE_ZLIB
+	void test_dxa_frames() {
+		SyntheticDxa dxa(64, 48, 8);
+
+		Video::DXADecoder decoder;
+		TS_ASSERT(decoder.loadStream(dxa.createReadStream()));
+		TS_ASSERT_EQUALS(decoder.getFrameCount(), 8);
+		TS_ASSERT_EQUALS(decoder.getWidth(), 64);
+		TS_ASSERT_EQUALS(decoder.getHeight(), 48);
+
+		for (uint f = 0; f < 8; f++) {
+			const Graphics::Surface *surface = decoder.decodeNextFrame();
+			TS_ASSERT(surface);
+			if (!surface)
+				return;
+
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), (int)f);
+			TS_ASSERT_EQUALS(frameChecksum(*surface), checksum(dxa.getFrame(f)));
+		}
+
+		TS_ASSERT(decoder.endOfVideo());
+	}
+
+	void test_dxa_speed() {
+#ifdef SLOW_TESTS
+		SyntheticDxa dxa(640, 480, 300);
+#else
+		SyntheticDxa dxa(320, 200, 10);
+#endif
+		Video::DXADecoder decoder;
+		TS_ASSERT(decoder.loadStream(dxa.createReadStream()));
+		benchmark(decoder, "DXA", dxa.size());
+	}
+#endif
+
+private:
+	static uint32 checksum(const Common::Array<byte> &data) {
+		return Common::CRC32().crcFast(data.data(), data.size());
+	}
+
+	static uint32 frameChecksum(const Graphics::Surface &surface) {
+		const uint rowSize = surface.w * surface.format.bytesPerPixel;
+		Common::Array<byte> pixels;
+		pixels.resize(rowSize * surface.h);
+		for (int y = 0; y < surface.h; y++)
+			memcpy(pixels.data() + y * rowSize, surface.getBasePtr(0, y), rowSize);
+		return checksum(pixels);
+	}
+
+	static void decodeAll(Video::VideoDecoder &decoder, Common::Array<uint32> &checksums) {
+		while (!decoder.endOfVideo()) {
+			const Graphics::Surface *surface = decoder.decodeNextFrame();
+			if (!surface)
+				break;
+			checksums.push_back(frameChecksum(*surface));
+		}
+	}
+
+	/**
+	 * Decode every frame of the video and report the per-frame decode time
+	 * percentiles, the compressed bytes per frame and a checksum over all
+	 * frames, which can be compared between builds.
+	 *
+	 * The clock only has a resolution of a millisecond, so the video is
+	 * decoded over and over for at least kBenchmarkMillis, and the time of
+	 * each frame is averaged over all the passes.
+	 */
+	static void benchmark(Video::VideoDecoder &decoder, const char *name, uint32 streamSize) {
+#if BENCHMARK_TIME
+		const uint32 kBenchmarkMillis = 200;
+		const uint kMaxPasses = 1000;
+
+		Common::Array<uint32> frameMillis;
+		uint32 sum = 0;
+		uint passes = 0;
+		const uint32 benchmarkStart = g_system->getMillis();
+
+		do {
+			if (passes > 0 && !decoder.rewind())
+				break;
+
+			uint frame = 0;
+			while (!decoder.endOfVideo()) {
+				const uint32 start = g_system->getMillis();
+				const Graphics::Surface *surface = decoder.decodeNextFrame();
+				const uint32 time = g_system->getMillis() - start;
+
+				if (!surface)
+					break;
+				if (frame == frameMillis.size())
+					frameMillis.push_back(0);
+				frameMillis[frame] += time;
+				if (passes == 0)
+					sum ^= frameChecksum(*surface) + frame;
+				frame++;
+			}
+
+			passes++;
+		} while (g_system->getMillis() - benchmarkStart < kBenchmarkMillis && passes < kMaxPasses);
+
+		TS_ASSERT(!frameMillis.empty());
+		if (frameMillis.empty())
+			return;
+
+		// Average time of each frame, in microseconds
+		Common::Array<uint32> times;
+		uint64 total = 0;
+		for (uint i = 0; i < frameMillis.size(); i++) {
+			times.push_back((uint64)frameMillis[i] * 1000 / passes);
+			total += frameMillis[i];
+		}
+
+		Common::sort(times.begin(), times.end());
+		debug("%s: %d frames of %dx%d, %d passes, %d us per frame, p50 %d us, p99 %d us, %d bytes per frame, checksum %08x",
+		      name, times.size(), decoder.getWidth(), decoder.getHeight(), passes,
+		      (int)(total * 1000 / passes / times.size()), times[times.size() / 2], times[(times.size() * 99) / 100],
+		      streamSize / times.size(), sum);
+#endif
+	}
+};
@@ -978,6 +978,7 @@ AVIDecoder::AVIVideoTrack::AVIVideoTrack(int frameCount, const AVIStreamHeader &
 	_lastFrame = 0;
 	_curFrame = -1;
 	_reversed = false;
+	_hasOutputSurface = false;
 
 	useInitialPalette();
 }
@@ -1019,6 +1020,19 @@ bool AVIDecoder::AVIVideoTrack::setOutputPixelFormat(const Graphics::PixelFormat
 	return false;
 }
 
+bool AVIDecoder::AVIVideoTrack::setOutputSurface(const Graphics::Surface *area) {
+	_hasOutputSurface = false;
+
+	if (!_videoCodec || !_videoCodec->setOutputSurface(area))
+		return false;
+
+	if (area) {
+		_outputSurface = *area;
+		_hasOutputSurface = true;
+	}
+	return true;
+}
+
 void AVIDecoder::AVIVideoTrack::loadPaletteFromChunkRaw(Common::SeekableReadStream *chunk, int firstEntry, int numEntries) {
 	assert(chunk);
 	assert(firstEntry >= 0);
@@ -1075,6 +1089,11 @@ bool AVIDecoder::AVIVideoTrack::rewind() {
 	delete _videoCodec;
 	_videoCodec = createCodec();
 	_lastFrame = 0;
+
+	// The new codec starts with a key frame, so nothing is lost if it has
+	// to go back to its own surface
+	if (_hasOutputSurface && _videoCodec)
+		_hasOutputSurface = _videoCodec->setOutputSurface(&_outputSurface);
 	return true;
 }
 
@@ -214,6 +214,7 @@ protected:
 		uint16 getBitCount() const { return _bmInfo.bitCount; }
 		Graphics::PixelFormat getPixelFormat() const override;
 		bool setOutputPixelFormat(const Graphics::PixelFormat &format) override;
+		bool setOutputSurface(const Graphics::Surface *area) override;
 		void setCodecAccuracy(Image::CodecAccuracy accuracy) override;
 		int getCurFrame() const override { return _curFrame; }
 		int getFrameCount() const override { return _frameCount; }
@@ -281,6 +282,10 @@ protected:
 		const Graphics::Surface *_lastFrame;
 		Image::CodecAccuracy _accuracy;
 
+		// Given to the codec again when it is recreated
+		Graphics::Surface _outputSurface;
+		bool _hasOutputSurface;
+
 		Image::Codec *createCodec();
 	};
 
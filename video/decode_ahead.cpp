@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/decode_ahead.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+namespace Common {
+DECLARE_SINGLETON(Video::DecodeAheadManager);
+}
+
+namespace Video {
+
+enum {
+	// How often the timer proc tops up the queues, in microseconds
+	kDecodeInterval = 10000
+};
+
+DecodeAheadStage::DecodeAheadStage() : _started(false), _decodingAhead(false), _stalls(0), _prefetchedSteps(0) {
+}
+
+DecodeAheadStage::~DecodeAheadStage() {
+	// Subclasses stop it themselves, before destroying what the steps use
+	assert(!_decodingAhead);
+
+	debug(2, "DecodeAheadStage: %u steps done ahead, %u stalls", _prefetchedSteps, _stalls);
+}
+
+void DecodeAheadStage::prefetch() {
+	for (;;) {
+		// The lock is released between the steps, so the decoder does not
+		// wait for more than one of them
+		Common::StackLock lock(_mutex);
+		if (!decodeAhead())
+			return;
+		_prefetchedSteps++;
+	}
+}
+
+bool DecodeAheadStage::startDecodeAhead() {
+	if (_started)
+		return _decodingAhead;
+	_started = true;
+
+	if (!ConfMan.hasKey("video_decode_ahead") || !ConfMan.getBool("video_decode_ahead"))
+		return false;
+
+	DecodeAheadManager::instance().add(this);
+	_decodingAhead = true;
+	return true;
+}
+
+void DecodeAheadStage::stopDecodeAhead() {
+	_started = false;
+	if (!_decodingAhead)
+		return;
+
+	// Without a manager, the stage was already no longer topped up
+	if (DecodeAheadManager::hasInstance())
+		DecodeAheadManager::instance().remove(this);
+	_decodingAhead = false;
+}
+
+uint32 DecodeAheadStage::getStalls() const {
+	Common::StackLock lock(_mutex);
+	return _stalls;
+}
+
+uint32 DecodeAheadStage::getPrefetchedSteps() const {
+	Common::StackLock lock(_mutex);
+	return _prefetchedSteps;
+}
+
+DecodeAheadManager::DecodeAheadManager() {
+	// The null backend used by the tests has no timer manager, the stages
+	// are then only filled by prefetch() and the decoders
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+	if (timerManager)
+		timerManager->installTimerProc(timerProc, kDecodeInterval, this, "DecodeAheadManager");
+}
+
+DecodeAheadManager::~DecodeAheadManager() {
+	// Stages still in use keep working, but the decoders do all the work
+	// themselves again, like they would without decode-ahead
+	Common::TimerManager *timerManager = g_system->getTimerManager();
+	if (timerManager)
+		timerManager->removeTimerProc(timerProc);
+}
+
+void DecodeAheadManager::add(DecodeAheadStage *stage) {
+	Common::StackLock lock(_mutex);
+	_stages.push_back(stage);
+}
+
+void DecodeAheadManager::remove(DecodeAheadStage *stage) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _stages.size(); i++) {
+		if (_stages[i] == stage) {
+			_stages.remove_at(i);
+			break;
+		}
+	}
+}
+
+void DecodeAheadManager::timerProc(void *refCon) {
+	DecodeAheadManager *manager = static_cast<DecodeAheadManager *>(refCon);
+	Common::StackLock lock(manager->_mutex);
+
+	for (uint i = 0; i < manager->_stages.size(); i++)
+		manager->_stages[i]->prefetch();
+}
+
+} // End of namespace Video
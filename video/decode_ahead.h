@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef VIDEO_DECODE_AHEAD_H
+#define VIDEO_DECODE_AHEAD_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/types.h"
+
+namespace Video {
+
+/**
+ * Base class of the stages of a video decoder which can work ahead of the
+ * thread calling decodeNextFrame(), such as demuxing packets or decoding
+ * frames into a bounded queue.
+ *
+ * When decode-ahead is enabled, a timer proc of DecodeAheadManager calls
+ * prefetch(), which fills the queue of the stage one step at a time. The
+ * decoder takes what it needs from the queue with _mutex held, and only
+ * does the work itself when the queue is empty.
+ *
+ * Each step runs with _mutex held, so everything the stage reads, such as
+ * the file stream of the video, is only used by one thread at a time. The
+ * file stream must not be shared with anything else while decode-ahead is
+ * enabled.
+ */
+class DecodeAheadStage {
+public:
+	DecodeAheadStage();
+	virtual ~DecodeAheadStage();
+
+	/**
+	 * Fill the queue of the stage, one step at a time. This is called from
+	 * the timer proc; call it directly to fill the queue before playing.
+	 */
+	void prefetch();
+
+	/**
+	 * Let the timer proc of DecodeAheadManager fill the queue, if
+	 * decode-ahead is enabled with the "video_decode_ahead" config key.
+	 * Only the first call after stopDecodeAhead() checks the key.
+	 *
+	 * @return whether the stage is now topped up by the timer proc
+	 */
+	bool startDecodeAhead();
+
+	/**
+	 * Stop topping up the queue from the timer proc, waiting for it if it
+	 * is working on this stage. This must be called before anything the
+	 * stage uses is destroyed, at the latest at the start of the destructor
+	 * of the subclass.
+	 */
+	void stopDecodeAhead();
+
+	/** Return whether the queue is topped up by the timer proc. */
+	bool isDecodingAhead() const { return _decodingAhead; }
+
+	/**
+	 * Return how many times the decoder found the queue empty, and had to
+	 * do the work itself.
+	 */
+	uint32 getStalls() const;
+
+	/** Return the number of steps done by prefetch(). */
+	uint32 getPrefetchedSteps() const;
+
+protected:
+	/**
+	 * Do one step of work, such as demuxing one packet or decoding one
+	 * frame, unless the queue is full. This is called with _mutex held.
+	 *
+	 * @return false if the queue is full or there is nothing left to do
+	 */
+	virtual bool decodeAhead() = 0;
+
+	/** Count a stall. This is called with _mutex held. */
+	void addStall() { _stalls++; }
+
+	// Held for each step of decodeAhead(), and by the decoder while it
+	// takes from the queue
+	mutable Common::Mutex _mutex;
+
+private:
+	bool _started;
+	bool _decodingAhead;
+	uint32 _stalls;
+	uint32 _prefetchedSteps;
+};
+
+/**
+ * Tops up all decode-ahead stages from one timer proc, as the timer manager
+ * does not allow installing the same proc twice.
+ *
+ * The timer proc is removed when the engine is destroyed.
+ */
+class DecodeAheadManager : public Common::Singleton<DecodeAheadManager> {
+public:
+	void add(DecodeAheadStage *stage);
+
+	/** Remove a stage, waiting for the timer proc if it is topping it up. */
+	void remove(DecodeAheadStage *stage);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DecodeAheadManager();
+	~DecodeAheadManager();
+
+	static void timerProc(void *refCon);
+
+	Common::Mutex _mutex;
+	Common::Array<DecodeAheadStage *> _stages;
+};
+
+} // End of namespace Video
+
+#endif
@@ -6,6 +6,7 @@ MODULE_OBJS := \
 	4xm_utils.o \
 	avi_decoder.o \
 	coktel_decoder.o \
+	decode_ahead.o \
 	dxa_decoder.o \
 	flic_decoder.o \
 	mpegps_decoder.o \
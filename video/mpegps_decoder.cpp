@@ -293,10 +293,14 @@ bool MPEGPSDecoder::MPEGPSDemuxer::loadStream(Common::SeekableReadStream *stream
 		queuedPackets++;
 	}
 
+	startDecodeAhead();
 	return true;
 }
 
 void MPEGPSDecoder::MPEGPSDemuxer::close() {
+	// The timer proc must be done with the stream first
+	stopDecodeAhead();
+
 	delete _stream;
 	_stream = 0;
 
@@ -315,6 +319,8 @@ void MPEGPSDecoder::MPEGPSDemuxer::close() {
 }
 
 Common::SeekableReadStream *MPEGPSDecoder::MPEGPSDemuxer::getFirstVideoPacket(int32 &startCode, uint32 &pts, uint32 &dts) {
+	Common::StackLock lock(_mutex);
+
 	if (_videoQueue.empty())
 		return nullptr;
 	Packet packet = _videoQueue.front();
@@ -324,8 +330,22 @@ Common::SeekableReadStream *MPEGPSDecoder::MPEGPSDemuxer::getFirstVideoPacket(in
 	return packet._stream;
 }
 
+bool MPEGPSDecoder::MPEGPSDemuxer::decodeAhead() {
+	// Called with _mutex held
+	if (!_stream || (int)(_audioQueue.size() + _videoQueue.size()) >= _prebufferedPackets)
+		return false;
+
+	return queueNextPacket();
+}
+
 Common::SeekableReadStream *MPEGPSDecoder::MPEGPSDemuxer::getNextPacket(uint32 currentTime, int32 &startCode, uint32 &pts, uint32 &dts) {
-	queueNextPacket();
+	Common::StackLock lock(_mutex);
+
+	// Top up the queues by one packet. When the timer proc demuxes ahead,
+	// this only reads the stream if it fell behind.
+	const bool starved = _audioQueue.empty() && _videoQueue.empty();
+	if (decodeAhead() && starved && isDecodingAhead())
+		addStall();
 
 	// The idea here is to prioritize the delivery of audio packets,
 	// because when the decoder wants a frame it will keep asking until it
@@ -25,6 +25,7 @@
 #include "common/hashmap.h"
 #include "common/queue.h"
 #include "graphics/surface.h"
+#include "video/decode_ahead.h"
 #include "video/video_decoder.h"
 
 namespace Audio {
@@ -64,12 +65,18 @@ public:
 	// Used only by qdEngine
 	void setPrebufferedPackets(int packets);
 
+	// Return how many times the demuxer ran out of packets while it was
+	// demuxing ahead from the timer proc
+	uint32 getDemuxStalls() const { return _demuxer->getStalls(); }
+
 protected:
 	void readNextPacket() override;
 	bool useAudioSync() const override { return false; }
 
 private:
-	class MPEGPSDemuxer {
+	// Demuxes ahead from the timer proc if decode-ahead is enabled, up to
+	// the number of prebuffered packets
+	class MPEGPSDemuxer : public DecodeAheadStage {
 	public:
 		MPEGPSDemuxer();
 		~MPEGPSDemuxer();
@@ -82,6 +89,9 @@ private:
 
 		void setPrebufferedPackets(int packets) { _prebufferedPackets = packets; }
 
+	protected:
+		bool decodeAhead() override;
+
 	private:
 		class Packet {
 		public:
@@ -501,6 +501,27 @@ bool QuickTimeDecoder::VideoTrackHandler::setOutputPixelFormat(const Graphics::P
 	return success;
 }
 
+bool QuickTimeDecoder::VideoTrackHandler::setOutputSurface(const Graphics::Surface *area) {
+	// Only frames which are returned as decoded can be decoded in place, and
+	// with several sample descriptions each codec would decode over the
+	// frames of the others
+	if (area && (_parent->sampleDescs.size() != 1 || _decoder->_qtvrType != QTVRType::OTHER ||
+			_parent->scaleFactorX != 1 || _parent->scaleFactorY != 1))
+		return false;
+
+	bool success = true;
+	for (uint i = 0; i < _parent->sampleDescs.size(); i++) {
+		VideoSampleDesc *desc = (VideoSampleDesc *)_parent->sampleDescs[i];
+
+		if (desc->_videoCodec)
+			success = desc->_videoCodec->setOutputSurface(area) && success;
+		else
+			success = false;
+	}
+
+	return success;
+}
+
 int QuickTimeDecoder::VideoTrackHandler::getFrameCount() const {
 	return _parent->frameCount;
 }
@@ -47,6 +47,11 @@
 
 namespace Video {
 
+// Amount of data handed to the Ogg demuxer at once. Reading several pages
+// per call keeps the number of stream reads per frame low, which matters
+// for streams backed by slow archives.
+static const int kOggReadChunkSize = 64 * 1024;
+
 TheoraDecoder::TheoraDecoder() {
 	_fileStream = 0;
 
@@ -168,7 +173,7 @@ bool TheoraDecoder::loadStream(Common::SeekableReadStream *stream) {
 
 	// And now we have it all. Initialize decoders next
 	if (_hasVideo) {
-		_videoTrack = new TheoraVideoTrack(theoraInfo, theoraSetup);
+		_videoTrack = new TheoraVideoTrack(theoraInfo, theoraSetup, _mutex);
 		addTrack(_videoTrack);
 	}
 
@@ -198,6 +203,9 @@ bool TheoraDecoder::loadStream(Common::SeekableReadStream *stream) {
 }
 
 void TheoraDecoder::close() {
+	// The timer proc must be done with the tracks and the stream first
+	stopDecodeAhead();
+
 	VideoDecoder::close();
 
 	if (!_fileStream)
@@ -223,30 +231,65 @@ void TheoraDecoder::close() {
 }
 
 void TheoraDecoder::readNextPacket() {
-	// First, let's get our frame
-	if (_hasVideo) {
-		while (!_videoTrack->endOfTrack()) {
-			// theora is one in, one out...
-			if (ogg_stream_packetout(&_theoraOut, &_oggPacket) > 0) {
-				if (_videoTrack->decodePacket(_oggPacket))
-					break;
-			} else if (_theoraOut.e_o_s || _fileStream->eos()) {
-				// If we can't get any more frames, we're done.
-				_videoTrack->setEndOfVideo();
-			} else {
-				// Queue more data
-				bufferData();
-				while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
-					queuePage(&_oggPage);
+	{
+		Common::StackLock lock(_mutex);
+
+		// First, let's get our frame, unless the timer proc already did
+		if (_hasVideo) {
+			if (!_videoTrack->hasQueuedFrame() && !_videoTrack->isEndOfVideo()) {
+				if (isDecodingAhead())
+					addStall();
+				decodeFrame();
 			}
 
-			// Update audio if we can
-			queueAudio();
+			_videoTrack->showNextFrame();
 		}
+
+		// Then make sure we have enough audio buffered
+		ensureAudioBufferSize();
 	}
 
-	// Then make sure we have enough audio buffered
-	ensureAudioBufferSize();
+	// The first frame is decoded here, after the output format was set
+	startDecodeAhead();
+}
+
+bool TheoraDecoder::decodeAhead() {
+	// Called with _mutex held
+	if (!_fileStream)
+		return false;
+
+	if (_hasAudio && _audioTrack->needsAudio()) {
+		bufferAudio();
+		return true;
+	}
+
+	if (_hasVideo && !_videoTrack->isEndOfVideo() && !_videoTrack->isQueueFull()) {
+		decodeFrame();
+		return true;
+	}
+
+	return false;
+}
+
+void TheoraDecoder::decodeFrame() {
+	while (!_videoTrack->isEndOfVideo()) {
+		// theora is one in, one out...
+		if (ogg_stream_packetout(&_theoraOut, &_oggPacket) > 0) {
+			if (_videoTrack->decodePacket(_oggPacket))
+				break;
+		} else if (_theoraOut.e_o_s || _fileStream->eos()) {
+			// If we can't get any more frames, we're done.
+			_videoTrack->setEndOfVideo();
+		} else {
+			// Queue more data
+			bufferData();
+			while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
+				queuePage(&_oggPage);
+		}
+
+		// Update audio if we can
+		queueAudio();
+	}
 }
 
 Common::Rational TheoraDecoder::getFrameRate() const {
@@ -255,7 +298,7 @@ Common::Rational TheoraDecoder::getFrameRate() const {
 	return Common::Rational();
 }
 
-TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(th_info &theoraInfo, th_setup_info *theoraSetup) {
+TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(th_info &theoraInfo, th_setup_info *theoraSetup, Common::Mutex &mutex) : _mutex(mutex) {
 	_theoraDecode = th_decode_alloc(&theoraInfo, theoraSetup);
 
 	if (theoraInfo.pixel_fmt != TH_PF_420 && theoraInfo.pixel_fmt != TH_PF_422 && theoraInfo.pixel_fmt != TH_PF_444) {
@@ -282,24 +325,34 @@ TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(th_info &theoraInfo, th_setup_
 	_endOfVideo = false;
 	_nextFrameStartTime = 0.0;
 	_curFrame = -1;
-	_surface = nullptr;
-	_displaySurface = nullptr;
+	_displaySlot = -1;
+	_decodedFrame = -1;
+	_decodedFrameEndTime = 0.0;
+
+	for (uint i = 0; i < ARRAYSIZE(_surfaces); i++)
+		_surfaces[i] = nullptr;
 }
 
 TheoraDecoder::TheoraVideoTrack::~TheoraVideoTrack() {
 	th_decode_free(_theoraDecode);
 
-	if (_surface) {
-		_surface->free();
-		delete _surface;
-		_surface = nullptr;
+	for (uint i = 0; i < ARRAYSIZE(_surfaces); i++) {
+		if (_surfaces[i]) {
+			_surfaces[i]->free();
+			delete _surfaces[i];
+		}
 	}
+}
 
-	if (_displaySurface) {
-		_displaySurface->setPixels(0);
-		delete _displaySurface;
-		_displaySurface = nullptr;
-	}
+bool TheoraDecoder::TheoraVideoTrack::endOfTrack() const {
+	Common::StackLock lock(_mutex);
+	return _endOfVideo && _queuedFrames.empty();
+}
+
+int TheoraDecoder::TheoraVideoTrack::getFreeSlot() const {
+	// The surfaces are used in turn, after the one of the frame shown and
+	// those of the queued frames
+	return (_displaySlot + 1 + _queuedFrames.size()) % ARRAYSIZE(_surfaces);
 }
 
 bool TheoraDecoder::TheoraVideoTrack::decodePacket(ogg_packet &oggPacket) {
@@ -309,37 +362,68 @@ bool TheoraDecoder::TheoraVideoTrack::decodePacket(ogg_packet &oggPacket) {
 	bool gotDupFrame = decodeRes == TH_DUPFRAME; // no decoding needed, just update timing
 	
 	if (gotNewFrame || gotDupFrame) {
+		const int slot = getFreeSlot();
+		if (!_surfaces[slot]) {
+			_surfaces[slot] = new Graphics::Surface();
+			_surfaces[slot]->create(_surfaceWidth, _surfaceHeight, _pixelFormat);
+		}
+
 		if (gotNewFrame) {
 			// Convert YUV data to RGB data
 			th_ycbcr_buffer yuv;
 			th_decode_ycbcr_out(_theoraDecode, yuv);
-			translateYUVtoRGBA(yuv);
+			translateYUVtoRGBA(yuv, _surfaces[slot]);
+		} else {
+			// The surface of the previous frame may be in use, so the
+			// frame is repeated in its own surface
+			const int previousSlot = _queuedFrames.empty() ? _displaySlot : (int)((slot + ARRAYSIZE(_surfaces) - 1) % ARRAYSIZE(_surfaces));
+			if (previousSlot >= 0)
+				_surfaces[slot]->copyFrom(*_surfaces[previousSlot]);
 		}
 
 		// If we have a valid granule position for this packet, use it to calculate the next
 		// frame information. If we don't have a valid granule position, we need to do our
 		// calculation for the frame number and timing.
 		if (oggPacket.granulepos >= 0) {
-			_curFrame = (int)th_granule_frame(_theoraDecode, oggPacket.granulepos);
-			_nextFrameStartTime = th_granule_time(_theoraDecode, oggPacket.granulepos);
+			_decodedFrame = (int)th_granule_frame(_theoraDecode, oggPacket.granulepos);
+			_decodedFrameEndTime = th_granule_time(_theoraDecode, oggPacket.granulepos);
 		} else {
-			_curFrame++;
-			_nextFrameStartTime += _frameRate.getInverse().toDouble();
+			_decodedFrame++;
+			_decodedFrameEndTime += _frameRate.getInverse().toDouble();
 		}
 
+		QueuedFrame frame;
+		frame.slot = slot;
+		frame.frame = _decodedFrame;
+		frame.nextFrameStartTime = _decodedFrameEndTime;
+		_queuedFrames.push(frame);
+
 		return true;
 	}
 
 	return false;
 }
 
+void TheoraDecoder::TheoraVideoTrack::showNextFrame() {
+	if (_queuedFrames.empty())
+		return;
+
+	const QueuedFrame frame = _queuedFrames.pop();
+	_curFrame = frame.frame;
+	_nextFrameStartTime = frame.nextFrameStartTime;
+	_displaySlot = frame.slot;
+
+	Graphics::Surface *surface = _surfaces[_displaySlot];
+	_displaySurface.init(_width, _height, surface->pitch, surface->getBasePtr(_x, _y), surface->format);
+}
+
 enum TheoraYUVBuffers {
 	kBufferY = 0,
 	kBufferU = 1,
 	kBufferV = 2
 };
 
-void TheoraDecoder::TheoraVideoTrack::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer) {
+void TheoraDecoder::TheoraVideoTrack::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, Graphics::Surface *surface) {
 	// Width and height of all buffers have to be divisible by 2.
 	assert((YUVBuffer[kBufferY].width & 1) == 0);
 	assert((YUVBuffer[kBufferY].height & 1) == 0);
@@ -352,27 +436,15 @@ void TheoraDecoder::TheoraVideoTrack::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuf
 	assert((YUVBuffer[kBufferU].height == YUVBuffer[kBufferY].height >> 1) || (YUVBuffer[kBufferU].height == YUVBuffer[kBufferY].height));
 	assert((YUVBuffer[kBufferV].height == YUVBuffer[kBufferY].height >> 1) || (YUVBuffer[kBufferV].height == YUVBuffer[kBufferY].height));
 
-	if (!_surface) {
-		_surface = new Graphics::Surface();
-		_surface->create(_surfaceWidth, _surfaceHeight, _pixelFormat);
-	}
-
-	// Set up a display surface
-	if (!_displaySurface) {
-		_displaySurface = new Graphics::Surface();
-		_displaySurface->init(_width, _height, _surface->pitch,
-		                      _surface->getBasePtr(_x, _y), _surface->format);
-	}
-
 	switch (_theoraPixelFormat) {
 	case TH_PF_420:
-		YUVToRGBMan.convert420(_surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
+		YUVToRGBMan.convert420(surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
 		break;
 	case TH_PF_422:
-		YUVToRGBMan.convert422(_surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
+		YUVToRGBMan.convert422(surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
 		break;
 	case TH_PF_444:
-		YUVToRGBMan.convert444(_surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
+		YUVToRGBMan.convert444(surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
 		break;
 	default:
 		error("Unsupported Theora pixel format");
@@ -495,8 +567,8 @@ void TheoraDecoder::queuePage(ogg_page *page) {
 }
 
 int TheoraDecoder::bufferData() {
-	char *buffer = ogg_sync_buffer(&_oggSync, 4096);
-	int bytes = _fileStream->read(buffer, 4096);
+	char *buffer = ogg_sync_buffer(&_oggSync, kOggReadChunkSize);
+	int bytes = _fileStream->read(buffer, kOggReadChunkSize);
 
 	ogg_sync_wrote(&_oggSync, bytes);
 
@@ -525,22 +597,27 @@ bool TheoraDecoder::queueAudio() {
 	return queuedAudio;
 }
 
+bool TheoraDecoder::bufferAudio() {
+	bufferData();
+	while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
+		queuePage(&_oggPage);
+
+	bool queuedAudio = queueAudio();
+	if ((_vorbisOut.e_o_s  || _fileStream->eos()) && !queuedAudio) {
+		_audioTrack->setEndOfAudio();
+		return false;
+	}
+
+	return true;
+}
+
 void TheoraDecoder::ensureAudioBufferSize() {
 	if (!_hasAudio)
 		return;
 
 	// Force at least some audio to be buffered
-	while (_audioTrack->needsAudio()) {
-		bufferData();
-		while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
-			queuePage(&_oggPage);
-
-		bool queuedAudio = queueAudio();
-		if ((_vorbisOut.e_o_s  || _fileStream->eos()) && !queuedAudio) {
-			_audioTrack->setEndOfAudio();
-			break;
-		}
-	}
+	while (_audioTrack->needsAudio() && bufferAudio())
+		;
 }
 
 } // End of namespace Video
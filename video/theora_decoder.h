@@ -26,7 +26,9 @@
 #ifndef VIDEO_THEORA_DECODER_H
 #define VIDEO_THEORA_DECODER_H
 
+#include "common/queue.h"
 #include "common/rational.h"
+#include "video/decode_ahead.h"
 #include "video/video_decoder.h"
 #include "audio/mixer.h"
 #include "graphics/surface.h"
@@ -61,8 +63,12 @@ namespace Video {
  *  - sword25
  *  - tetraedge
  *  - wintermute
+ *
+ * With decode-ahead enabled, the Ogg demuxing and the Vorbis and Theora
+ * decoding are done from the timer proc of DecodeAheadManager, into a
+ * queue of a few decoded frames and the queue of the audio stream.
  */
-class TheoraDecoder : public VideoDecoder {
+class TheoraDecoder : public VideoDecoder, public DecodeAheadStage {
 public:
 	TheoraDecoder();
 	virtual ~TheoraDecoder();
@@ -79,14 +85,18 @@ public:
 
 protected:
 	void readNextPacket() override;
+	bool decodeAhead() override;
 
 private:
+	// Decodes frames into a queue, which is guarded by the mutex of the
+	// decoder. Only the frame taken from the queue by showNextFrame() is
+	// visible to the caller of the decoder.
 	class TheoraVideoTrack : public VideoTrack {
 	public:
-		TheoraVideoTrack(th_info &theoraInfo, th_setup_info *theoraSetup);
+		TheoraVideoTrack(th_info &theoraInfo, th_setup_info *theoraSetup, Common::Mutex &mutex);
 		~TheoraVideoTrack();
 
-		bool endOfTrack() const override { return _endOfVideo; }
+		bool endOfTrack() const override;
 		uint16 getWidth() const override { return _width; }
 		uint16 getHeight() const override { return _height; }
 		Graphics::PixelFormat getPixelFormat() const override { return _pixelFormat; }
@@ -100,19 +110,44 @@ private:
 		int getCurFrame() const override { return _curFrame; }
 		const Common::Rational &getFrameRate() const { return _frameRate; }
 		uint32 getNextFrameStartTime() const override { return (uint32)(_nextFrameStartTime * 1000); }
-		const Graphics::Surface *decodeNextFrame() override { return _displaySurface; }
+		const Graphics::Surface *decodeNextFrame() override { return _displaySlot >= 0 ? &_displaySurface : nullptr; }
 
+		// These are called with the mutex held
 		bool decodePacket(ogg_packet &oggPacket);
 		void setEndOfVideo() { _endOfVideo = true; }
+		bool isEndOfVideo() const { return _endOfVideo; }
+		bool hasQueuedFrame() const { return !_queuedFrames.empty(); }
+		bool isQueueFull() const { return _queuedFrames.size() >= kFrameQueueSize; }
+		void showNextFrame();
 
 	private:
+		enum {
+			// Frames decoded ahead; one more surface holds the frame shown
+			kFrameQueueSize = 3
+		};
+
+		struct QueuedFrame {
+			int slot;
+			int frame;
+			double nextFrameStartTime;
+		};
+
+		Common::Mutex &_mutex;
+
+		// State of the frame shown
 		int _curFrame;
+		double _nextFrameStartTime;
+		int _displaySlot;
+		Graphics::Surface _displaySurface;
+
+		// State of the decoding
 		bool _endOfVideo;
 		Common::Rational _frameRate;
-		double _nextFrameStartTime;
+		int _decodedFrame;
+		double _decodedFrameEndTime;
+		Common::Queue<QueuedFrame> _queuedFrames;
 
-		Graphics::Surface *_surface;
-		Graphics::Surface *_displaySurface;
+		Graphics::Surface *_surfaces[kFrameQueueSize + 1];
 		Graphics::PixelFormat _pixelFormat;
 		int _x;
 		int _y;
@@ -124,7 +159,8 @@ private:
 		th_dec_ctx *_theoraDecode;
 		th_pixel_fmt _theoraPixelFormat;
 
-		void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer);
+		int getFreeSlot() const;
+		void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, Graphics::Surface *surface);
 	};
 
 	class VorbisAudioTrack : public AudioTrack {
@@ -157,7 +193,9 @@ private:
 	void queuePage(ogg_page *page);
 	int bufferData();
 	bool queueAudio();
+	bool bufferAudio();
 	void ensureAudioBufferSize();
+	void decodeFrame();
 
 	Common::SeekableReadStream *_fileStream;
 
@@ -25,9 +25,13 @@
 #include "audio/mixer.h" // for kMaxChannelVolume
 
 #include "common/rational.h"
+#include "common/debug.h"
 #include "common/file.h"
 #include "common/system.h"
 
+#include "graphics/blit.h"
+#include "graphics/surface.h"
+
 namespace Video {
 
 VideoDecoder::VideoDecoder() {
@@ -47,6 +51,9 @@ VideoDecoder::VideoDecoder() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	_frameCopyBytes = 0;
+	_outputTrack = 0;
+	resetFrameTimingStats();
 	_videoCodecAccuracy = Image::CodecAccuracy::Default;
 }
 
@@ -54,6 +61,12 @@ void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	if (_frameTimingStats.frames > 0)
+		debug(3, "VideoDecoder::close(): %u frames decoded, %u late, average delay %u ms, maximum delay %u ms",
+		      _frameTimingStats.frames, _frameTimingStats.lateFrames,
+		      _frameTimingStats.lateFrames ? (uint32)(_frameTimingStats.totalDrift / _frameTimingStats.lateFrames) : 0,
+		      _frameTimingStats.maxDrift);
+
 	for (auto *track : _tracks)
 		delete track;
 
@@ -74,6 +87,9 @@ void VideoDecoder::close() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	_frameCopyBytes = 0;
+	_outputTrack = 0;
+	resetFrameTimingStats();
 }
 
 bool VideoDecoder::loadFile(const Common::Path &filename) {
@@ -219,6 +235,8 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	if (!_nextVideoTrack)
 		return 0;
 
+	updateFrameTimingStats();
+
 	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
 
 	if (_nextVideoTrack->hasDirtyPalette()) {
@@ -232,6 +250,115 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	return frame;
 }
 
+void VideoDecoder::resetFrameTimingStats() {
+	_frameTimingStats.frames = 0;
+	_frameTimingStats.lateFrames = 0;
+	_frameTimingStats.maxDrift = 0;
+	_frameTimingStats.totalDrift = 0;
+}
+
+void VideoDecoder::updateFrameTimingStats() {
+	// Only frames decoded against a running clock say anything about A/V sync
+	if (!isPlaying() || isPaused() || _nextVideoTrack->isReversed() || _nextVideoTrack->endOfTrack())
+		return;
+
+	_frameTimingStats.frames++;
+
+	uint32 time = getTime();
+	uint32 frameStartTime = _nextVideoTrack->getNextFrameStartTime();
+
+	if (time <= frameStartTime)
+		return;
+
+	uint32 drift = time - frameStartTime;
+	_frameTimingStats.lateFrames++;
+	_frameTimingStats.totalDrift += drift;
+	_frameTimingStats.maxDrift = MAX(_frameTimingStats.maxDrift, drift);
+}
+
+// Copy a frame into dst, converting it to the format of dst in the same pass.
+// Return the number of bytes written, or -1 on error.
+static int32 copyFrameInto(const Graphics::Surface &frame, const byte *palette, Graphics::Surface &dst, const Common::Rect &destRect) {
+	Common::Rect dstArea(destRect.left, destRect.top, destRect.left + frame.w, destRect.top + frame.h);
+	dstArea.clip(destRect);
+	dstArea.clip(Common::Rect(dst.w, dst.h));
+
+	if (dstArea.isEmpty())
+		return 0;
+
+	const byte *src = (const byte *)frame.getBasePtr(dstArea.left - destRect.left, dstArea.top - destRect.top);
+	byte *out = (byte *)dst.getBasePtr(dstArea.left, dstArea.top);
+	const uint w = dstArea.width();
+	const uint h = dstArea.height();
+
+	if (frame.format == dst.format) {
+		Graphics::copyBlit(out, src, dst.pitch, frame.pitch, w, h, dst.format.bytesPerPixel);
+	} else if (frame.format.isCLUT8()) {
+		if (!palette) {
+			warning("VideoDecoder::decodeNextFrameInto(): Missing palette for paletted frame");
+			return -1;
+		}
+
+		uint32 map[256];
+		Graphics::convertPaletteToMap(map, palette, 256, dst.format);
+		Graphics::crossBlitMap(out, src, dst.pitch, frame.pitch, w, h, dst.format.bytesPerPixel, map);
+	} else if (dst.format.isCLUT8()) {
+		warning("VideoDecoder::decodeNextFrameInto(): Cannot convert a %s frame to a paletted surface", frame.format.toString().c_str());
+		return -1;
+	} else if (!Graphics::crossBlit(out, src, dst.pitch, frame.pitch, w, h, dst.format, frame.format)) {
+		return -1;
+	}
+
+	return w * h * dst.format.bytesPerPixel;
+}
+
+bool VideoDecoder::setOutputArea(Graphics::Surface &dst, const Common::Rect &destRect) {
+	VideoTrack *track = _nextVideoTrack;
+	if (!track)
+		return false;
+
+	Common::Rect frameRect(destRect.left, destRect.top, destRect.left + track->getWidth(), destRect.top + track->getHeight());
+	const bool fits = destRect.contains(frameRect) && Common::Rect(dst.w, dst.h).contains(frameRect);
+	const Graphics::Surface area = fits ? dst.getSubArea(frameRect) : Graphics::Surface();
+
+	if (_outputTrack == track && fits && area.getPixels() == _outputArea.getPixels() && area.pitch == _outputArea.pitch && area.format == _outputArea.format)
+		return true;
+
+	// The previous area is still valid, so the track can copy its frame back
+	if (_outputTrack) {
+		_outputTrack->setOutputSurface(nullptr);
+		_outputTrack = 0;
+	}
+
+	if (!fits || !track->setOutputSurface(&area))
+		return false;
+
+	_outputTrack = track;
+	_outputArea = area;
+	return true;
+}
+
+bool VideoDecoder::decodeNextFrameInto(Graphics::Surface &dst, const Common::Rect &destRect) {
+	_frameCopyBytes = 0;
+
+	// Decode straight into dst if the codec can do so
+	const bool inPlace = setOutputArea(dst, destRect);
+
+	const Graphics::Surface *frame = decodeNextFrame();
+	if (!frame)
+		return false;
+
+	if (inPlace && frame->getPixels() == _outputArea.getPixels())
+		return true;
+
+	int32 bytes = copyFrameInto(*frame, _palette, dst, destRect);
+	if (bytes < 0)
+		return false;
+
+	_frameCopyBytes = bytes;
+	return true;
+}
+
 bool VideoDecoder::setReverse(bool reverse) {
 	// Can only reverse video-only videos
 	if (reverse && hasAudio())
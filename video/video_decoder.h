@@ -27,8 +27,10 @@
 #include "common/array.h"
 #include "common/path.h"
 #include "common/rational.h"
+#include "common/rect.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
+#include "graphics/surface.h"
 #include "image/codec-options.h"
 
 namespace Audio {
@@ -41,10 +43,6 @@ namespace Common {
 class SeekableReadStream;
 }
 
-namespace Graphics {
-struct Surface;
-}
-
 namespace Video {
 
 /**
@@ -371,6 +369,55 @@ public:
 	 */
 	virtual const Graphics::Surface *decodeNextFrame();
 
+	/**
+	 * Decode the next frame directly into a caller-provided surface.
+	 *
+	 * When the codec of the video track supports it, and the frame fits in
+	 * destRect and dst, the frame is decoded straight into dst without any
+	 * copy. Frames which only update parts of the previous one are then
+	 * decoded over dst, so the area of the frame must be left as is between
+	 * calls, and dst must stay valid until the video is closed or this is
+	 * called with another surface.
+	 *
+	 * Otherwise, the frame is converted to the pixel format of dst while it
+	 * is copied, so no intermediate surface from Graphics::Surface::convertTo()
+	 * is needed. The top-left corner of the frame is placed at the top-left
+	 * corner of destRect, and the frame is clipped against destRect and dst.
+	 * Paletted frames are expanded with the current video palette; this does
+	 * not clear the dirty palette flag.
+	 *
+	 * @param dst       the surface to write the frame to
+	 * @param destRect  the area of dst the frame is written to
+	 * @return true if a new frame was written to dst, false otherwise
+	 * @note This calls decodeNextFrame() internally, hence the same notes apply.
+	 */
+	bool decodeNextFrameInto(Graphics::Surface &dst, const Common::Rect &destRect);
+
+	/**
+	 * Return the number of bytes copied to the destination surface by the
+	 * last call to decodeNextFrameInto(), which is 0 when the frame was
+	 * decoded in place.
+	 */
+	uint32 getFrameCopyBytes() const { return _frameCopyBytes; }
+
+	/**
+	 * Statistics on how closely frame decoding keeps up with the playback
+	 * clock, gathered while the video is playing.
+	 */
+	struct FrameTimingStats {
+		uint32 frames;       ///< Number of frames decoded while playing
+		uint32 lateFrames;   ///< Number of frames decoded after they were due
+		uint32 maxDrift;     ///< Largest delay of a frame behind the clock, in ms
+		uint64 totalDrift;   ///< Sum of the delays of all late frames, in ms
+	};
+
+	/**
+	 * Return the frame timing statistics for the current video.
+	 *
+	 * The statistics are reset when the video is closed.
+	 */
+	const FrameTimingStats &getFrameTimingStats() const { return _frameTimingStats; }
+
 	/**
 	 * Set the video to decode frames in reverse.
 	 *
@@ -620,6 +667,14 @@ protected:
 		 */
 		virtual bool setOutputPixelFormat(const Graphics::PixelFormat &format) { return format == getPixelFormat(); }
 
+		/**
+		 * Decode the following frames directly into an area of a surface of
+		 * the caller. See Image::Codec::setOutputSurface().
+		 *
+		 * @return true if the frames are decoded into @p area
+		 */
+		virtual bool setOutputSurface(const Graphics::Surface *area) { return area == nullptr; }
+
 		/**
 		 * Set the image codec accuracy
 		 */
@@ -1029,6 +1084,20 @@ private:
 	bool _canSetDither;
 	bool _canSetDefaultFormat;
 
+	// Bytes copied by the last decodeNextFrameInto() call
+	uint32 _frameCopyBytes;
+
+	// The track decoding into the surface of decodeNextFrameInto(), and
+	// the area of that surface
+	VideoTrack *_outputTrack;
+	Graphics::Surface _outputArea;
+	bool setOutputArea(Graphics::Surface &dst, const Common::Rect &destRect);
+
+	// A/V sync statistics
+	FrameTimingStats _frameTimingStats;
+	void resetFrameTimingStats();
+	void updateFrameTimingStats();
+
 protected:
 	// Internal helper functions
 	void stopAudio();